@@ -0,0 +1,865 @@
+// micro-benchmarks of the renderer's hot paths, run against a device without a window so a software
+// implementation like lavapipe on a CI machine works as well as a real GPU
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "cull.h"
+#include "device.h"
+#include "draws.h"
+#include "record.h"
+#include "reflect.h"
+#include "scene.h"
+#include "shader_features.h"
+#include "shaders/shader.frag.h"
+#include "shaders/shader.vert.h"
+
+namespace VkDraw {
+	static constexpr double MIN_TIME = 0.25; // seconds each benchmark runs for at least
+	static constexpr VkExtent2D TARGET_EXTENT = {256, 256};
+	static constexpr uint32_t DESCRIPTOR_SETS = 64; // written per iteration of the descriptor benchmark
+
+	struct Options {
+		std::optional<std::string_view> device; // --device <index|name>
+		std::optional<std::string_view> filter; // --filter <text>, only benchmarks with it in their name
+		std::optional<std::string> json; // --json <file.json>
+	};
+
+	struct Result {
+		std::string name;
+		uint64_t iterations;
+		double ns; // per iteration
+		uint64_t items; // per iteration, draws, descriptors or bytes depending on the benchmark
+	};
+
+	// a batch runs the benchmark body the given number of times
+	using Batch = std::function<void(uint64_t iterations)>;
+
+	// stops the compiler from discarding a result that is never read
+#if defined(__GNUC__)
+	template <typename T>
+	static void keep(const T &value) {
+		asm volatile("" : : "r"(&value) : "memory");
+	}
+#else
+	static const void *volatile _kept;
+
+	// other compilers can't see through a volatile store either, the address escaping keeps the value alive
+	template <typename T>
+	static void keep(const T &value) {
+		_kept = &value;
+	}
+#endif
+
+	static Options _options;
+	static std::vector<Result> _results;
+
+	// batches grow until one takes a tenth of MIN_TIME, so reading the clock costs nothing measurable
+	static void measure(std::string name, uint64_t items, const Batch &batch) {
+		if (_options.filter.has_value() && !std::string_view(name).contains(*_options.filter)) {
+			return;
+		}
+
+		batch(1); // warm caches and lazily created driver state
+
+		uint64_t iterations = 0;
+		uint64_t batch_size = 1;
+		std::chrono::duration<double> elapsed{};
+		while (elapsed.count() < MIN_TIME) {
+			const auto start = std::chrono::steady_clock::now();
+			batch(batch_size);
+			const std::chrono::duration<double> taken = std::chrono::steady_clock::now() - start;
+			elapsed += taken;
+			iterations += batch_size;
+			if (taken.count() < MIN_TIME / 10.0) {
+				batch_size *= 2;
+			}
+		}
+
+		const double ns = elapsed.count() * 1e9 / static_cast<double>(iterations);
+		std::printf("%-40s %12llu %14.1f ns", name.c_str(), static_cast<unsigned long long>(iterations), ns);
+		if (items > 1) {
+			std::printf(" %10.2f ns/item", ns / static_cast<double>(items));
+		}
+		std::printf("\n");
+		_results.push_back({std::move(name), iterations, ns, items});
+	}
+
+	// the Vulkan objects every benchmark shares, a render target stands in for the swapchain
+	struct Context {
+		VkInstance instance;
+		VkPhysicalDevice physical_device;
+		DeviceCapabilities caps;
+		VkDevice device;
+		uint32_t queue_family;
+		VkQueue queue;
+		VkCommandPool command_pool;
+		VkCommandBuffer cmd;
+		VkFence fence;
+		VkImage target;
+		VkDeviceMemory target_memory;
+		VkImageView target_view;
+		VkRenderPass render_pass;
+		VkFramebuffer framebuffer;
+		VkShaderModule vert;
+		VkShaderModule frag;
+		PipelineReflection reflection;
+		VkDescriptorSetLayout set_layout;
+		VkPipelineLayout layout;
+		VkPipeline pipeline;
+		VkBuffer geometry; // vertex and index buffer, never drawn from, only bound
+		VkDeviceMemory geometry_memory;
+	};
+
+	static Context _ctx;
+
+	static void check(VkResult res, const char *what) {
+		if (res != VK_SUCCESS) {
+			throw std::runtime_error(std::string("Failed to ") + what + "!");
+		}
+	}
+
+	static void create_buffer(
+		VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,
+		VkDeviceMemory &memory
+	) {
+		VkBufferCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		info.size = size;
+		info.usage = usage;
+		info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		check(vkCreateBuffer(_ctx.device, &info, nullptr, &buffer), "create buffer");
+
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(_ctx.device, buffer, &requirements);
+
+		VkMemoryAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		alloc_info.allocationSize = requirements.size;
+		alloc_info.memoryTypeIndex = _ctx.caps.find_memory_type(requirements.memoryTypeBits, properties);
+		check(vkAllocateMemory(_ctx.device, &alloc_info, nullptr, &memory), "allocate buffer memory");
+		vkBindBufferMemory(_ctx.device, buffer, memory, 0);
+	}
+
+	static void destroy_buffer(VkBuffer buffer, VkDeviceMemory memory) {
+		vkDestroyBuffer(_ctx.device, buffer, nullptr);
+		vkFreeMemory(_ctx.device, memory, nullptr);
+	}
+
+	static void create_device() {
+		VkApplicationInfo app_info{};
+		app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+		app_info.pApplicationName = "vkdraw_bench";
+		app_info.apiVersion = VK_API_VERSION_1_3;
+
+		VkInstanceCreateInfo instance_info{};
+		instance_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+		instance_info.pApplicationInfo = &app_info;
+		check(vkCreateInstance(&instance_info, nullptr, &_ctx.instance), "create instance");
+
+		uint32_t count;
+		vkEnumeratePhysicalDevices(_ctx.instance, &count, nullptr);
+		std::vector<VkPhysicalDevice> devices(count);
+		vkEnumeratePhysicalDevices(_ctx.instance, &count, devices.data());
+		if (devices.empty()) {
+			throw std::runtime_error("No graphics device was found!");
+		}
+
+		// match by enumeration index, otherwise by a substring of the device name, like VkDraw --device
+		_ctx.physical_device = devices[0];
+		if (_options.device.has_value()) {
+			_ctx.physical_device = VK_NULL_HANDLE;
+			for (uint32_t i = 0; i < count; i++) {
+				VkPhysicalDeviceProperties properties;
+				vkGetPhysicalDeviceProperties(devices[i], &properties);
+				if (device_matches(*_options.device, i, properties.deviceName)) {
+					_ctx.physical_device = devices[i];
+					break;
+				}
+			}
+			if (_ctx.physical_device == VK_NULL_HANDLE) {
+				throw std::runtime_error("Requested graphics device was not found!");
+			}
+		}
+		_ctx.caps = query_device_capabilities(_ctx.physical_device);
+		std::printf("Device: %s\n", _ctx.caps.properties.deviceName);
+
+		vkGetPhysicalDeviceQueueFamilyProperties(_ctx.physical_device, &count, nullptr);
+		std::vector<VkQueueFamilyProperties> families(count);
+		vkGetPhysicalDeviceQueueFamilyProperties(_ctx.physical_device, &count, families.data());
+		const auto family = std::ranges::find_if(families, [](const VkQueueFamilyProperties &properties) {
+			return properties.queueFlags & VK_QUEUE_GRAPHICS_BIT;
+		});
+		if (family == families.end()) {
+			throw std::runtime_error("Device has no graphics queue!");
+		}
+		_ctx.queue_family = static_cast<uint32_t>(family - families.begin());
+
+		const float priority = 1.0f;
+		VkDeviceQueueCreateInfo queue_info{};
+		queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		queue_info.queueFamilyIndex = _ctx.queue_family;
+		queue_info.queueCount = 1;
+		queue_info.pQueuePriorities = &priority;
+
+		VkDeviceCreateInfo device_info{};
+		device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		device_info.queueCreateInfoCount = 1;
+		device_info.pQueueCreateInfos = &queue_info;
+		check(vkCreateDevice(_ctx.physical_device, &device_info, nullptr, &_ctx.device), "create logical device");
+		vkGetDeviceQueue(_ctx.device, _ctx.queue_family, 0, &_ctx.queue);
+
+		VkCommandPoolCreateInfo pool_info{};
+		pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		pool_info.queueFamilyIndex = _ctx.queue_family;
+		check(vkCreateCommandPool(_ctx.device, &pool_info, nullptr, &_ctx.command_pool), "create command pool");
+
+		VkCommandBufferAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		alloc_info.commandPool = _ctx.command_pool;
+		alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		alloc_info.commandBufferCount = 1;
+		check(vkAllocateCommandBuffers(_ctx.device, &alloc_info, &_ctx.cmd), "allocate command buffer");
+
+		VkFenceCreateInfo fence_info{};
+		fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		check(vkCreateFence(_ctx.device, &fence_info, nullptr, &_ctx.fence), "create fence");
+	}
+
+	static void create_target() {
+		VkImageCreateInfo image_info{};
+		image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		image_info.imageType = VK_IMAGE_TYPE_2D;
+		image_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+		image_info.extent = {TARGET_EXTENT.width, TARGET_EXTENT.height, 1};
+		image_info.mipLevels = 1;
+		image_info.arrayLayers = 1;
+		image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+		image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+		image_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		check(vkCreateImage(_ctx.device, &image_info, nullptr, &_ctx.target), "create image");
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(_ctx.device, _ctx.target, &requirements);
+		VkMemoryAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		alloc_info.allocationSize = requirements.size;
+		alloc_info.memoryTypeIndex = _ctx.caps.find_memory_type(
+			requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+		);
+		check(vkAllocateMemory(_ctx.device, &alloc_info, nullptr, &_ctx.target_memory), "allocate image memory");
+		vkBindImageMemory(_ctx.device, _ctx.target, _ctx.target_memory, 0);
+
+		VkImageViewCreateInfo view_info{};
+		view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		view_info.image = _ctx.target;
+		view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		view_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+		view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		view_info.subresourceRange.levelCount = 1;
+		view_info.subresourceRange.layerCount = 1;
+		check(vkCreateImageView(_ctx.device, &view_info, nullptr, &_ctx.target_view), "create image view");
+
+		VkAttachmentDescription color{};
+		color.format = VK_FORMAT_R8G8B8A8_UNORM;
+		color.samples = VK_SAMPLE_COUNT_1_BIT;
+		color.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		color.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		color.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		color.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		color.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		color.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentReference color_ref{};
+		color_ref.attachment = 0;
+		color_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		VkSubpassDescription subpass{};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = 1;
+		subpass.pColorAttachments = &color_ref;
+
+		VkRenderPassCreateInfo pass_info{};
+		pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		pass_info.attachmentCount = 1;
+		pass_info.pAttachments = &color;
+		pass_info.subpassCount = 1;
+		pass_info.pSubpasses = &subpass;
+		check(vkCreateRenderPass(_ctx.device, &pass_info, nullptr, &_ctx.render_pass), "create render pass");
+
+		VkFramebufferCreateInfo framebuffer_info{};
+		framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebuffer_info.renderPass = _ctx.render_pass;
+		framebuffer_info.attachmentCount = 1;
+		framebuffer_info.pAttachments = &_ctx.target_view;
+		framebuffer_info.width = TARGET_EXTENT.width;
+		framebuffer_info.height = TARGET_EXTENT.height;
+		framebuffer_info.layers = 1;
+		check(vkCreateFramebuffer(_ctx.device, &framebuffer_info, nullptr, &_ctx.framebuffer), "create framebuffer");
+
+		create_buffer(
+			64 * 1024, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _ctx.geometry, _ctx.geometry_memory
+		);
+	}
+
+	static VkShaderModule create_module(std::span<const uint32_t> code) {
+		VkShaderModuleCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		info.codeSize = code.size_bytes();
+		info.pCode = code.data();
+
+		VkShaderModule module;
+		check(vkCreateShaderModule(_ctx.device, &info, nullptr, &module), "create shader module");
+		return module;
+	}
+
+	// the mesh program as VkDraw builds it, with the uniform buffer made dynamic
+	static void create_program() {
+		std::array stages = {reflect_shader(SHADER_VERT_SPV), reflect_shader(SHADER_FRAG_SPV)};
+		_ctx.reflection = reflect_pipeline(stages);
+		for (auto &bindings : _ctx.reflection.sets) {
+			for (auto &binding : bindings) {
+				if (binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+					binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+				}
+			}
+		}
+		if (_ctx.reflection.sets.size() != 1) {
+			throw std::runtime_error("Shaders must use exactly one descriptor set!");
+		}
+
+		_ctx.set_layout = get_set_layout(_ctx.device, _ctx.reflection.sets[0]);
+		_ctx.layout = get_pipeline_layout(
+			_ctx.device, std::span(&_ctx.set_layout, 1), _ctx.reflection.push_constants
+		);
+		_ctx.vert = create_module(SHADER_VERT_SPV);
+		_ctx.frag = create_module(SHADER_FRAG_SPV);
+	}
+
+	// output encodings past PQ behave like none, so any other value still gives a working pipeline
+	static VkPipeline create_pipeline(VkPipelineCache cache, int32_t encoding = 0) {
+		const VkSpecializationMapEntry encoding_entry = {SHADER_OUTPUT_ENCODING_ID, 0, sizeof(encoding)};
+		VkSpecializationInfo specialization{};
+		specialization.mapEntryCount = 1;
+		specialization.pMapEntries = &encoding_entry;
+		specialization.dataSize = sizeof(encoding);
+		specialization.pData = &encoding;
+
+		std::array<VkPipelineShaderStageCreateInfo, 2> stages{};
+		stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+		stages[0].module = _ctx.vert;
+		stages[0].pName = "main";
+		stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		stages[1].module = _ctx.frag;
+		stages[1].pName = "main";
+		stages[1].pSpecializationInfo = &specialization;
+
+		VkPipelineVertexInputStateCreateInfo vertex_input{};
+		vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertex_input.vertexBindingDescriptionCount = 1;
+		vertex_input.pVertexBindingDescriptions = &_ctx.reflection.binding;
+		vertex_input.vertexAttributeDescriptionCount = _ctx.reflection.attributes.size();
+		vertex_input.pVertexAttributeDescriptions = _ctx.reflection.attributes.data();
+
+		VkPipelineInputAssemblyStateCreateInfo input_assembly{};
+		input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+		VkPipelineViewportStateCreateInfo viewport{};
+		viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewport.viewportCount = 1;
+		viewport.scissorCount = 1;
+
+		VkPipelineRasterizationStateCreateInfo rasterizer{};
+		rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+		rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+		rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		rasterizer.lineWidth = 1.0f;
+
+		VkPipelineMultisampleStateCreateInfo multisample{};
+		multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		VkPipelineColorBlendAttachmentState blend_attachment{};
+		blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+			VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+		VkPipelineColorBlendStateCreateInfo blend{};
+		blend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		blend.attachmentCount = 1;
+		blend.pAttachments = &blend_attachment;
+
+		std::array dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+		VkPipelineDynamicStateCreateInfo dynamic{};
+		dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamic.dynamicStateCount = dynamic_states.size();
+		dynamic.pDynamicStates = dynamic_states.data();
+
+		VkGraphicsPipelineCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		info.stageCount = stages.size();
+		info.pStages = stages.data();
+		info.pVertexInputState = &vertex_input;
+		info.pInputAssemblyState = &input_assembly;
+		info.pViewportState = &viewport;
+		info.pRasterizationState = &rasterizer;
+		info.pMultisampleState = &multisample;
+		info.pColorBlendState = &blend;
+		info.pDynamicState = &dynamic;
+		info.layout = _ctx.layout;
+		info.renderPass = _ctx.render_pass;
+		info.subpass = 0;
+
+		VkPipeline pipeline;
+		check(vkCreateGraphicsPipelines(_ctx.device, cache, 1, &info, nullptr, &pipeline), "create pipeline");
+		return pipeline;
+	}
+
+	// the world matrices the app recomputes every frame, each node spun as update_ubos does
+	static void bench_scene() {
+		constexpr uint32_t COUNT = 1 << 16;
+		SceneGraph flat;
+		std::vector<NodeId> nodes(COUNT);
+		for (uint32_t i = 0; i < COUNT; i++) {
+			Transform local;
+			local.translation = {static_cast<float>(i % 256), static_cast<float>(i / 256), 0.0f};
+			nodes[i] = flat.add(local);
+		}
+
+		float time = 0.0f;
+		measure("scene/update_all/64K", COUNT, [&](uint64_t iterations) {
+			for (uint64_t i = 0; i < iterations; i++) {
+				const auto spin = glm::angleAxis(time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+				for (const auto node : nodes) {
+					flat.set_rotation(node, spin);
+				}
+				flat.update();
+				keep(flat.world_matrices().back());
+				time += 1.0f / 60.0f;
+			}
+		});
+
+		// chains of 16, only the roots move, so the dirty flags have to reach every descendant
+		SceneGraph nested;
+		std::vector<NodeId> roots;
+		for (uint32_t i = 0; i < COUNT; i++) {
+			Transform local;
+			local.translation = {1.0f, 0.0f, 0.0f};
+			if (i % 16 == 0) {
+				roots.push_back(nested.add(local));
+			} else {
+				nested.add(local, i - 1);
+			}
+		}
+		measure("scene/update_nested/64K", COUNT, [&](uint64_t iterations) {
+			for (uint64_t i = 0; i < iterations; i++) {
+				const auto spin = glm::angleAxis(time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+				for (const auto root : roots) {
+					nested.set_rotation(root, spin);
+				}
+				nested.update();
+				keep(nested.world_matrices().back());
+				time += 1.0f / 60.0f;
+			}
+		});
+	}
+
+	// spheres scattered around the app's camera so some are in view and most are not
+	static void bench_culling() {
+		constexpr uint32_t COUNT = 1 << 20;
+		BoundingSpheres spheres;
+		spheres.resize(COUNT);
+		uint32_t seed = 1;
+		const auto random = [&seed](float range) {
+			seed = seed * 1664525u + 1013904223u;
+			return (static_cast<float>(seed >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f) * range;
+		};
+		for (uint32_t i = 0; i < COUNT; i++) {
+			spheres.set(i, {random(20.0f), random(20.0f), random(20.0f)}, 0.5f);
+		}
+
+		auto proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 10.0f);
+		proj[1][1] *= -1;
+		const auto view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		const auto frustum = extract_frustum(proj * view);
+
+		std::vector<uint32_t> visible(COUNT);
+		measure("cull/spheres/1M", COUNT, [&](uint64_t iterations) {
+			for (uint64_t i = 0; i < iterations; i++) {
+				keep(cull_spheres(frustum, spheres, 0, COUNT, visible.data()));
+			}
+		});
+
+		ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+		std::vector<uint32_t> scratch;
+		measure("cull/spheres_parallel/1M", COUNT, [&](uint64_t iterations) {
+			for (uint64_t i = 0; i < iterations; i++) {
+				cull_spheres(frustum, spheres, pool, visible, scratch);
+				keep(visible.size());
+			}
+		});
+	}
+
+	// keys spread over a handful of pipelines and materials like a scene's, each iteration sorts a fresh copy
+	static void bench_sorting() {
+		constexpr uint32_t COUNT = 1 << 20;
+		std::vector<DrawItem> draws(COUNT);
+		uint32_t seed = 1;
+		const auto random = [&seed]() {
+			seed = seed * 1664525u + 1013904223u;
+			return seed >> 8;
+		};
+		for (uint32_t i = 0; i < COUNT; i++) {
+			const float depth = static_cast<float>(random()) / static_cast<float>(1u << 24) * 100.0f;
+			draws[i] = {draw_sort_key(DRAW_PASS_OPAQUE, random() % 8, random() % 64, depth), i};
+		}
+
+		ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+		std::vector<DrawItem> sorted;
+		DrawSortScratch scratch;
+		measure("sort/draws_radix/1M", COUNT, [&](uint64_t iterations) {
+			for (uint64_t i = 0; i < iterations; i++) {
+				sorted = draws;
+				sort_draws(sorted, scratch, pool);
+				keep(sorted.front());
+			}
+		});
+		measure("sort/draws_std/1M", COUNT, [&](uint64_t iterations) {
+			for (uint64_t i = 0; i < iterations; i++) {
+				sorted = draws;
+				std::ranges::stable_sort(sorted, {}, &DrawItem::key);
+				keep(sorted.front());
+			}
+		});
+	}
+
+	static void bench_find_memory_type() {
+		measure("device/find_memory_type", 1, [](uint64_t iterations) {
+			for (uint64_t i = 0; i < iterations; i++) {
+				// every type allowed, so the search runs to the first match of each property set
+				const uint32_t filter = ~0u;
+				auto type = _ctx.caps.find_memory_type(filter, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+				keep(type);
+				type = _ctx.caps.find_memory_type(
+					filter, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+				);
+				keep(type);
+			}
+		});
+	}
+
+	static void bench_recording() {
+		VkDescriptorPoolSize pool_size{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1};
+		VkDescriptorPoolCreateInfo pool_info{};
+		pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		pool_info.maxSets = 1;
+		pool_info.poolSizeCount = 1;
+		pool_info.pPoolSizes = &pool_size;
+		VkDescriptorPool pool;
+		check(vkCreateDescriptorPool(_ctx.device, &pool_info, nullptr, &pool), "create descriptor pool");
+
+		VkDescriptorSetAllocateInfo set_info{};
+		set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		set_info.descriptorPool = pool;
+		set_info.descriptorSetCount = 1;
+		set_info.pSetLayouts = &_ctx.set_layout;
+		VkDescriptorSet set;
+		check(vkAllocateDescriptorSets(_ctx.device, &set_info, &set), "allocate descriptor set");
+
+		// the app's mesh recording, every draw pushing its own model matrix like the copies of the mesh do
+		const glm::mat4 model(1.0f);
+		DrawBindings bindings{};
+		bindings.pipelines = std::span(&_ctx.pipeline, 1);
+		bindings.layout = _ctx.layout;
+		bindings.vertex_buffer = _ctx.geometry;
+		bindings.index_buffer = _ctx.geometry;
+		bindings.index_type = VK_INDEX_TYPE_UINT16;
+		bindings.index_count = 6;
+		bindings.set = set;
+		bindings.dynamic_offset = 0;
+		bindings.models = std::span(&model, 1);
+
+		for (const uint32_t count : {1u, 100u, 10000u}) {
+			const std::vector<DrawItem> draws(count, {draw_sort_key(DRAW_PASS_OPAQUE, 0, 0, 1.0f), 0});
+			measure("record/draws/" + std::to_string(count), count, [&draws, &bindings](uint64_t iterations) {
+				RenderCounters counters;
+				for (uint64_t i = 0; i < iterations; i++) {
+					vkResetCommandBuffer(_ctx.cmd, 0);
+					VkCommandBufferBeginInfo begin_info{};
+					begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+					begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+					vkBeginCommandBuffer(_ctx.cmd, &begin_info);
+
+					VkClearValue clear{};
+					VkRenderPassBeginInfo render_info{};
+					render_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+					render_info.renderPass = _ctx.render_pass;
+					render_info.framebuffer = _ctx.framebuffer;
+					render_info.renderArea.extent = TARGET_EXTENT;
+					render_info.clearValueCount = 1;
+					render_info.pClearValues = &clear;
+					vkCmdBeginRenderPass(_ctx.cmd, &render_info, VK_SUBPASS_CONTENTS_INLINE);
+
+					const VkViewport viewport = {
+						0.0f, 0.0f, static_cast<float>(TARGET_EXTENT.width), static_cast<float>(TARGET_EXTENT.height),
+						0.0f, 1.0f
+					};
+					vkCmdSetViewport(_ctx.cmd, 0, 1, &viewport);
+					const VkRect2D scissor = {{0, 0}, TARGET_EXTENT};
+					vkCmdSetScissor(_ctx.cmd, 0, 1, &scissor);
+
+					record_draws(_ctx.cmd, draws, bindings, counters);
+
+					vkCmdEndRenderPass(_ctx.cmd);
+					vkEndCommandBuffer(_ctx.cmd);
+				}
+				keep(counters);
+			});
+		}
+
+		vkDestroyDescriptorPool(_ctx.device, pool, nullptr);
+	}
+
+	static void bench_descriptors() {
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		create_buffer(
+			4096, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, buffer, memory
+		);
+
+		VkDescriptorPoolSize pool_size{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, DESCRIPTOR_SETS};
+		VkDescriptorPoolCreateInfo pool_info{};
+		pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		pool_info.maxSets = DESCRIPTOR_SETS;
+		pool_info.poolSizeCount = 1;
+		pool_info.pPoolSizes = &pool_size;
+		VkDescriptorPool pool;
+		check(vkCreateDescriptorPool(_ctx.device, &pool_info, nullptr, &pool), "create descriptor pool");
+
+		std::vector<VkDescriptorSetLayout> layouts(DESCRIPTOR_SETS, _ctx.set_layout);
+		std::vector<VkDescriptorSet> sets(DESCRIPTOR_SETS);
+		VkDescriptorSetAllocateInfo set_info{};
+		set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		set_info.descriptorPool = pool;
+		set_info.descriptorSetCount = DESCRIPTOR_SETS;
+		set_info.pSetLayouts = layouts.data();
+		check(vkAllocateDescriptorSets(_ctx.device, &set_info, sets.data()), "allocate descriptor sets");
+
+		// only the uniform buffer binding is written, the sampler would need a texture and isn't the hot part
+		VkDescriptorBufferInfo buffer_info{buffer, 0, 192};
+		std::vector<VkWriteDescriptorSet> writes(DESCRIPTOR_SETS);
+		for (uint32_t i = 0; i < DESCRIPTOR_SETS; i++) {
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].dstSet = sets[i];
+			writes[i].dstBinding = 0;
+			writes[i].descriptorCount = 1;
+			writes[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			writes[i].pBufferInfo = &buffer_info;
+		}
+
+		measure("descriptors/update/1", 1, [&writes](uint64_t iterations) {
+			for (uint64_t i = 0; i < iterations; i++) {
+				vkUpdateDescriptorSets(_ctx.device, 1, &writes[i % DESCRIPTOR_SETS], 0, nullptr);
+			}
+		});
+		const auto name = "descriptors/update/" + std::to_string(DESCRIPTOR_SETS);
+		measure(name, DESCRIPTOR_SETS, [&writes](uint64_t iterations) {
+			for (uint64_t i = 0; i < iterations; i++) {
+				vkUpdateDescriptorSets(_ctx.device, writes.size(), writes.data(), 0, nullptr);
+			}
+		});
+
+		vkDestroyDescriptorPool(_ctx.device, pool, nullptr);
+		destroy_buffer(buffer, memory);
+	}
+
+	// a write into mapped staging memory, a copy to device local memory and the wait for it, as startup uploads do
+	static void bench_staging() {
+		for (const VkDeviceSize size : {VkDeviceSize{4} << 10, VkDeviceSize{256} << 10, VkDeviceSize{4} << 20}) {
+			VkBuffer staging;
+			VkDeviceMemory staging_memory;
+			create_buffer(
+				size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging, staging_memory
+			);
+			VkBuffer target;
+			VkDeviceMemory target_memory;
+			create_buffer(
+				size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, target, target_memory
+			);
+
+			void *mapped;
+			vkMapMemory(_ctx.device, staging_memory, 0, size, 0, &mapped);
+			std::vector<std::byte> source(size, std::byte{0x5a});
+
+			const auto name = "staging/upload/" + std::to_string(size >> 10) + "KiB";
+			measure(name, size, [&](uint64_t iterations) {
+				for (uint64_t i = 0; i < iterations; i++) {
+					std::memcpy(mapped, source.data(), size);
+
+					vkResetCommandBuffer(_ctx.cmd, 0);
+					VkCommandBufferBeginInfo begin_info{};
+					begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+					begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+					vkBeginCommandBuffer(_ctx.cmd, &begin_info);
+					const VkBufferCopy region = {0, 0, size};
+					vkCmdCopyBuffer(_ctx.cmd, staging, target, 1, &region);
+					vkEndCommandBuffer(_ctx.cmd);
+
+					VkSubmitInfo submit{};
+					submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+					submit.commandBufferCount = 1;
+					submit.pCommandBuffers = &_ctx.cmd;
+					check(vkQueueSubmit(_ctx.queue, 1, &submit, _ctx.fence), "submit queue");
+					vkWaitForFences(_ctx.device, 1, &_ctx.fence, VK_TRUE, UINT64_MAX);
+					vkResetFences(_ctx.device, 1, &_ctx.fence);
+				}
+			});
+
+			vkUnmapMemory(_ctx.device, staging_memory);
+			destroy_buffer(staging, staging_memory);
+			destroy_buffer(target, target_memory);
+		}
+	}
+
+	static void bench_pipelines() {
+		// drivers keep shader caches of their own, in memory and on disk across runs, that would serve every
+		// creation after the first, so each one specializes the encoding to a value not used before, starting
+		// from a random one so earlier runs didn't use it either
+		auto encoding = static_cast<int32_t>(std::random_device{}() >> 2) + 3;
+		measure("pipeline/create/no_cache", 1, [&encoding](uint64_t iterations) {
+			for (uint64_t i = 0; i < iterations; i++) {
+				vkDestroyPipeline(_ctx.device, create_pipeline(VK_NULL_HANDLE, encoding++), nullptr);
+			}
+		});
+
+		// primed once, so every creation measured is a cache hit
+		VkPipelineCacheCreateInfo cache_info{};
+		cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		VkPipelineCache cache;
+		check(vkCreatePipelineCache(_ctx.device, &cache_info, nullptr, &cache), "create pipeline cache");
+		vkDestroyPipeline(_ctx.device, create_pipeline(cache), nullptr);
+
+		measure("pipeline/create/cached", 1, [cache](uint64_t iterations) {
+			for (uint64_t i = 0; i < iterations; i++) {
+				vkDestroyPipeline(_ctx.device, create_pipeline(cache), nullptr);
+			}
+		});
+		vkDestroyPipelineCache(_ctx.device, cache, nullptr);
+	}
+
+	static void write_json(const char *path) {
+		std::FILE *file = std::fopen(path, "w");
+		if (file == nullptr) {
+			throw std::runtime_error("Failed to open benchmark output: " + std::string(path));
+		}
+
+		std::fprintf(file, "{\n\t\"device\": \"%s\",\n\t\"benchmarks\": [\n", _ctx.caps.properties.deviceName);
+		for (size_t i = 0; i < _results.size(); i++) {
+			const auto &result = _results[i];
+			std::fprintf(
+				file, "\t\t{\"name\": \"%s\", \"iterations\": %llu, \"ns\": %.2f, \"items\": %llu}%s\n",
+				result.name.c_str(), static_cast<unsigned long long>(result.iterations), result.ns,
+				static_cast<unsigned long long>(result.items), i + 1 < _results.size() ? "," : ""
+			);
+		}
+		std::fprintf(file, "\t]\n}\n");
+		std::fclose(file);
+	}
+
+	static int run(std::span<std::string_view> args) {
+		for (size_t i = 1; i < args.size(); i++) {
+			if (args[i] == "--device" && i + 1 < args.size()) {
+				_options.device = args[++i];
+			} else if (args[i] == "--filter" && i + 1 < args.size()) {
+				_options.filter = args[++i];
+			} else if (args[i] == "--json" && i + 1 < args.size()) {
+				_options.json = std::string(args[++i]);
+			} else {
+				throw std::runtime_error("Unknown argument: " + std::string(args[i]));
+			}
+		}
+
+		create_device();
+		create_target();
+		create_program();
+		_ctx.pipeline = create_pipeline(VK_NULL_HANDLE);
+
+		std::printf("%-40s %12s %17s\n", "benchmark", "iterations", "time");
+		bench_scene();
+		bench_culling();
+		bench_sorting();
+		bench_find_memory_type();
+		bench_recording();
+		bench_descriptors();
+		bench_staging();
+		bench_pipelines();
+
+		if (_options.json.has_value()) {
+			write_json(_options.json->c_str());
+			std::printf("Results written to %s\n", _options.json->c_str());
+		}
+
+		vkDeviceWaitIdle(_ctx.device);
+		vkDestroyPipeline(_ctx.device, _ctx.pipeline, nullptr);
+		vkDestroyShaderModule(_ctx.device, _ctx.vert, nullptr);
+		vkDestroyShaderModule(_ctx.device, _ctx.frag, nullptr);
+		destroy_layout_cache(_ctx.device);
+		destroy_buffer(_ctx.geometry, _ctx.geometry_memory);
+		vkDestroyFramebuffer(_ctx.device, _ctx.framebuffer, nullptr);
+		vkDestroyRenderPass(_ctx.device, _ctx.render_pass, nullptr);
+		vkDestroyImageView(_ctx.device, _ctx.target_view, nullptr);
+		vkDestroyImage(_ctx.device, _ctx.target, nullptr);
+		vkFreeMemory(_ctx.device, _ctx.target_memory, nullptr);
+		vkDestroyFence(_ctx.device, _ctx.fence, nullptr);
+		vkDestroyCommandPool(_ctx.device, _ctx.command_pool, nullptr);
+		vkDestroyDevice(_ctx.device, nullptr);
+		vkDestroyInstance(_ctx.instance, nullptr);
+		return EXIT_SUCCESS;
+	}
+}
+
+int main(const int argc, char **argv) {
+	std::vector<std::string_view> args(argv, argv + argc);
+
+	int res = EXIT_SUCCESS;
+
+	try {
+		res = VkDraw::run(args);
+	} catch (std::exception &e) {
+		std::fflush(stdout);
+		std::fprintf(stderr, "Unhandled exception: %s\n", e.what());
+		res = EXIT_FAILURE;
+	}
+
+	return res;
+}
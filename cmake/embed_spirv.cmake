@@ -0,0 +1,33 @@
+# converts a compiled SPIR-V module into a header with a constexpr uint32_t array
+# usage: cmake -DINPUT=<file.spv> -DOUTPUT=<file.h> -DSYMBOL=<name> -DSOURCE=<shader> -P embed_spirv.cmake
+
+file(READ ${INPUT} spirv HEX)
+string(LENGTH "${spirv}" spirv_length)
+math(EXPR spirv_remainder "${spirv_length} % 8")
+if (spirv_length EQUAL 0 OR NOT spirv_remainder EQUAL 0)
+	message(FATAL_ERROR "${INPUT} is not a valid SPIR-V module")
+endif ()
+
+# SPIR-V words are little-endian, swap each group of 4 bytes into a word literal
+set(byte "[0-9a-f][0-9a-f]")
+string(REGEX REPLACE "(${byte})(${byte})(${byte})(${byte})" "0x\\4\\3\\2\\1, " spirv "${spirv}")
+set(word "0x[0-9a-f]+, ")
+string(REGEX REPLACE "(${word}${word}${word}${word}${word}${word}${word}${word})" "\t\t\\1\n" spirv "${spirv}")
+string(REGEX REPLACE " \n" "\n" spirv "${spirv}")
+string(REGEX REPLACE "\n(0x)" "\n\t\t\\1" spirv "${spirv}")
+string(REGEX REPLACE ", $" ",\n" spirv "${spirv}")
+if (NOT spirv MATCHES "^\t\t")
+	set(spirv "\t\t${spirv}")
+endif ()
+
+file(
+	WRITE ${OUTPUT}
+	"#pragma once\n\n"
+	"#include <cstdint>\n\n"
+	"// generated from ${SOURCE}\n\n"
+	"namespace VkDraw {\n"
+	"\talignas(16) inline constexpr uint32_t ${SYMBOL}[] = {\n"
+	"${spirv}"
+	"\t};\n"
+	"}\n"
+)
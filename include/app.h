@@ -1,9 +1,129 @@
 #pragma once
 
+#include <cstdint>
 #include <cstdlib>
+#include <functional>
+#include <optional>
 #include <span>
 #include <string_view>
+#include <vector>
 
 namespace VkDraw {
-	int run(std::span<std::string_view> args);
+	// positions and sizes are in framebuffer pixels, with the origin in the top left corner
+	struct Vec2 {
+		float x;
+		float y;
+	};
+
+	// sRGB encoded, like colors everywhere else in 2D
+	struct Color {
+		uint8_t r;
+		uint8_t g;
+		uint8_t b;
+		uint8_t a = 255;
+	};
+
+	using TextureId = uint32_t; // 0 is a white pixel, so untextured shapes batch with each other
+	using FontId = uint32_t;
+
+	enum class BlendMode : uint8_t {
+		ALPHA,
+		ADDITIVE
+	};
+
+	// called once per frame with the seconds since the previous one, drawing is only valid inside it
+	using FrameCallback = std::function<void(float)>;
+
+	int run(std::span<std::string_view> args, const FrameCallback &on_frame = {});
+
+	Vec2 screen_size();
+
+	// loaded on first use and cached by path, the image must have 4 bytes per pixel
+	TextureId load_texture(const char *path);
+
+	// state applies to every following draw in the frame and is reset at the start of each frame
+	// lower layers are drawn first, within a layer draws are grouped by blend mode and then texture,
+	// so only draws that share both are guaranteed to keep their order
+	void set_layer(int32_t layer);
+	void set_blend_mode(BlendMode mode);
+
+	void draw_line(Vec2 from, Vec2 to, float thickness, Color color);
+	void draw_polyline(std::span<const Vec2> points, float thickness, Color color, bool closed = false);
+	void draw_rect(Vec2 pos, Vec2 size, float thickness, Color color);
+	void fill_rect(Vec2 pos, Vec2 size, Color color);
+	void draw_circle(Vec2 center, float radius, float thickness, Color color);
+	void fill_circle(Vec2 center, float radius, Color color);
+	void draw_sprite(TextureId texture, Vec2 pos, Vec2 size, Color tint = {255, 255, 255});
+	void draw_sprite(TextureId texture, Vec2 pos, Vec2 size, Vec2 uv_min, Vec2 uv_max, Color tint);
+
+	enum class FillRule : uint8_t {
+		NON_ZERO,
+		EVEN_ODD
+	};
+
+	enum class LineJoin : uint8_t {
+		MITER,
+		ROUND,
+		BEVEL
+	};
+
+	enum class LineCap : uint8_t {
+		BUTT,
+		ROUND,
+		SQUARE
+	};
+
+	struct StrokeStyle {
+		float width = 1.0f;
+		LineJoin join = LineJoin::MITER;
+		LineCap cap = LineCap::BUTT;
+		float miter_limit = 4.0f; // longest miter as a multiple of the width, sharper joins are beveled
+	};
+
+	// a vector path in pixels, cubics and arcs are approximated by quadratics as they are added
+	// build it once and draw it every frame, drawing only bins its curves, coverage is computed on the GPU
+	class Path {
+	public:
+		enum class Verb : uint8_t {
+			MOVE, // one point
+			LINE, // one point
+			QUAD, // control point then end point
+			CLOSE
+		};
+
+		Path &move_to(Vec2 point);
+		Path &line_to(Vec2 point);
+		Path &quad_to(Vec2 control, Vec2 point);
+		Path &cubic_to(Vec2 control1, Vec2 control2, Vec2 point);
+		// angles in radians, increasing clockwise on screen, a line joins the current point to the start
+		Path &arc(Vec2 center, float radius, float start_angle, float end_angle);
+		Path &close();
+		void clear();
+
+		std::span<const Verb> verbs() const { return _verbs; }
+		std::span<const Vec2> points() const { return _points; }
+
+	private:
+		void ensure_contour();
+
+		std::vector<Verb> _verbs;
+		std::vector<Vec2> _points;
+		Vec2 _start{}; // of the current contour
+		Vec2 _current{};
+		bool _has_contour = false;
+	};
+
+	void fill_path(const Path &path, Color color, FillRule rule = FillRule::NON_ZERO);
+	void stroke_path(const Path &path, const StrokeStyle &style, Color color);
+
+	// TrueType or OpenType, loaded on first use and cached by path, glyphs are added to the atlas as they
+	// are first drawn and stay there
+	FontId load_font(const char *path);
+	// the font given with --font, if any
+	std::optional<FontId> default_font();
+
+	// text is UTF-8 and size is the font's pixel size, pos is the top left of the first line and '\n'
+	// starts a new one
+	void draw_text(FontId font, Vec2 pos, float size, std::string_view text, Color color);
+	Vec2 measure_text(FontId font, float size, std::string_view text);
 }
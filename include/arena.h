@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace VkDraw {
+	struct FrameArenaStats {
+		uint64_t allocations = 0; // allocations served by the arena
+		size_t bytes = 0; // bytes handed out, including alignment padding
+		uint64_t upstream_allocations = 0; // allocations the arena itself had to make, zero in steady state
+	};
+
+	// a bump allocator for data that lives for a single frame, deallocation is a no-op and memory is
+	// only reclaimed by reset(), which must not be called while anything allocated from it is alive
+	// not thread safe, each frame in flight owns its own arena
+	class FrameArena final : public std::pmr::memory_resource {
+	public:
+		explicit FrameArena(
+			size_t capacity = 64 * 1024, std::pmr::memory_resource *upstream = std::pmr::new_delete_resource()
+		);
+		~FrameArena() override;
+
+		FrameArena(const FrameArena &) = delete;
+		FrameArena &operator=(const FrameArena &) = delete;
+
+		// releases everything and returns the stats of the frame that just ended
+		// when a frame overflowed the arena grows so that the same frame fits in one block next time
+		FrameArenaStats reset();
+
+		const FrameArenaStats &stats() const { return _stats; }
+		size_t capacity() const { return _capacity; }
+
+	private:
+		void *do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void *ptr, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+		struct Block {
+			std::byte *data;
+			size_t size;
+		};
+
+		std::pmr::memory_resource *_upstream;
+		std::byte *_block = nullptr; // primary block, sized to fit a whole frame
+		size_t _capacity;
+		std::vector<Block> _overflow; // blocks allocated when the primary block ran out
+		std::byte *_head = nullptr;
+		std::byte *_end = nullptr;
+		FrameArenaStats _stats;
+	};
+}
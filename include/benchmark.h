@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "profiler.h"
+
+namespace VkDraw {
+	// what the numbers of a run were measured on
+	struct BenchmarkInfo {
+		std::string_view device;
+		uint32_t width;
+		uint32_t height;
+		uint32_t frames_in_flight;
+	};
+
+	// every frame of a fixed length run, written out as a JSON summary so runs can be compared by script
+	class BenchmarkRecorder {
+	public:
+		explicit BenchmarkRecorder(uint32_t frames);
+
+		void record(const FrameStats &stats);
+		bool done() const { return _samples.size() >= _frames; }
+
+		// times as mean, min, percentiles and max, counters and statistics as per frame means
+		void write(const char *path, const BenchmarkInfo &info) const;
+
+	private:
+		uint32_t _frames;
+		std::vector<FrameStats> _samples;
+	};
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "app.h"
+
+namespace VkDraw {
+	// every 2D primitive is a quad spanned by two axes, matches the inputs of canvas.vert
+	// glyphs use the same layout, with shape as the on screen width in pixels of the atlas' distance range
+	struct CanvasInstance {
+		Vec2 origin;
+		Vec2 axis_x;
+		Vec2 axis_y;
+		Vec2 uv_min;
+		Vec2 uv_max;
+		uint32_t color; // RGBA8, red in the lowest byte
+		float shape; // < 0 box, otherwise an ellipse ring whose inner radius is this fraction of the outer
+	};
+
+	// one horizontal band of a path, matches the inputs of path.vert
+	struct PathBand {
+		Vec2 min; // pixel bounds of the band
+		Vec2 max;
+		uint32_t first; // word offset of the band's piece list in the frame's path data
+		uint32_t count;
+		uint32_t color; // RGBA8, red in the lowest byte
+		uint32_t mode; // PathMode
+		float half_width; // stroke only
+	};
+
+	// how path.frag turns a band's pieces into coverage
+	enum class PathMode : uint32_t {
+		NON_ZERO,
+		EVEN_ODD,
+		STROKE
+	};
+
+	// a piece of a path in the frame's path data, 8 words each
+	struct PathPiece {
+		Vec2 p0;
+		Vec2 p1;
+		Vec2 p2;
+		uint32_t kind; // PathPieceKind
+		uint32_t padding;
+	};
+
+	enum class PathPieceKind : uint32_t {
+		CURVE, // quadratic Bézier p0 p1 p2, monotonic in y when filled and with butt ends when stroked
+		TRIANGLE, // stroke joins
+		POINT // round stroke joins and caps at p0
+	};
+
+	enum class CanvasPipeline : uint8_t {
+		SHAPES, // CanvasInstance
+		PATHS, // PathBand
+		TEXT // CanvasInstance sampling a glyph atlas page
+	};
+
+	// a slice of the frame's GPU memory
+	struct CanvasAllocation {
+		VkBuffer buffer;
+		VkDeviceSize offset; // from the start of buffer
+		VkDeviceSize frame_offset; // from the start of the frame's region, which is what shaders index
+		std::byte *data;
+	};
+
+	// a run of instances in GPU memory that share a layer, pipeline, blend mode and texture
+	struct CanvasChunk {
+		uint64_t key;
+		VkBuffer buffer;
+		VkDeviceSize offset;
+		std::byte *data;
+		uint32_t count;
+		uint32_t capacity;
+
+		CanvasPipeline pipeline() const { return static_cast<CanvasPipeline>((key >> 28) & 0xf); }
+		BlendMode blend() const { return static_cast<BlendMode>((key >> 24) & 0xf); }
+		TextureId texture() const { return static_cast<TextureId>(key & 0xffffff); }
+	};
+
+	struct CanvasStats {
+		uint64_t primitives = 0;
+		uint32_t chunks = 0;
+	};
+
+	// collects the 2D draws of a frame, instances are written straight into GPU memory grouped by
+	// state so that sorting only moves chunks around, never the instances themselves
+	class Canvas {
+	public:
+		// a bucket's first chunk is small and each one after doubles, so many sparse buckets don't exhaust the
+		// frame's memory while a busy one still ends up in a few large chunks, in instances
+		static constexpr uint32_t FIRST_CHUNK_SIZE = 64;
+		static constexpr uint32_t MAX_CHUNK_SIZE = 4096;
+
+		// hands out 16 byte aligned GPU memory that stays valid until the frame retires
+		using Allocator = std::function<CanvasAllocation(VkDeviceSize size)>;
+
+		// scratch is for CPU data that only lives while the frame is recorded
+		void begin(Allocator allocate, std::pmr::memory_resource *scratch);
+
+		// chunks sorted by layer, pipeline, blend mode and texture, chunks with equal state keep their order
+		std::span<const CanvasChunk> end();
+
+		void set_layer(int32_t layer) { _layer = layer; }
+		void set_blend_mode(BlendMode mode) { _blend = mode; }
+
+		// room for count contiguous instances drawn with the current state
+		CanvasInstance *push(TextureId texture, uint32_t count = 1);
+		PathBand *push_bands(uint32_t count);
+		CanvasInstance *push_glyphs(TextureId page, uint32_t count = 1);
+
+		// GPU memory for data the instances refer to
+		CanvasAllocation allocate(VkDeviceSize size);
+		std::pmr::memory_resource *scratch() const { return _scratch; }
+
+		const CanvasStats &stats() const { return _stats; }
+
+	private:
+		std::byte *push_instances(uint64_t key, uint32_t stride, uint32_t count);
+		CanvasChunk allocate_chunk(uint64_t key, uint32_t stride, uint32_t count, uint32_t capacity);
+
+		struct Bucket {
+			uint64_t key;
+			uint32_t chunk; // the chunk currently being filled
+		};
+
+		Allocator _allocate;
+		std::pmr::memory_resource *_scratch = nullptr;
+		bool _recording = false;
+		int32_t _layer = 0;
+		BlendMode _blend = BlendMode::ALPHA;
+		// cleared every frame but never shrunk, so steady state recording doesn't allocate
+		std::vector<Bucket> _buckets;
+		std::vector<CanvasChunk> _chunks;
+		size_t _last_bucket = 0;
+		CanvasStats _stats;
+	};
+
+	// the canvas the drawing functions in app.h record into
+	Canvas &canvas();
+
+	// points the drawing functions at another canvas until the scope ends, so that internal passes
+	// can reuse them without mixing their draws into the frame's
+	class CanvasScope {
+	public:
+		explicit CanvasScope(Canvas &target);
+		~CanvasScope();
+
+		CanvasScope(const CanvasScope &) = delete;
+		CanvasScope &operator=(const CanvasScope &) = delete;
+
+	private:
+		Canvas *_previous;
+	};
+
+	uint32_t pack_color(Color color);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <SDL.h>
+#include <vulkan/vulkan.h>
+
+#include "device.h"
+#include "tasks.h"
+
+namespace VkDraw {
+	// a presented image in host memory, rows tightly packed, only valid for the duration of the sink call
+	struct CapturedFrame {
+		const uint8_t *pixels;
+		uint32_t width;
+		uint32_t height;
+		bool bgra; // byte order of the pixels, otherwise RGBA
+		uint64_t number; // the frame it was presented in
+	};
+
+	// called on the capture thread, one frame after another in the order they were presented
+	using CaptureSink = std::function<void(const CapturedFrame &frame)>;
+
+	// a copy converted to SDL_PIXELFORMAT_RGBA32, null if SDL fails
+	SDL_Surface *captured_surface(const CapturedFrame &frame);
+
+	// writes a single frame as a PNG
+	CaptureSink png_capture(std::string path);
+	// by the extension of path: .y4m is 4:2:0 video and .raw the bare pixels of every frame appended,
+	// anything else a numbered PNG per frame beside path, stream files are opened before this returns
+	CaptureSink open_capture_stream(const std::string &path);
+
+	// copies presented images into host visible buffers and hands them to sinks on a worker thread
+	// a buffer is only read once the fence of the frame that filled it has signalled, so capturing never waits
+	// on the GPU, frames of a stream are dropped instead while every buffer is in flight or being written
+	class FrameCapture {
+	public:
+		// frames is the number of frames in flight, a couple more buffers cover the writer falling behind
+		void init(const DeviceCapabilities &caps, uint32_t frames);
+		// the device must be idle, frames still waiting to be collected are written before returning
+		void destroy(VkDevice device);
+
+		// only 8-bit four channel images can be captured
+		static bool supported(VkFormat format);
+
+		// the next frame recorded goes to sink
+		void capture_next(CaptureSink sink) { _next.push_back(std::move(sink)); }
+		// every frame recorded goes to sink until it is replaced or cleared with nullptr
+		void set_stream(CaptureSink sink) { _stream = std::move(sink); }
+		bool streaming() const { return static_cast<bool>(_stream); }
+		bool wanted() const { return _stream || !_next.empty(); }
+
+		// copies image, which must be in the present layout with its rendering recorded before this,
+		// outside a render pass, returns false when nothing was recorded
+		bool record(
+			VkDevice device, VkCommandBuffer cmd, uint32_t frame, VkImage image, VkExtent2D extent, VkFormat format,
+			uint64_t number
+		);
+		// frame's fence must have signalled, its copies are queued for writing
+		void collect(VkDevice device, uint32_t frame);
+
+		uint32_t dropped() const { return _dropped; }
+
+	private:
+		static constexpr uint32_t NO_FRAME = ~0u;
+
+		struct Slot {
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkDeviceSize size = 0;
+			void *mapped = nullptr;
+			bool coherent = false;
+			uint32_t frame = NO_FRAME; // the frame in flight whose commands fill it
+			std::atomic<bool> writing = false; // cleared by the capture thread once every sink has run
+			CapturedFrame image{};
+			std::vector<CaptureSink> sinks;
+		};
+
+		void allocate(VkDevice device, Slot &slot, VkDeviceSize size);
+		void release(VkDevice device, Slot &slot);
+
+		const DeviceCapabilities *_caps = nullptr;
+		std::vector<Slot> _slots;
+		std::vector<CaptureSink> _next;
+		CaptureSink _stream;
+		uint32_t _dropped = 0;
+		std::unique_ptr<ThreadPool> _writer; // a single thread, so frames are written in order
+	};
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "tasks.h"
+
+namespace VkDraw {
+	// inward facing planes, xyz normalized, a point p is inside a plane when dot(plane, vec4(p, 1)) >= 0
+	struct Frustum {
+		std::array<glm::vec4, 6> planes; // left, right, bottom, top, near, far
+	};
+
+	// of a proj * view matrix with Vulkan's zero to one depth range
+	Frustum extract_frustum(const glm::mat4 &view_proj);
+
+	// world space bounding spheres as parallel arrays, so several are tested with each instruction
+	struct BoundingSpheres {
+		std::vector<float> x, y, z;
+		std::vector<float> radius;
+
+		void resize(size_t count);
+		size_t size() const { return radius.size(); }
+		void set(size_t i, glm::vec3 center, float r) {
+			x[i] = center.x;
+			y[i] = center.y;
+			z[i] = center.z;
+			radius[i] = r;
+		}
+	};
+
+	// writes the indices in [begin, end) of spheres touching the frustum to visible in ascending order and
+	// returns how many, visible must have room for end - begin
+	uint32_t cull_spheres(
+		const Frustum &frustum, const BoundingSpheres &spheres, uint32_t begin, uint32_t end, uint32_t *visible
+	);
+
+	// the same over every sphere, split between pool and the calling thread, visible is replaced
+	// scratch is working memory kept by the caller between calls, so culling every frame doesn't allocate
+	void cull_spheres(
+		const Frustum &frustum, const BoundingSpheres &spheres, ThreadPool &pool, std::vector<uint32_t> &visible,
+		std::vector<uint32_t> &scratch
+	);
+}
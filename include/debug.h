@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include <vulkan/vulkan.h>
+
+namespace VkDraw {
+	// VK_EXT_debug_utils object names and command buffer labels, shown by RenderDoc, Nsight and the
+	// validation layers, in release builds every call compiles to nothing
+	template <typename T>
+	constexpr VkObjectType debug_object_type() {
+		if constexpr (std::is_same_v<T, VkDevice>) {
+			return VK_OBJECT_TYPE_DEVICE;
+		} else if constexpr (std::is_same_v<T, VkQueue>) {
+			return VK_OBJECT_TYPE_QUEUE;
+		} else if constexpr (std::is_same_v<T, VkCommandPool>) {
+			return VK_OBJECT_TYPE_COMMAND_POOL;
+		} else if constexpr (std::is_same_v<T, VkCommandBuffer>) {
+			return VK_OBJECT_TYPE_COMMAND_BUFFER;
+		} else if constexpr (std::is_same_v<T, VkSemaphore>) {
+			return VK_OBJECT_TYPE_SEMAPHORE;
+		} else if constexpr (std::is_same_v<T, VkFence>) {
+			return VK_OBJECT_TYPE_FENCE;
+		} else if constexpr (std::is_same_v<T, VkBuffer>) {
+			return VK_OBJECT_TYPE_BUFFER;
+		} else if constexpr (std::is_same_v<T, VkImage>) {
+			return VK_OBJECT_TYPE_IMAGE;
+		} else if constexpr (std::is_same_v<T, VkImageView>) {
+			return VK_OBJECT_TYPE_IMAGE_VIEW;
+		} else if constexpr (std::is_same_v<T, VkDeviceMemory>) {
+			return VK_OBJECT_TYPE_DEVICE_MEMORY;
+		} else if constexpr (std::is_same_v<T, VkSampler>) {
+			return VK_OBJECT_TYPE_SAMPLER;
+		} else if constexpr (std::is_same_v<T, VkShaderModule>) {
+			return VK_OBJECT_TYPE_SHADER_MODULE;
+		} else if constexpr (std::is_same_v<T, VkPipeline>) {
+			return VK_OBJECT_TYPE_PIPELINE;
+		} else if constexpr (std::is_same_v<T, VkPipelineLayout>) {
+			return VK_OBJECT_TYPE_PIPELINE_LAYOUT;
+		} else if constexpr (std::is_same_v<T, VkRenderPass>) {
+			return VK_OBJECT_TYPE_RENDER_PASS;
+		} else if constexpr (std::is_same_v<T, VkFramebuffer>) {
+			return VK_OBJECT_TYPE_FRAMEBUFFER;
+		} else if constexpr (std::is_same_v<T, VkDescriptorSetLayout>) {
+			return VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT;
+		} else if constexpr (std::is_same_v<T, VkDescriptorPool>) {
+			return VK_OBJECT_TYPE_DESCRIPTOR_POOL;
+		} else if constexpr (std::is_same_v<T, VkDescriptorSet>) {
+			return VK_OBJECT_TYPE_DESCRIPTOR_SET;
+		} else if constexpr (std::is_same_v<T, VkQueryPool>) {
+			return VK_OBJECT_TYPE_QUERY_POOL;
+		} else if constexpr (std::is_same_v<T, VkSwapchainKHR>) {
+			return VK_OBJECT_TYPE_SWAPCHAIN_KHR;
+		} else {
+			static_assert(!sizeof(T), "Unsupported handle type for set_debug_name");
+		}
+	}
+
+#ifdef NDEBUG
+	inline void init_debug_utils(VkInstance) {}
+
+	template <typename T, typename... Args>
+	inline void set_debug_name(VkDevice, T, const char *, Args...) {}
+
+	inline void begin_debug_label(VkCommandBuffer, const char *) {}
+	inline void end_debug_label(VkCommandBuffer) {}
+
+	#define DEBUG_LABEL(cmd, name) ((void)(cmd), (void)(name))
+#else
+	// loads the entry points when the instance has the extension, until then every call is a no-op
+	void init_debug_utils(VkInstance instance);
+
+	void set_debug_name(VkDevice device, VkObjectType type, uint64_t handle, const char *format, ...);
+
+	// name is a printf format, so indexed objects can be told apart
+	template <typename T, typename... Args>
+	void set_debug_name(VkDevice device, T handle, const char *format, Args... args) {
+		if constexpr (std::is_pointer_v<T>) {
+			set_debug_name(device, debug_object_type<T>(), reinterpret_cast<uint64_t>(handle), format, args...);
+		} else {
+			set_debug_name(device, debug_object_type<T>(), static_cast<uint64_t>(handle), format, args...);
+		}
+	}
+
+	void begin_debug_label(VkCommandBuffer cmd, const char *name);
+	void end_debug_label(VkCommandBuffer cmd);
+
+	class DebugLabel {
+	public:
+		DebugLabel(VkCommandBuffer cmd, const char *name) : _cmd(cmd) { begin_debug_label(cmd, name); }
+		~DebugLabel() { end_debug_label(_cmd); }
+
+		DebugLabel(const DebugLabel &) = delete;
+		DebugLabel &operator=(const DebugLabel &) = delete;
+
+	private:
+		VkCommandBuffer _cmd;
+	};
+
+	#define VKDRAW_DEBUG_CONCAT_(a, b) a##b
+	#define VKDRAW_DEBUG_CONCAT(a, b) VKDRAW_DEBUG_CONCAT_(a, b)
+	// labels the commands recorded in the rest of the enclosing scope
+	#define DEBUG_LABEL(cmd, name) ::VkDraw::DebugLabel VKDRAW_DEBUG_CONCAT(_debug_label_, __LINE__)(cmd, name)
+#endif
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <type_traits>
+
+#include <vulkan/vulkan.h>
+
+namespace VkDraw {
+	// destroys Vulkan objects once the GPU has finished every frame that could still use them
+	// objects are destroyed in the order they were pushed, so push views before their images and
+	// images and buffers before their memory
+	class DeletionQueue {
+	public:
+		// last_frame is the number of the last frame that may use the object
+		template <typename T>
+		void push(uint64_t last_frame, T handle) {
+			if (handle == VK_NULL_HANDLE) {
+				return;
+			}
+			if constexpr (std::is_pointer_v<T>) {
+				push(last_frame, object_type<T>(), reinterpret_cast<uint64_t>(handle));
+			} else {
+				push(last_frame, object_type<T>(), static_cast<uint64_t>(handle));
+			}
+		}
+
+		void push(uint64_t last_frame, VkObjectType type, uint64_t handle);
+
+		// destroys everything whose last frame is before completed_frames
+		void collect(VkDevice device, uint64_t completed_frames);
+
+		// destroys everything, the device must be idle
+		void flush(VkDevice device);
+
+		size_t size() const { return _entries.size(); }
+
+	private:
+		struct Entry {
+			uint64_t last_frame;
+			VkObjectType type;
+			uint64_t handle;
+		};
+
+		template <typename T>
+		static constexpr VkObjectType object_type() {
+			if constexpr (std::is_same_v<T, VkBuffer>) {
+				return VK_OBJECT_TYPE_BUFFER;
+			} else if constexpr (std::is_same_v<T, VkImage>) {
+				return VK_OBJECT_TYPE_IMAGE;
+			} else if constexpr (std::is_same_v<T, VkImageView>) {
+				return VK_OBJECT_TYPE_IMAGE_VIEW;
+			} else if constexpr (std::is_same_v<T, VkDeviceMemory>) {
+				return VK_OBJECT_TYPE_DEVICE_MEMORY;
+			} else if constexpr (std::is_same_v<T, VkFramebuffer>) {
+				return VK_OBJECT_TYPE_FRAMEBUFFER;
+			} else if constexpr (std::is_same_v<T, VkSwapchainKHR>) {
+				return VK_OBJECT_TYPE_SWAPCHAIN_KHR;
+			} else if constexpr (std::is_same_v<T, VkPipeline>) {
+				return VK_OBJECT_TYPE_PIPELINE;
+			} else if constexpr (std::is_same_v<T, VkRenderPass>) {
+				return VK_OBJECT_TYPE_RENDER_PASS;
+			} else if constexpr (std::is_same_v<T, VkSampler>) {
+				return VK_OBJECT_TYPE_SAMPLER;
+			} else if constexpr (std::is_same_v<T, VkDescriptorPool>) {
+				return VK_OBJECT_TYPE_DESCRIPTOR_POOL;
+			} else {
+				static_assert(!sizeof(T), "Unsupported handle type for DeletionQueue");
+			}
+		}
+
+		std::deque<Entry> _entries; // sorted by last_frame since frames only move forward
+	};
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace VkDraw {
+	// everything the renderer needs to know about a physical device, queried once at device selection
+	struct DeviceCapabilities {
+		VkPhysicalDeviceProperties properties{};
+		VkPhysicalDeviceFeatures features{};
+		VkPhysicalDeviceVulkan11Features features11{}; // zeroed before 1.2, which introduced the struct
+		VkPhysicalDeviceVulkan12Features features12{}; // zeroed when the device is older than 1.2
+		VkPhysicalDeviceVulkan13Features features13{}; // zeroed when the device is older than 1.3
+		VkPhysicalDeviceMemoryProperties memory{};
+		std::vector<VkFormatProperties> formats; // core formats up to 1.3, look up through format()
+		std::vector<VkExtensionProperties> extensions;
+
+		// extension formats and formats newer than the device are reported as unsupported
+		const VkFormatProperties &format(VkFormat format) const;
+		bool has_extension(const char *name) const;
+
+		uint32_t find_memory_type(uint32_t filter, VkMemoryPropertyFlags flags) const;
+		// tries each set of flags in order, for memory where some properties are only nice to have
+		uint32_t find_memory_type(uint32_t filter, std::initializer_list<VkMemoryPropertyFlags> preferences) const;
+		VkFormat find_supported_format(
+			std::initializer_list<VkFormat> candidates, VkImageTiling tiling, VkFormatFeatureFlags features
+		) const;
+	};
+
+	DeviceCapabilities query_device_capabilities(VkPhysicalDevice device);
+
+	// whether a --device value names the device at index in enumeration order, by that index or by a substring
+	// of its name, an empty value names no device
+	bool device_matches(std::string_view selector, uint32_t index, std::string_view name);
+}
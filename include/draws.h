@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "tasks.h"
+
+namespace VkDraw {
+	// bits of each field of a sort key, most significant first
+	static constexpr uint32_t SORT_PASS_BITS = 4;
+	static constexpr uint32_t SORT_PIPELINE_BITS = 12;
+	static constexpr uint32_t SORT_MATERIAL_BITS = 16;
+	static constexpr uint32_t SORT_DEPTH_BITS = 32;
+	static_assert(SORT_PASS_BITS + SORT_PIPELINE_BITS + SORT_MATERIAL_BITS + SORT_DEPTH_BITS == 64);
+
+	static constexpr uint32_t SORT_RADIX_BITS = 8; // per pass of sort_draws
+
+	// passes in the order they are recorded
+	static constexpr uint32_t DRAW_PASS_OPAQUE = 0;
+
+	// a draw of one object, object is whatever the recording code needs to look it up
+	struct DrawItem {
+		uint64_t key;
+		uint32_t object;
+	};
+
+	// sorting by key groups draws by pass, then pipeline, then material, so consecutive draws share as much
+	// bound state as possible, and orders each group front to back by view depth, fields wider than their
+	// bits are truncated, pass a negated depth for back to front
+	inline uint64_t draw_sort_key(uint32_t pass, uint32_t pipeline, uint32_t material, float depth) {
+		// non-negative floats order the same as their bits, negative depths are behind the camera anyway
+		const auto depth_bits = std::bit_cast<uint32_t>(depth > 0.0f ? depth : 0.0f);
+		const auto field = [](uint32_t value, uint32_t bits) { return value & ((1u << bits) - 1); };
+		return static_cast<uint64_t>(field(pass, SORT_PASS_BITS)) << (64 - SORT_PASS_BITS) |
+			static_cast<uint64_t>(field(pipeline, SORT_PIPELINE_BITS)) << (SORT_MATERIAL_BITS + SORT_DEPTH_BITS) |
+			static_cast<uint64_t>(field(material, SORT_MATERIAL_BITS)) << SORT_DEPTH_BITS |
+			depth_bits;
+	}
+
+	inline uint32_t draw_sort_pipeline(uint64_t key) {
+		return static_cast<uint32_t>(key >> (SORT_MATERIAL_BITS + SORT_DEPTH_BITS)) & ((1u << SORT_PIPELINE_BITS) - 1);
+	}
+
+	// working memory of sort_draws, kept by the caller between calls so sorting doesn't allocate
+	struct DrawSortScratch {
+		std::vector<DrawItem> draws;
+		std::vector<std::array<uint32_t, 1u << SORT_RADIX_BITS>> histograms; // a digit histogram per range
+	};
+
+	// stable least significant digit radix sort by key, each digit's counting and scattering is split between
+	// pool and the calling thread, digits every key shares are skipped
+	void sort_draws(std::vector<DrawItem> &draws, DrawSortScratch &scratch, ThreadPool &pool);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+#include <SDL.h>
+
+namespace VkDraw {
+	// per pixel YIQ distance as a fraction of the largest possible, small enough to catch a wrong color but
+	// not antialiasing that differs between drivers
+	inline constexpr double GOLDEN_THRESHOLD = 0.1;
+	// share of pixels that may exceed the threshold before the images are considered different
+	inline constexpr double GOLDEN_MAX_MISMATCH = 0.001;
+
+	struct GoldenResult {
+		bool size_matches;
+		uint64_t pixels;
+		uint64_t mismatched; // pixels over GOLDEN_THRESHOLD
+		double max_delta; // largest per pixel distance, on the same scale as GOLDEN_THRESHOLD
+
+		bool passed() const {
+			return size_matches && static_cast<double>(mismatched) <= static_cast<double>(pixels) * GOLDEN_MAX_MISMATCH;
+		}
+	};
+
+	// both surfaces must be SDL_PIXELFORMAT_RGBA32, alpha is ignored since the swapchain is always opaque
+	// mismatched pixels are drawn red into diff over a faded copy of expected, diff may be null
+	GoldenResult compare_images(const SDL_Surface &expected, const SDL_Surface &actual, SDL_Surface *diff);
+
+	// compares actual with the PNG at path, on failure the actual image and the diff are written beside it
+	// as <path>.actual.png and <path>.diff.png
+	GoldenResult check_golden(const char *path, SDL_Surface &actual);
+	void update_golden(const char *path, SDL_Surface &actual);
+}
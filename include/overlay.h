@@ -0,0 +1,32 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "app.h"
+#include "profiler.h"
+
+namespace VkDraw {
+	// rolling CPU and GPU time graphs and the latest frame's numbers, drawn over everything else
+	// each frame is one bar, so a spike shows up in the frame after the one that caused it
+	class PerfOverlay {
+	public:
+		static constexpr size_t HISTORY = 240; // frames
+
+		void record(const FrameStats &stats);
+
+		// draws into canvas(), the graphs are always drawn but text needs a font
+		void draw(std::optional<FontId> font) const;
+
+		bool visible() const { return _visible; }
+		void set_visible(bool visible) { _visible = visible; }
+
+	private:
+		bool _visible = false;
+		std::array<float, HISTORY> _cpu_ms{};
+		std::array<float, HISTORY> _gpu_ms{};
+		size_t _next = 0; // the oldest sample, overwritten by the next record
+		FrameStats _latest;
+	};
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace VkDraw {
+	// the GPU work of a frame in submission order, each pass is timed from the end of the one before
+	enum class GpuPass : uint32_t {
+		UPLOADS,
+		SCENE,
+		CANVAS,
+		OVERLAY,
+		COUNT
+	};
+
+	inline constexpr size_t GPU_PASS_COUNT = static_cast<size_t>(GpuPass::COUNT);
+
+	const char *gpu_pass_name(GpuPass pass);
+
+	struct GpuFrameTimings {
+		bool valid = false; // false until the first results come back or when timestamps are unsupported
+		double total_ms = 0.0;
+		std::array<double, GPU_PASS_COUNT> pass_ms{};
+		uint64_t begin_ticks = 0; // the raw timestamp the frame started at, for placing it on a timeline
+	};
+
+	// what a frame asked the GPU to do, counted on the CPU while the frame is built and recorded
+	struct RenderCounters {
+		uint32_t draws = 0;
+		uint32_t culled = 0; // objects left out by frustum culling
+		uint64_t triangles = 0;
+		uint32_t pipeline_binds = 0;
+		uint32_t descriptor_binds = 0; // descriptor sets bound, not sets written
+		uint32_t buffer_binds = 0; // vertex and index buffers
+		uint32_t barriers = 0; // pipeline barrier commands, each may hold several barriers
+		uint32_t descriptor_updates = 0; // descriptors written
+		uint32_t binds_saved = 0; // skipped because the draw before had already bound the same state
+
+		uint32_t binds() const { return pipeline_binds + descriptor_binds + buffer_binds; }
+	};
+
+	// what the GPU actually did for a frame, fragment invocations over the framebuffer's pixels is the overdraw
+	// and clipping primitives over clipping invocations the share of primitives that survived clipping
+	struct PipelineStatistics {
+		bool valid = false; // false until the first results come back or when the device can't count
+		uint64_t input_vertices = 0;
+		uint64_t input_primitives = 0;
+		uint64_t vertex_invocations = 0;
+		uint64_t clipping_invocations = 0;
+		uint64_t clipping_primitives = 0;
+		uint64_t fragment_invocations = 0;
+	};
+
+	struct FrameStats {
+		double cpu_ms = 0.0; // recording and submitting, from the fence wait returning to present
+		double frame_ms = 0.0; // between the starts of consecutive frames
+		GpuFrameTimings gpu;
+		PipelineStatistics pipeline;
+		RenderCounters counters;
+		uint64_t canvas_primitives = 0;
+		uint64_t pixels = 0; // of the framebuffer the frame was drawn to
+		uint64_t memory_used = 0; // device local bytes used by this process, zero when the device can't tell
+		uint64_t memory_budget = 0;
+	};
+
+	// timestamps around each pass of a frame, read back once the frame's fence has signalled so reading
+	// never stalls, at the cost of the results being a couple of frames old
+	class GpuTimer {
+	public:
+		// period is the device's timestampPeriod and valid_bits the queue family's timestampValidBits,
+		// zero valid bits leaves the timer disabled
+		void init(VkDevice device, float period, uint32_t valid_bits, uint32_t frames);
+		void destroy(VkDevice device);
+
+		bool enabled() const { return _pool != VK_NULL_HANDLE; }
+
+		// the latest timings, updated from frame's previous use if it has finished since
+		const GpuFrameTimings &collect(VkDevice device, uint32_t frame);
+
+		// begin must be recorded outside a render pass, every pass must then be ended once in order
+		void begin(VkCommandBuffer cmd, uint32_t frame);
+		void end_pass(VkCommandBuffer cmd, uint32_t frame, GpuPass pass);
+
+		// VK_EXT_calibrated_timestamps must have been enabled on the device, without it timestamps can't be
+		// placed on the host's timeline
+		void enable_calibration(VkInstance instance, VkPhysicalDevice physical_device, VkDevice device);
+		bool calibrated() const { return _get_calibrated_timestamps != nullptr; }
+		// samples the device and host clocks together, host_ns is most accurate for ticks close to the last one
+		void calibrate(VkDevice device);
+		// a timestamp from this timer on the trace_now timeline
+		int64_t host_ns(uint64_t ticks) const;
+
+	private:
+		static constexpr uint32_t QUERIES_PER_FRAME = GPU_PASS_COUNT + 1;
+
+		VkQueryPool _pool = VK_NULL_HANDLE;
+		double _tick_ms = 0.0;
+		uint64_t _tick_mask = 0;
+		PFN_vkGetCalibratedTimestampsEXT _get_calibrated_timestamps = nullptr;
+		bool _host_domain = false; // the host clock is steady_clock itself, otherwise the call is bracketed
+		uint64_t _calibration_ticks = 0;
+		int64_t _calibration_ns = 0;
+		std::vector<bool> _pending; // by frame, queries were written and not yet read
+		GpuFrameTimings _latest;
+	};
+
+	// one pipeline statistics query around everything a frame draws, read back like GpuTimer
+	// needs the pipelineStatisticsQuery feature, the caller only initializes it when the device has it
+	class PipelineStatsQuery {
+	public:
+		void init(VkDevice device, uint32_t frames);
+		void destroy(VkDevice device);
+
+		bool enabled() const { return _pool != VK_NULL_HANDLE; }
+
+		const PipelineStatistics &collect(VkDevice device, uint32_t frame);
+
+		// both must be recorded outside a render pass
+		void begin(VkCommandBuffer cmd, uint32_t frame);
+		void end(VkCommandBuffer cmd, uint32_t frame);
+
+	private:
+		VkQueryPool _pool = VK_NULL_HANDLE;
+		std::vector<bool> _pending;
+		PipelineStatistics _latest;
+	};
+}
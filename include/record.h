@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include <vulkan/vulkan.h>
+
+#include <glm/glm.hpp>
+
+#include "draws.h"
+#include "profiler.h"
+
+namespace VkDraw {
+	// the state record_draws binds, everything but the pipeline is shared by every draw
+	struct DrawBindings {
+		std::span<const VkPipeline> pipelines; // by the pipeline field of the sort key, all that draws use compiled
+		VkPipelineLayout layout;
+		VkBuffer vertex_buffer;
+		VkBuffer index_buffer;
+		VkIndexType index_type;
+		uint32_t index_count;
+		VkDescriptorSet set; // bound as set 0 with a single dynamic offset
+		uint32_t dynamic_offset;
+		std::span<const glm::mat4> models; // by draw object, pushed to the vertex stage
+	};
+
+	// records draws sorted by sort_draws inside a render pass, binding each piece of state only when it differs
+	// from the draw before's, and adds what was drawn and bound to counters
+	void record_draws(
+		VkCommandBuffer cmd, std::span<const DrawItem> draws, const DrawBindings &bindings, RenderCounters &counters
+	);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace VkDraw {
+	struct ShaderReflection {
+		VkShaderStageFlagBits stage{};
+		std::vector<std::vector<VkDescriptorSetLayoutBinding>> sets; // indexed by set number
+		std::vector<VkPushConstantRange> push_constants;
+		std::vector<VkVertexInputAttributeDescription> inputs; // only populated for vertex shaders
+		uint32_t input_stride = 0;
+	};
+
+	struct PipelineReflection {
+		std::vector<std::vector<VkDescriptorSetLayoutBinding>> sets;
+		std::vector<VkPushConstantRange> push_constants;
+		VkVertexInputBindingDescription binding{};
+		std::vector<VkVertexInputAttributeDescription> attributes;
+	};
+
+	// parse the decorations and global variables of a SPIR-V module
+	ShaderReflection reflect_shader(std::span<const uint32_t> code);
+
+	// merge the reflection of each stage into a single pipeline interface
+	PipelineReflection reflect_pipeline(std::span<const ShaderReflection> stages);
+
+	// move the attributes to the host struct's offsets, given in location order, and throw if any input overlaps
+	// the next member or the end of the struct
+	void apply_vertex_layout(PipelineReflection &reflection, std::span<const uint32_t> offsets, uint32_t stride);
+
+	// layouts are deduplicated by their contents, the cache owns every handle it returns
+	VkDescriptorSetLayout get_set_layout(VkDevice device, std::span<const VkDescriptorSetLayoutBinding> bindings);
+	VkPipelineLayout get_pipeline_layout(
+		VkDevice device, std::span<const VkDescriptorSetLayout> sets, std::span<const VkPushConstantRange> ranges
+	);
+	void destroy_layout_cache(VkDevice device);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace VkDraw {
+	using NodeId = uint32_t;
+	inline constexpr NodeId NO_NODE = ~0u;
+
+	struct Transform {
+		glm::vec3 translation{0.0f};
+		glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f}; // must be normalized
+		glm::vec3 scale{1.0f};
+	};
+
+	// a transform hierarchy stored as parallel arrays in topological order, parents always before their
+	// children, so world matrices are computed in one pass with every parent's already up to date
+	// changing a local transform marks its node dirty and update() only recomputes dirty nodes and their
+	// descendants, a NodeId stays valid however the arrays are reordered
+	class SceneGraph {
+	public:
+		NodeId add(const Transform &local = {}, NodeId parent = NO_NODE);
+		// throws if parent is node or one of its descendants
+		void set_parent(NodeId node, NodeId parent);
+		size_t size() const { return _parent.size(); }
+
+		void set_local(NodeId node, const Transform &local);
+		void set_translation(NodeId node, glm::vec3 translation);
+		void set_rotation(NodeId node, glm::quat rotation);
+		void set_scale(NodeId node, glm::vec3 scale);
+		Transform local(NodeId node) const;
+
+		// re-sorts after parents changed, then brings the world matrices of dirty subtrees up to date
+		void update();
+
+		// as of the last update
+		const glm::mat4 &world(NodeId node) const { return _world[_index[node]]; }
+		// in topological order, index with index_of
+		std::span<const glm::mat4> world_matrices() const { return _world; }
+		uint32_t index_of(NodeId node) const { return _index[node]; }
+		uint32_t updated() const { return _updated; } // world matrices recomputed by the last update
+
+	private:
+		void sort();
+		void update_worlds();
+
+		// by position in topological order
+		std::vector<uint32_t> _parent; // position of the parent, NO_NODE for roots
+		std::vector<float> _tx, _ty, _tz;
+		std::vector<float> _rx, _ry, _rz, _rw;
+		std::vector<float> _sx, _sy, _sz;
+		std::vector<glm::mat4> _world;
+		std::vector<uint8_t> _dirty; // bytes rather than bits, so a block of four is tested with one load
+		std::vector<NodeId> _node;
+
+		std::vector<uint32_t> _index; // by NodeId, position in topological order
+		bool _sorted = true;
+		uint32_t _updated = 0;
+	};
+}
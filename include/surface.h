@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include <vulkan/vulkan.h>
+
+namespace VkDraw {
+	// what the swapchain should be able to display, in increasing order of cost
+	enum class ColorOutput {
+		SDR, // 8-bit sRGB
+		DEEP, // 10-bit sRGB, removes banding in gradients
+		HDR, // whichever of HDR10 and scRGB is cheaper
+		HDR10, // 10-bit BT.2020 with the ST 2084 (PQ) transfer function
+		SCRGB // 16-bit float linear extended sRGB
+	};
+
+	// how the fragment shader must encode its output for the chosen surface format
+	// must match OUTPUT_ENCODING in shaders/shader.frag
+	enum class OutputEncoding : uint32_t {
+		NONE = 0, // hardware sRGB encoding or a linear color space
+		SRGB = 1,
+		PQ = 2
+	};
+
+	enum class PresentPreference {
+		AUTO, // mailbox unless the device is low power, then fifo
+		FIFO,
+		RELAXED,
+		MAILBOX,
+		IMMEDIATE
+	};
+
+	struct SurfacePreferences {
+		ColorOutput output = ColorOutput::SDR;
+		PresentPreference present = PresentPreference::AUTO;
+	};
+
+	struct SurfaceFormatChoice {
+		VkSurfaceFormatKHR format;
+		OutputEncoding encoding;
+		ColorOutput output;
+		uint32_t bytes_per_pixel;
+	};
+
+	ColorOutput parse_color_output(std::string_view name);
+	PresentPreference parse_present_preference(std::string_view name);
+	const char *color_output_name(ColorOutput output);
+	const char *present_mode_name(VkPresentModeKHR mode);
+
+	// the requested output is tried first, then progressively cheaper outputs, ties between formats
+	// of the same output are broken by bytes per pixel and then by avoiding shader side encoding
+	SurfaceFormatChoice choose_surface_format(std::span<const VkSurfaceFormatKHR> formats, ColorOutput output);
+	VkPresentModeKHR choose_present_mode(
+		std::span<const VkPresentModeKHR> modes, PresentPreference preference, bool low_power
+	);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace VkDraw {
+	class ThreadPool {
+	public:
+		explicit ThreadPool(uint32_t threads);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		void submit(std::function<void()> job);
+		uint32_t size() const { return _workers.size(); }
+
+		// index of the calling worker, or size() when called from any other thread
+		uint32_t worker_index() const;
+
+		// calls call(fn, chunk) for every chunk in [0, chunks) on the workers and the calling thread and returns
+		// once all have finished, nothing is allocated, call must not throw
+		// runs every chunk on the calling thread when another fork is already in progress
+		void fork(uint32_t chunks, void (*call)(const void *fn, uint32_t chunk), const void *fn);
+
+	private:
+		void worker_loop(uint32_t index);
+		void run_fork();
+
+		std::vector<std::thread> _workers;
+		std::deque<std::function<void()>> _jobs;
+		std::mutex _mutex;
+		std::condition_variable _cv;
+		bool _stopping = false;
+
+		// the fork in progress, chunks are claimed by counting _fork_next up, workers join while it is below
+		// _fork_chunks and the fork is over once none of them is still inside
+		std::mutex _fork_mutex; // held by the thread running a fork
+		void (*_fork_call)(const void *fn, uint32_t chunk) = nullptr;
+		const void *_fork_fn = nullptr;
+		uint32_t _fork_chunks = 0;
+		std::atomic<uint32_t> _fork_next = 0;
+		uint32_t _fork_workers = 0; // guarded by _mutex
+		std::condition_variable _fork_cv;
+	};
+
+	// a one-shot dependency graph, tasks start as soon as all of their dependencies have finished
+	class TaskGraph {
+	public:
+		using TaskId = uint32_t;
+		using Clock = std::chrono::steady_clock;
+
+		TaskId add(
+			std::string_view name, std::function<void()> fn, std::initializer_list<TaskId> deps = {},
+			bool main_thread = false
+		);
+
+		// blocks until every task has run, main thread tasks are executed by the caller
+		// the first exception thrown by a task is rethrown once in-flight tasks have drained
+		void run(ThreadPool &pool);
+
+		void print_timeline(Clock::time_point end = Clock::now()) const;
+		Clock::time_point epoch() const { return _epoch; }
+
+	private:
+		struct Task {
+			std::string name;
+			std::function<void()> fn;
+			std::vector<TaskId> dependents;
+			uint32_t pending = 0;
+			bool main_thread = false;
+			uint32_t thread = 0;
+			Clock::time_point start;
+			Clock::time_point end;
+		};
+
+		void execute(TaskId id, ThreadPool &pool, uint32_t thread);
+		void schedule(TaskId id, ThreadPool &pool);
+
+		std::vector<Task> _tasks;
+		std::deque<TaskId> _main_queue;
+		std::mutex _mutex;
+		std::condition_variable _cv;
+		uint32_t _finished = 0;
+		uint32_t _running = 0;
+		std::exception_ptr _error;
+		Clock::time_point _epoch;
+	};
+
+	// splits [0, count) into contiguous ranges of at least grain items, at most one per worker plus the calling
+	// thread, and blocks until fn(chunk, begin, end) has run for each, chunk numbers the ranges in order from
+	// zero and the same count is always split the same way, nothing is allocated and fn must not throw
+	template <typename Fn>
+	void parallel_for(ThreadPool &pool, uint32_t count, uint32_t grain, const Fn &fn) {
+		const uint32_t chunks = std::clamp((count + grain - 1) / std::max(grain, 1u), 1u, pool.size() + 1);
+		if (chunks == 1) {
+			fn(0u, 0u, count);
+			return;
+		}
+
+		const uint32_t size = (count + chunks - 1) / chunks;
+		const auto range = [&fn, count, size](uint32_t chunk) {
+			const uint32_t begin = std::min(chunk * size, count);
+			fn(chunk, begin, std::min(begin + size, count));
+		};
+		using Range = decltype(range);
+		const auto call = [](const void *range, uint32_t chunk) { (*static_cast<const Range *>(range))(chunk); };
+		pool.fork(chunks, call, &range);
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <SDL_ttf.h>
+#include <vulkan/vulkan.h>
+
+#include "canvas.h"
+
+namespace VkDraw {
+	// a glyph's quad and where it sits in the atlas, in pixels at FontAtlas::GLYPH_SIZE
+	struct Glyph {
+		Vec2 offset; // from the pen position on the baseline to the top left of the quad
+		Vec2 size; // zero for glyphs with nothing to draw, like spaces
+		Vec2 uv_min;
+		Vec2 uv_max;
+		float advance;
+		uint32_t page;
+	};
+
+	// rows of an atlas page that changed, staged in the frame's GPU memory
+	struct AtlasUpload {
+		TextureId texture;
+		bool initial; // the page has never been uploaded, so its previous contents are undefined
+		uint32_t y;
+		uint32_t height;
+		VkBuffer buffer;
+		VkDeviceSize offset;
+	};
+
+	// glyphs of every loaded font as signed distance fields, packed into single channel pages
+	// a distance field scales to any size, so each glyph is rasterized once no matter how it is drawn
+	class FontAtlas {
+	public:
+		static constexpr uint32_t PAGE_SIZE = 1024; // pixels square, one byte per pixel
+		static constexpr int GLYPH_SIZE = 48; // pixel size glyphs are rasterized at
+		static constexpr uint32_t SPREAD = 6; // pixels of distance stored either side of an outline
+
+		// creates an empty page texture, pages are only written through the uploads flush returns
+		using PageCreator = std::function<TextureId()>;
+
+		void init(PageCreator create_page);
+		// closes every font, page textures belong to whoever created them
+		void shutdown();
+
+		FontId load(const char *path);
+		size_t font_count() const { return _fonts.size(); }
+
+		// rasterizes the glyph the first time it is asked for
+		const Glyph &glyph(FontId font, uint32_t codepoint);
+		float kerning(FontId font, uint32_t previous, uint32_t codepoint);
+		float ascent(FontId font) const { return _fonts[font].ascent; }
+		float line_height(FontId font) const { return _fonts[font].line_height; }
+		TextureId page_texture(uint32_t page) const { return _pages[page].texture; }
+
+		// stages the rows written since the last flush, they must be copied before the pages are sampled
+		std::span<const AtlasUpload> flush(const Canvas::Allocator &allocate);
+
+	private:
+		struct Font {
+			TTF_Font *font;
+			float ascent;
+			float line_height;
+			std::unordered_map<uint32_t, Glyph> glyphs;
+		};
+
+		struct Page {
+			TextureId texture;
+			std::vector<uint8_t> pixels;
+			uint32_t shelf_x = 0; // glyphs are packed left to right along shelves, top to bottom
+			uint32_t shelf_y = 0;
+			uint32_t shelf_height = 0;
+			uint32_t dirty_begin = 0; // rows
+			uint32_t dirty_end = PAGE_SIZE;
+			bool uploaded = false;
+		};
+
+		Glyph rasterize(const Font &font, uint32_t codepoint);
+		// finds room for a width by height rectangle, starting a new page when the last one is full
+		uint32_t place(uint32_t width, uint32_t height, uint32_t &x, uint32_t &y);
+
+		PageCreator _create_page;
+		std::vector<Font> _fonts; // indexed by FontId
+		std::unordered_map<std::string, FontId> _font_paths;
+		std::vector<Page> _pages;
+		std::vector<AtlasUpload> _uploads;
+		// distance transform working memory, kept between glyphs
+		std::vector<double> _outer;
+		std::vector<double> _inner;
+		std::vector<double> _line;
+		std::vector<double> _bounds;
+		std::vector<uint32_t> _parabolas;
+	};
+
+	// the atlas draw_text renders from
+	FontAtlas &font_atlas();
+}
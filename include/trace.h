@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace VkDraw {
+	// nanoseconds on std::chrono::steady_clock, the timeline every trace event is placed on
+	inline int64_t trace_now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()
+		).count();
+	}
+
+	// events recorded before start or after the trace is written are dropped, each thread keeps its last
+	// TRACE_CAPACITY events in its own ring so recording never takes a lock
+	inline constexpr uint32_t TRACE_CAPACITY = 1 << 16;
+
+	void start_trace();
+	bool tracing();
+	// names the calling thread's track, defaults to "thread <n>" in the order threads first record
+	void set_trace_thread_name(const char *name);
+
+	// name must outlive the trace, in practice a string literal
+	void trace_event(const char *name, int64_t start_ns, int64_t duration_ns);
+	// events on the GPU's own track, only ever called from the thread that collects GPU results
+	void trace_gpu_event(const char *name, int64_t start_ns, int64_t duration_ns);
+
+	// Chrome trace event JSON, for chrome://tracing or Perfetto, every recording thread must be idle
+	void write_trace(const char *path);
+
+	class TraceScope {
+	public:
+		explicit TraceScope(const char *name) : _name(name), _start(tracing() ? trace_now() : -1) {}
+		~TraceScope() {
+			if (_start >= 0) {
+				trace_event(_name, _start, trace_now() - _start);
+			}
+		}
+
+		TraceScope(const TraceScope &) = delete;
+		TraceScope &operator=(const TraceScope &) = delete;
+
+	private:
+		const char *_name;
+		int64_t _start;
+	};
+}
+
+#define VKDRAW_TRACE_CONCAT_(a, b) a##b
+#define VKDRAW_TRACE_CONCAT(a, b) VKDRAW_TRACE_CONCAT_(a, b)
+// times the rest of the enclosing scope
+#define TRACE_SCOPE(name) ::VkDraw::TraceScope VKDRAW_TRACE_CONCAT(_trace_scope_, __LINE__)(name)
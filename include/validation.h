@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace VkDraw {
+	enum class ValidationMode {
+		OFF,
+		STANDARD, // the core checks of VK_LAYER_KHRONOS_validation
+		GPU_ASSISTED, // instruments shaders to check descriptor indexing and buffer accesses on the GPU
+		SYNCHRONIZATION, // missing, redundant and misplaced barriers, semaphores and layout transitions
+		BEST_PRACTICES // valid but slow usage
+	};
+
+	ValidationMode parse_validation_mode(std::string_view name);
+
+	// the VK_EXT_validation_features entries a mode adds on top of the standard checks
+	std::vector<VkValidationFeatureEnableEXT> validation_features(ValidationMode mode);
+
+	// collects validation messages through a debug messenger instead of the layer's own output
+	// every message is counted by ID, only the first of each is printed, so a per frame error can't flood the log
+	class ValidationSink {
+	public:
+		// chained into VkInstanceCreateInfo, it also catches messages from instance creation and destruction
+		VkDebugUtilsMessengerCreateInfoEXT create_info();
+
+		void init(VkInstance instance);
+		void destroy(VkInstance instance);
+
+		uint32_t errors() const;
+		uint32_t warnings() const;
+
+		// each distinct message ID with its count, most frequent first
+		void print_summary() const;
+
+	private:
+		struct Message {
+			std::string name;
+			VkDebugUtilsMessageSeverityFlagBitsEXT severity;
+			uint32_t count = 0;
+		};
+
+		static VkBool32 callback(
+			VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT types,
+			const VkDebugUtilsMessengerCallbackDataEXT *data, void *user
+		);
+		void record(VkDebugUtilsMessageSeverityFlagBitsEXT severity, const VkDebugUtilsMessengerCallbackDataEXT &data);
+
+		VkDebugUtilsMessengerEXT _messenger = VK_NULL_HANDLE;
+		mutable std::mutex _mutex; // layers report from whichever thread made the call
+		std::unordered_map<int32_t, Message> _messages; // by messageIdNumber
+		uint32_t _errors = 0;
+		uint32_t _warnings = 0;
+	};
+}
@@ -0,0 +1,33 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "output.glsl"
+
+layout (binding = 0) uniform sampler2D tex;
+
+layout (location = 0) in vec4 inColor;
+layout (location = 1) in vec2 inTexCoord;
+layout (location = 2) in vec2 inLocal; // -1 to 1 across the quad
+layout (location = 3) flat in float inShape; // < 0 box, otherwise a ring with this inner radius
+
+layout (location = 0) out vec4 outColor;
+
+void main() {
+	vec4 color = inColor * texture(tex, inTexCoord);
+
+	// ellipses are anti-aliased analytically against the distance to their edges
+	if (inShape >= 0.0) {
+		float d = length(inLocal);
+		float aa = max(fwidth(d), 1e-4);
+		float coverage = clamp((1.0 - d) / aa + 0.5, 0.0, 1.0);
+		if (inShape > 0.0) {
+			coverage *= clamp((d - inShape) / aa + 0.5, 0.0, 1.0);
+		}
+		if (coverage <= 0.0) {
+			discard;
+		}
+		color.a *= coverage;
+	}
+
+	outColor = vec4(encode_output(color.rgb), color.a);
+}
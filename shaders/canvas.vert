@@ -0,0 +1,34 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "color.glsl"
+
+layout (push_constant) uniform Canvas {
+	vec2 scale; // 2 / framebuffer size in pixels
+} canvas;
+
+// one instance per primitive, see CanvasInstance in canvas.h
+layout (location = 0) in vec2 inOrigin;
+layout (location = 1) in vec2 inAxisX;
+layout (location = 2) in vec2 inAxisY;
+layout (location = 3) in vec2 inUVMin;
+layout (location = 4) in vec2 inUVMax;
+layout (location = 5) in uint inColor;
+layout (location = 6) in float inShape;
+
+layout (location = 0) out vec4 outColor;
+layout (location = 1) out vec2 outTexCoord;
+layout (location = 2) out vec2 outLocal;
+layout (location = 3) flat out float outShape;
+
+void main() {
+	// a 4 vertex triangle strip over the corners (0, 0) (1, 0) (0, 1) (1, 1)
+	vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1);
+	vec2 pos = inOrigin + inAxisX * corner.x + inAxisY * corner.y;
+	gl_Position = vec4(pos * canvas.scale - 1.0, 0.0, 1.0);
+
+	outColor = unpack_color(inColor);
+	outTexCoord = mix(inUVMin, inUVMax, corner);
+	outLocal = corner * 2.0 - 1.0;
+	outShape = inShape;
+}
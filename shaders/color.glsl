@@ -0,0 +1,10 @@
+// 2D colors are given in sRGB, blending happens in linear space
+
+vec3 decode_srgb(vec3 encoded) {
+	return mix(encoded / 12.92, pow((encoded + 0.055) / 1.055, vec3(2.4)), step(vec3(0.04045), encoded));
+}
+
+vec4 unpack_color(uint packed) {
+	vec4 color = unpackUnorm4x8(packed);
+	return vec4(decode_srgb(color.rgb), color.a);
+}
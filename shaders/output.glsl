@@ -0,0 +1,37 @@
+// shared by every fragment shader that writes to the swapchain
+
+layout (constant_id = OUTPUT_ENCODING_ID) const int OUTPUT_ENCODING = 0; // see OutputEncoding in surface.h
+
+const int ENCODING_SRGB = 1;
+const int ENCODING_PQ = 2;
+const float SDR_WHITE_NITS = 203.0; // BT.2408 reference white
+
+vec3 encode_srgb(vec3 linear) {
+	return mix(linear * 12.92, 1.055 * pow(linear, vec3(1.0 / 2.4)) - 0.055, step(vec3(0.0031308), linear));
+}
+
+vec3 encode_pq(vec3 linear) {
+	const mat3 BT709_TO_BT2020 = mat3(
+		0.6274, 0.0691, 0.0164,
+		0.3293, 0.9195, 0.0880,
+		0.0433, 0.0114, 0.8956
+	);
+	const float m1 = 0.1593017578125;
+	const float m2 = 78.84375;
+	const float c1 = 0.8359375;
+	const float c2 = 18.8515625;
+	const float c3 = 18.6875;
+
+	vec3 y = pow(max(BT709_TO_BT2020 * linear, 0.0) * (SDR_WHITE_NITS / 10000.0), vec3(m1));
+	return pow((c1 + c2 * y) / (1.0 + c3 * y), vec3(m2));
+}
+
+// linear BT.709 to whatever the swapchain format expects, a no-op when the format encodes on store
+vec3 encode_output(vec3 linear) {
+	if (OUTPUT_ENCODING == ENCODING_SRGB) {
+		return encode_srgb(linear);
+	} else if (OUTPUT_ENCODING == ENCODING_PQ) {
+		return encode_pq(linear);
+	}
+	return linear;
+}
@@ -0,0 +1,178 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "output.glsl"
+
+// see PathMode and PathPieceKind in canvas.h
+const uint MODE_NON_ZERO = 0;
+const uint MODE_EVEN_ODD = 1;
+const uint MODE_STROKE = 2;
+
+const uint PIECE_CURVE = 0;
+const uint PIECE_TRIANGLE = 1;
+const uint PIECE_POINT = 2;
+
+const float FAR = 1e30;
+
+// the current frame's region of the transient buffer, pieces and band lists are indexed in words
+layout (binding = 0) readonly buffer PathData {
+	uint words[];
+} path_data;
+
+layout (location = 0) in vec4 inColor;
+layout (location = 1) flat in uint inFirst;
+layout (location = 2) flat in uint inCount;
+layout (location = 3) flat in uint inMode;
+layout (location = 4) flat in float inHalfWidth;
+
+layout (location = 0) out vec4 outColor;
+
+vec2 load_point(uint word) {
+	return uintBitsToFloat(uvec2(path_data.words[word], path_data.words[word + 1]));
+}
+
+float dot2(vec2 v) {
+	return dot(v, v);
+}
+
+// distance to a quadratic Bézier and the parameter of the closest point, solved in closed form
+vec2 curve_distance(vec2 pos, vec2 p0, vec2 p1, vec2 p2) {
+	vec2 a = p1 - p0;
+	vec2 b = p0 - 2.0 * p1 + p2;
+	vec2 d = p0 - pos;
+
+	// straight lines have no curvature to solve for
+	if (dot2(b) < 1e-6) {
+		vec2 line = p2 - p0;
+		float t = clamp(dot(pos - p0, line) / max(dot2(line), 1e-12), 0.0, 1.0);
+		return vec2(length(d + line * t), t);
+	}
+
+	vec2 c = a * 2.0;
+	float kk = 1.0 / dot2(b);
+	float kx = kk * dot(a, b);
+	float ky = kk * (2.0 * dot2(a) + dot(d, b)) / 3.0;
+	float kz = kk * dot(d, a);
+	float p = ky - kx * kx;
+	float q = kx * (2.0 * kx * kx - 3.0 * ky) + kz;
+	float h = q * q + 4.0 * p * p * p;
+
+	if (h >= 0.0) {
+		h = sqrt(h);
+		vec2 x = (vec2(h, -h) - q) / 2.0;
+		vec2 uv = sign(x) * pow(abs(x), vec2(1.0 / 3.0));
+		float t = clamp(uv.x + uv.y - kx, 0.0, 1.0);
+		return vec2(length(d + (c + b * t) * t), t);
+	}
+
+	// three real roots, the middle one is never the closest
+	float z = sqrt(-p);
+	float v = acos(q / (p * z * 2.0)) / 3.0;
+	float m = cos(v);
+	float n = sin(v) * 1.732050808;
+	vec2 t = clamp(vec2(m + m, -n - m) * z - kx, 0.0, 1.0);
+	float d0 = dot2(d + (c + b * t.x) * t.x);
+	float d1 = dot2(d + (c + b * t.y) * t.y);
+	return d0 < d1 ? vec2(sqrt(d0), t.x) : vec2(sqrt(d1), t.y);
+}
+
+// signed crossing of the ray from pos towards +x, filled curves are monotonic in y
+int curve_winding(vec2 pos, vec2 p0, vec2 p1, vec2 p2) {
+	// half open so that a scanline through a shared end point is only counted once
+	if (pos.y < min(p0.y, p2.y) || pos.y >= max(p0.y, p2.y)) {
+		return 0;
+	}
+
+	float a = p0.y - 2.0 * p1.y + p2.y;
+	float b = 2.0 * (p1.y - p0.y);
+	float c = p0.y - pos.y;
+	float t;
+	if (abs(a) < 1e-5) {
+		t = -c / b;
+	} else {
+		float root = sqrt(max(b * b - 4.0 * a * c, 0.0));
+		float t0 = (-b + root) / (2.0 * a);
+		float t1 = (-b - root) / (2.0 * a);
+		t = abs(t0 - 0.5) <= abs(t1 - 0.5) ? t0 : t1;
+	}
+	t = clamp(t, 0.0, 1.0);
+
+	float x = mix(mix(p0.x, p1.x, t), mix(p1.x, p2.x, t), t);
+	if (x <= pos.x) {
+		return 0;
+	}
+	return p2.y > p0.y ? 1 : -1;
+}
+
+float triangle_distance(vec2 pos, vec2 p0, vec2 p1, vec2 p2) {
+	vec2 e0 = p1 - p0;
+	vec2 e1 = p2 - p1;
+	vec2 e2 = p0 - p2;
+	vec2 v0 = pos - p0;
+	vec2 v1 = pos - p1;
+	vec2 v2 = pos - p2;
+	vec2 pq0 = v0 - e0 * clamp(dot(v0, e0) / dot2(e0), 0.0, 1.0);
+	vec2 pq1 = v1 - e1 * clamp(dot(v1, e1) / dot2(e1), 0.0, 1.0);
+	vec2 pq2 = v2 - e2 * clamp(dot(v2, e2) / dot2(e2), 0.0, 1.0);
+	float s = sign(e0.x * e2.y - e0.y * e2.x);
+	vec2 d = min(min(
+		vec2(dot2(pq0), s * (v0.x * e0.y - v0.y * e0.x)),
+		vec2(dot2(pq1), s * (v1.x * e1.y - v1.y * e1.x))),
+		vec2(dot2(pq2), s * (v2.x * e2.y - v2.y * e2.x))
+	);
+	return -sqrt(d.x) * sign(d.y);
+}
+
+// distance to the centre line, each piece is a part of the stroke's outline
+float stroke_distance(vec2 pos, uint kind, vec2 p0, vec2 p1, vec2 p2) {
+	if (kind == PIECE_POINT) {
+		return length(pos - p0);
+	}
+	if (kind == PIECE_TRIANGLE) {
+		// triangles already span the width
+		return triangle_distance(pos, p0, p1, p2) + inHalfWidth;
+	}
+
+	// butt ends, whatever lies beyond an end belongs to the join or cap there
+	vec2 dt = curve_distance(pos, p0, p1, p2);
+	vec2 start = dot2(p1 - p0) > 1e-12 ? p1 - p0 : p2 - p0;
+	vec2 end = dot2(p2 - p1) > 1e-12 ? p2 - p1 : p2 - p0;
+	if ((dt.y <= 0.0 && dot(pos - p0, start) < 0.0) || (dt.y >= 1.0 && dot(pos - p2, end) > 0.0)) {
+		return FAR;
+	}
+	return dt.x;
+}
+
+void main() {
+	vec2 pos = gl_FragCoord.xy;
+	float coverage;
+
+	if (inMode == MODE_STROKE) {
+		float d = FAR;
+		for (uint i = 0; i < inCount; i++) {
+			uint piece = path_data.words[inFirst + i];
+			uint kind = path_data.words[piece + 6];
+			d = min(d, stroke_distance(pos, kind, load_point(piece), load_point(piece + 2), load_point(piece + 4)));
+		}
+		coverage = clamp(inHalfWidth - d + 0.5, 0.0, 1.0);
+	} else {
+		// the winding number decides inside or outside, the distance to the nearest curve anti-aliases the edge
+		int winding = 0;
+		float d = FAR;
+		for (uint i = 0; i < inCount; i++) {
+			uint piece = path_data.words[inFirst + i];
+			vec2 p0 = load_point(piece);
+			vec2 p1 = load_point(piece + 2);
+			vec2 p2 = load_point(piece + 4);
+			winding += curve_winding(pos, p0, p1, p2);
+			d = min(d, curve_distance(pos, p0, p1, p2).x);
+		}
+		bool inside = inMode == MODE_EVEN_ODD ? (winding & 1) != 0 : winding != 0;
+		coverage = clamp(inside ? 0.5 + d : 0.5 - d, 0.0, 1.0);
+	}
+
+	if (coverage <= 0.0) {
+		discard;
+	}
+	outColor = vec4(encode_output(inColor.rgb), inColor.a * coverage);
+}
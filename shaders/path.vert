@@ -0,0 +1,36 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "color.glsl"
+
+layout (push_constant) uniform Canvas {
+	vec2 scale; // 2 / framebuffer size in pixels
+} canvas;
+
+// one instance per band, see PathBand in canvas.h
+layout (location = 0) in vec2 inMin;
+layout (location = 1) in vec2 inMax;
+layout (location = 2) in uint inFirst;
+layout (location = 3) in uint inCount;
+layout (location = 4) in uint inColor;
+layout (location = 5) in uint inMode;
+layout (location = 6) in float inHalfWidth;
+
+layout (location = 0) out vec4 outColor;
+layout (location = 1) flat out uint outFirst;
+layout (location = 2) flat out uint outCount;
+layout (location = 3) flat out uint outMode;
+layout (location = 4) flat out float outHalfWidth;
+
+void main() {
+	// a 4 vertex triangle strip over the band's bounds
+	vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1);
+	vec2 pos = mix(inMin, inMax, corner);
+	gl_Position = vec4(pos * canvas.scale - 1.0, 0.0, 1.0);
+
+	outColor = unpack_color(inColor);
+	outFirst = inFirst;
+	outCount = inCount;
+	outMode = inMode;
+	outHalfWidth = inHalfWidth;
+}
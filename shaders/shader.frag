@@ -1,4 +1,11 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+layout (constant_id = FEATURE_TEXTURED) const bool TEXTURED = true;
+layout (constant_id = FEATURE_VERTEX_COLOR) const bool VERTEX_COLOR = false;
+layout (constant_id = FEATURE_ALPHA_TEST) const bool ALPHA_TEST = false;
+
+#include "output.glsl"
 
 layout (binding = 1) uniform sampler2D tex;
 
@@ -8,5 +15,15 @@ layout (location = 1) in vec2 inTexCoord;
 layout (location = 0) out vec4 outColor;
 
 void main() {
-	outColor = texture(tex, inTexCoord);
+	vec4 color = vec4(1.0);
+	if (TEXTURED) {
+		color *= texture(tex, inTexCoord);
+	}
+	if (VERTEX_COLOR) {
+		color.rgb *= inColor;
+	}
+	if (ALPHA_TEST && color.a < 0.5) {
+		discard;
+	}
+	outColor = vec4(encode_output(color.rgb), color.a);
 }
\ No newline at end of file
@@ -1,11 +1,14 @@
 #version 450
 
 layout (binding = 0) uniform UBO {
-	mat4 model;
 	mat4 view;
 	mat4 proj;
 } ubo;
 
+layout (push_constant) uniform Object {
+	mat4 model;
+} object;
+
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec3 inColor;
 layout (location = 2) in vec2 inTexCoord;
@@ -14,7 +17,7 @@ layout (location = 0) out vec3 outColor;
 layout (location = 1) out vec2 outTexCoord;
 
 void main() {
-	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+	gl_Position = ubo.proj * ubo.view * object.model * vec4(inPosition, 1.0);
 	outColor = inColor;
 	outTexCoord = inTexCoord;
 }
\ No newline at end of file
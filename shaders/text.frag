@@ -0,0 +1,22 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "output.glsl"
+
+layout (binding = 0) uniform sampler2D glyphs; // a FontAtlas page, 0.5 on outlines and increasing inwards
+
+layout (location = 0) in vec4 inColor;
+layout (location = 1) in vec2 inTexCoord;
+layout (location = 2) in vec2 inLocal;
+layout (location = 3) flat in float inShape; // on screen width in pixels of the field's 0 to 1 range
+
+layout (location = 0) out vec4 outColor;
+
+void main() {
+	float coverage = clamp((texture(glyphs, inTexCoord).r - 0.5) * inShape + 0.5, 0.0, 1.0);
+	if (coverage <= 0.0) {
+		discard;
+	}
+
+	outColor = vec4(encode_output(inColor.rgb), inColor.a * coverage);
+}
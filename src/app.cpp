@@ -1,13 +1,20 @@
 #include <algorithm>
 #include <array>
+#include <charconv>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
-#include <fstream>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <ranges>
 #include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include <vulkan/vulkan.h>
@@ -22,13 +29,42 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "app.h"
+#include "arena.h"
+#include "benchmark.h"
+#include "canvas.h"
+#include "capture.h"
+#include "cull.h"
+#include "debug.h"
+#include "deletion.h"
+#include "device.h"
+#include "draws.h"
+#include "golden.h"
+#include "overlay.h"
+#include "profiler.h"
+#include "record.h"
+#include "reflect.h"
+#include "scene.h"
+#include "shader_features.h"
+#include "shaders/canvas.frag.h"
+#include "shaders/canvas.vert.h"
+#include "shaders/path.frag.h"
+#include "shaders/path.vert.h"
+#include "shaders/shader.frag.h"
+#include "shaders/shader.vert.h"
+#include "shaders/text.frag.h"
+#include "surface.h"
+#include "tasks.h"
+#include "text.h"
+#include "trace.h"
+#include "validation.h"
 
 static constexpr auto WIDTH = 1280;
 static constexpr auto HEIGHT = 720;
 static constexpr auto MAX_FRAMES_IN_FLIGHT = 2;
-
-static constexpr std::string_view VERT_SHADER_PATH = "shaders/shader.vert.spv";
-static constexpr std::string_view FRAG_SHADER_PATH = "shaders/shader.frag.spv";
+static constexpr VkDeviceSize TRANSIENT_BUFFER_SIZE = 64 * 1024 * 1024; // fits a million 2D primitives
+static constexpr uint32_t CANVAS_MAX_TEXTURES = 256;
+static constexpr uint32_t GOLDEN_FRAMES = 8; // a golden run reads back the last of these
+static constexpr float GOLDEN_DELTA = 1.0f / 60.0f; // seconds, so every golden run animates identically
 
 static constexpr std::array VALIDATION_LAYERS = {
 	"VK_LAYER_KHRONOS_validation"
@@ -36,6 +72,11 @@ static constexpr std::array VALIDATION_LAYERS = {
 static constexpr std::array DEVICE_EXTENSIONS = {
 	"VK_KHR_swapchain"
 };
+// enabled when the device has them
+static constexpr std::array OPTIONAL_DEVICE_EXTENSIONS = {
+	VK_EXT_MEMORY_BUDGET_EXTENSION_NAME,
+	VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME
+};
 
 namespace VkDraw {
 	struct QueueFamilyIndex {
@@ -49,43 +90,77 @@ namespace VkDraw {
 		std::vector<VkPresentModeKHR> present_modes;
 	};
 
-	struct Vertex {
-		glm::vec3 pos;
-		glm::vec3 color;
-		glm::vec2 tex_coord;
+	struct DeviceRating {
+		VkPhysicalDevice device;
+		DeviceCapabilities caps;
+		// compared in order, so a better device type always wins and memory size breaks ties before the rest
+		uint32_t type_rank;
+		uint32_t vram; // largest device local heap in 256MiB steps, so small reservations don't decide
+		uint64_t score; // optional features, queues and limits
+		const char *rejected; // reason the device can't be used, or nullptr
+	};
 
-		static VkVertexInputBindingDescription get_binding() {
-			VkVertexInputBindingDescription desc{};
-			desc.binding = 0;
-			desc.stride = sizeof(Vertex);
-			desc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-			return desc;
-		}
+	struct Options {
+		std::optional<std::string_view> device; // --device <index|name>
+		SurfacePreferences surface; // --output <sdr|10bit|hdr|hdr10|scrgb> --present <auto|fifo|...>
+		std::optional<std::string> font; // --font <path>
+		bool overlay = false; // --overlay, toggled with F3
+		std::optional<std::string> benchmark; // --benchmark <file.json>
+		uint32_t frames = 1000; // --frames <count>, length of a benchmark run
+		uint32_t objects = 1; // --objects <count>, copies of the mesh in a grid, culled against the view
+		std::optional<std::string> trace; // --trace <file.json>
+		std::optional<ValidationMode> validation; // --validation <off|standard|gpu|sync|best-practices>
+		bool fail_on_validation = false; // --fail-on-validation, exit with an error if validation reported any
+		std::optional<std::string> golden; // --golden <file.png>, compare a fixed frame with the image and exit
+		bool golden_update = false; // --golden-update, write the frame to the golden image instead
+		bool headless = false; // --headless, keep the window hidden, a display is still needed for the surface
+		std::optional<std::string> capture; // --capture <file.y4m|file.raw|file.png>, record from the start
+	};
 
-		static std::array<VkVertexInputAttributeDescription, 3> get_attribute() {
-			std::array<VkVertexInputAttributeDescription, 3> desc{};
+	// a slice of the current frame's GPU buffer, valid until the frame's fence signals
+	struct GpuAllocation {
+		VkBuffer buffer;
+		VkDeviceSize offset; // from the start of buffer
+		void *data; // persistently mapped and host coherent
+	};
 
-			desc[0].binding = 0;
-			desc[0].location = 0;
-			desc[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-			desc[0].offset = offsetof(Vertex, pos);
+	// the reflected interface and modules of a vertex and fragment shader pair
+	struct ShaderProgram {
+		PipelineReflection reflection;
+		std::vector<VkDescriptorSetLayout> set_layouts; // indexed by set number, owned by the layout cache
+		VkPipelineLayout layout;
+		VkShaderModule vert;
+		VkShaderModule frag;
+	};
 
-			desc[1].binding = 0;
-			desc[1].location = 1;
-			desc[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-			desc[1].offset = offsetof(Vertex, color);
+	// fixed function state that differs between pipelines
+	struct PipelineState {
+		VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		VkVertexInputRate input_rate = VK_VERTEX_INPUT_RATE_VERTEX;
+		VkCullModeFlags cull_mode = VK_CULL_MODE_BACK_BIT;
+		bool depth = true;
+		std::optional<BlendMode> blend;
+	};
 
-			desc[2].binding = 0;
-			desc[2].location = 2;
-			desc[2].format = VK_FORMAT_R32G32_SFLOAT;
-			desc[2].offset = offsetof(Vertex, tex_coord);
+	struct CanvasTexture {
+		VkImage image;
+		VkDeviceMemory memory;
+		VkImageView view;
+		VkDescriptorSet set;
+	};
 
-			return desc;
-		}
+	struct Vertex {
+		glm::vec3 pos;
+		glm::vec3 color;
+		glm::vec2 tex_coord;
+	};
+
+	struct Material {
+		uint32_t features; // combination of ShaderFeature bits
 	};
 
+	// the model matrix is a push constant, so each draw sets its own without touching the buffer
 	struct UniformBufferObject {
-		glm::mat4 model;
 		glm::mat4 view;
 		glm::mat4 proj;
 	};
@@ -110,6 +185,14 @@ namespace VkDraw {
 		6, 7, 4
 	};
 
+	// copies of the mesh cycle through these, a single copy uses the first
+	constexpr std::array materials = {
+		Material{SHADER_FEATURE_TEXTURED},
+		Material{SHADER_FEATURE_TEXTURED | SHADER_FEATURE_VERTEX_COLOR},
+		Material{SHADER_FEATURE_VERTEX_COLOR}
+	};
+
+	static Options _options;
 	static SDL_Window *_window;
 	static VkApplicationInfo _app_info{};
 	static VkInstance _instance{};
@@ -117,21 +200,28 @@ namespace VkDraw {
 	static std::vector<VkExtensionProperties> _supported_extensions;
 	static std::vector<const char *> _required_extensions;
 	static VkPhysicalDevice _physical_device = nullptr;
+	static DeviceCapabilities _device_caps;
+	static std::vector<const char *> _device_extensions; // required and optional extensions that were enabled
 	static VkDevice _logical_device = nullptr;
 	static QueueFamilyIndex _queue_family;
 	static VkQueue _gfx_queue;
 	static VkQueue _present_queue;
 	static SwapchainSupport _swapchain_support;
-	static VkSurfaceFormatKHR _swapchain_format;
+	static VkSurfaceFormatKHR _swapchain_format{};
+	static OutputEncoding _swapchain_encoding = OutputEncoding::NONE;
 	static VkPresentModeKHR _swapchain_mode = VK_PRESENT_MODE_FIFO_KHR;
 	static VkExtent2D _swapchain_extent;
 	static VkSwapchainKHR _swapchain;
 	static std::vector<VkImage> _swapchain_images;
 	static std::vector<VkImageView> _swapchain_image_views;
-	static VkDescriptorSetLayout _descriptor_set_layout;
-	static VkPipelineLayout _pipeline_layout;
+	static ShaderProgram _mesh_program;
+	static ShaderProgram _canvas_program;
+	static ShaderProgram _path_program;
+	static ShaderProgram _text_program;
 	static VkRenderPass _render_pass;
-	static VkPipeline _pipeline;
+	// by position in SHADER_PERMUTATIONS, which is the sort key's pipeline field, null until compiled
+	static std::array<VkPipeline, std::size(SHADER_PERMUTATIONS)> _pipelines{};
+	static std::array<std::array<VkPipeline, 2>, 3> _canvas_pipelines{}; // by CanvasPipeline and BlendMode
 	static std::vector<VkFramebuffer> _framebuffers;
 	static VkCommandPool _command_pool;
 	static std::vector<VkCommandBuffer> _command_buffer;
@@ -139,48 +229,78 @@ namespace VkDraw {
 	static std::vector<VkSemaphore> _render_finished;
 	static std::vector<VkFence> _in_flight;
 	static uint32_t _current_frame = 0;
+	static uint64_t _frame_number = 0; // total frames submitted
+	static std::array<FrameArena, MAX_FRAMES_IN_FLIGHT> _frame_arenas;
+	static uint64_t _arena_upstream_allocations = 0; // since the title was last updated
 	static bool _window_resized = false;
 	static VkBuffer _vertex_buffer;
 	static VkDeviceMemory _vertex_buffer_memory;
 	static VkBuffer _index_buffer;
 	static VkDeviceMemory _index_buffer_memory;
-	static std::vector<VkBuffer> _uniform_buffers;
-	static std::vector<VkDeviceMemory> _uniform_buffers_memory;
-	static std::vector<void *> _mapped_uniform_buffers;
+	static VkBuffer _transient_buffer; // persistently mapped, one TRANSIENT_BUFFER_SIZE region per frame in flight
+	static VkDeviceMemory _transient_buffer_memory;
+	static std::byte *_transient_buffer_mapped;
+	static VkDeviceSize _transient_buffer_head = 0; // offset into the current frame's region
 	static VkDescriptorPool _descriptor_pool;
 	static std::vector<VkDescriptorSet> _descriptor_sets;
 	static VkImage _texture_image;
 	static VkDeviceMemory _texture_image_memory;
 	static VkImageView _texture_image_view;
 	static VkSampler _texture_sampler;
+	static VkDescriptorPool _canvas_descriptor_pool;
+	static std::vector<CanvasTexture> _canvas_textures; // indexed by TextureId
+	static std::optional<FontId> _default_font;
+	static std::vector<VkDescriptorSet> _path_descriptor_sets; // each frame's region of the transient buffer
+	static std::unordered_map<std::string, TextureId> _canvas_texture_paths;
+	static VkFormat _depth_format;
 	static VkImage _depth_image;
 	static VkDeviceMemory _depth_image_memory;
 	static VkImageView _depth_image_view;
+	static VkExtent2D _depth_capacity{}; // allocated size of the depth image, may exceed the swapchain extent
+	static DeletionQueue _deletion_queue;
+	static std::unique_ptr<ThreadPool> _thread_pool;
+	static std::mutex _upload_mutex; // guards single use command submission during startup
+	static std::chrono::steady_clock::time_point _startup_epoch;
+	static GpuTimer _gpu_timer;
+	static PipelineStatsQuery _pipeline_stats;
+	static RenderCounters _render_counters; // of the frame being built, or the last one between frames
+	static std::unique_ptr<BenchmarkRecorder> _benchmark;
+	static std::array<int64_t, MAX_FRAMES_IN_FLIGHT> _submit_ns{}; // when each frame slot was last submitted
+	static uint64_t _traced_gpu_ticks = 0; // begin_ticks of the last GPU frame added to the trace
+	static PerfOverlay _overlay;
+	static Canvas _overlay_canvas; // recorded after the frame's canvas so it draws over it
+	static std::chrono::steady_clock::time_point _last_frame_start;
+	static double _frame_cpu_ms = 0.0; // of the last frame
+	static bool _frame_submitted = false; // since stats were last recorded, false after a failed acquire
+	static float _scene_time = 0.0f; // seconds of animation, the sum of every frame's delta
+	static FrameCapture _capture;
+	static SceneGraph _scene;
+	static std::vector<NodeId> _mesh_nodes; // a node per copy of the mesh
+	static glm::vec4 _mesh_bounds{}; // bounding sphere of the mesh's vertices, center and radius
+	static BoundingSpheres _mesh_spheres; // world space, by index in _mesh_nodes
+	static std::vector<uint32_t> _mesh_materials; // index in materials, by index in _mesh_nodes
+	static std::vector<uint32_t> _visible_meshes; // indices in _mesh_nodes of the copies drawn this frame
+	static std::vector<uint32_t> _cull_scratch;
+	// the visible copies sorted by key, objects are positions in the scene's world matrices
+	static std::vector<DrawItem> _mesh_draws;
+	static DrawSortScratch _mesh_draw_scratch;
+	static SDL_Surface *_golden_frame = nullptr; // written by the capture thread, read once it has been joined
+
+	static bool _debug_utils = false; // VK_EXT_debug_utils is enabled on the instance
+	static ValidationSink _validation;
 
 #ifdef NDEBUG
-	static bool _use_validation = false;
+	static ValidationMode _validation_mode = ValidationMode::OFF;
 #else
-	static bool _use_validation = true;
+	static ValidationMode _validation_mode = ValidationMode::STANDARD;
 #endif
+	static bool _use_validation = _validation_mode != ValidationMode::OFF;
 
-	static VkShaderModule create_module(const std::string_view path) {
-		std::ifstream file(path.data(), std::ios::ate | std::ios::binary);
-		if (!file.is_open()) {
-			throw std::runtime_error("Failed to open shader file!");
-		}
-
-		const auto size = file.tellg();
-		std::vector<char> code(size);
-		std::printf("loaded %zu bytes from \"%s\"\n", code.size(), path.data());
-
-		file.seekg(0);
-		file.read(code.data(), size);
-		file.close();
-
+	static VkShaderModule create_module(std::span<const uint32_t> code) {
 		VkShaderModuleCreateInfo info{};
 		info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		info.codeSize = code.size();
-		info.pCode = reinterpret_cast<const uint32_t *>(code.data());
+		info.codeSize = code.size_bytes();
+		info.pCode = code.data();
 
 		VkShaderModule module;
 		if (vkCreateShaderModule(_logical_device, &info, nullptr, &module) != VK_SUCCESS) {
@@ -190,7 +310,369 @@ namespace VkDraw {
 		return module;
 	}
 
-	static void record_command(VkCommandBuffer cmd_buffer, uint32_t image_idx) {
+	static VkPipeline create_pipeline(const ShaderProgram &program, const PipelineState &state, uint32_t features) {
+		VkGraphicsPipelineCreateInfo pipeline_info{};
+		pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+
+		// specialize every feature constant, the driver folds the disabled branches away
+		// the last constant is the output encoding of the current swapchain format
+		std::array<uint32_t, SHADER_FEATURE_COUNT + 1> feature_values{};
+		std::array<VkSpecializationMapEntry, SHADER_FEATURE_COUNT + 1> feature_entries{};
+		for (uint32_t i = 0; i < SHADER_FEATURE_COUNT; i++) {
+			feature_values[i] = features & (1u << i) ? VK_TRUE : VK_FALSE;
+			feature_entries[i].constantID = i;
+			feature_entries[i].offset = i * sizeof(VkBool32);
+			feature_entries[i].size = sizeof(VkBool32);
+		}
+		feature_values[SHADER_FEATURE_COUNT] = static_cast<uint32_t>(_swapchain_encoding);
+		feature_entries[SHADER_FEATURE_COUNT].constantID = SHADER_OUTPUT_ENCODING_ID;
+		feature_entries[SHADER_FEATURE_COUNT].offset = SHADER_FEATURE_COUNT * sizeof(uint32_t);
+		feature_entries[SHADER_FEATURE_COUNT].size = sizeof(uint32_t);
+
+		VkSpecializationInfo specialization{};
+		specialization.mapEntryCount = feature_entries.size();
+		specialization.pMapEntries = feature_entries.data();
+		specialization.dataSize = sizeof(feature_values);
+		specialization.pData = feature_values.data();
+
+		VkPipelineShaderStageCreateInfo vert_stage{};
+		vert_stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		vert_stage.stage = VK_SHADER_STAGE_VERTEX_BIT;
+		vert_stage.module = program.vert;
+		vert_stage.pName = "main";
+		vert_stage.pSpecializationInfo = &specialization;
+
+		VkPipelineShaderStageCreateInfo frag_stage{};
+		frag_stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		frag_stage.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		frag_stage.module = program.frag;
+		frag_stage.pName = "main";
+		frag_stage.pSpecializationInfo = &specialization;
+
+		VkPipelineShaderStageCreateInfo stages[] = {vert_stage, frag_stage};
+
+		pipeline_info.stageCount = 2;
+		pipeline_info.pStages = stages;
+
+		// vertex input stage
+		auto binding = program.reflection.binding;
+		binding.inputRate = state.input_rate;
+		const auto &attribs = program.reflection.attributes;
+		VkPipelineVertexInputStateCreateInfo vertex_input_stage{};
+		vertex_input_stage.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertex_input_stage.vertexBindingDescriptionCount = 1;
+		vertex_input_stage.pVertexBindingDescriptions = &binding;
+		vertex_input_stage.vertexAttributeDescriptionCount = attribs.size();
+		vertex_input_stage.pVertexAttributeDescriptions = attribs.data();
+		pipeline_info.pVertexInputState = &vertex_input_stage;
+
+		// input assembly
+		VkPipelineInputAssemblyStateCreateInfo input_assembly{};
+		input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		input_assembly.topology = state.topology;
+		input_assembly.primitiveRestartEnable = VK_FALSE;
+		pipeline_info.pInputAssemblyState = &input_assembly;
+
+		// viewport state
+		VkPipelineViewportStateCreateInfo viewport_state{};
+		viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewport_state.viewportCount = 1;
+		viewport_state.scissorCount = 1;
+		pipeline_info.pViewportState = &viewport_state;
+
+		// rasterization
+		VkPipelineRasterizationStateCreateInfo rasterization_stage{};
+		rasterization_stage.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterization_stage.depthClampEnable = VK_FALSE;
+		rasterization_stage.rasterizerDiscardEnable = VK_FALSE;
+		rasterization_stage.polygonMode = VK_POLYGON_MODE_FILL;
+		rasterization_stage.lineWidth = 1.0f;
+		rasterization_stage.cullMode = state.cull_mode;
+		rasterization_stage.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		rasterization_stage.depthBiasEnable = VK_FALSE;
+		pipeline_info.pRasterizationState = &rasterization_stage;
+
+		// multisampling
+		VkPipelineMultisampleStateCreateInfo multisampling_state{};
+		multisampling_state.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampling_state.sampleShadingEnable = VK_FALSE;
+		multisampling_state.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		pipeline_info.pMultisampleState = &multisampling_state;
+
+		// depth and stencil
+		VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+		depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depth_stencil.depthTestEnable = state.depth ? VK_TRUE : VK_FALSE;
+		depth_stencil.depthWriteEnable = state.depth ? VK_TRUE : VK_FALSE;
+		depth_stencil.depthCompareOp = VK_COMPARE_OP_LESS;
+		depth_stencil.depthBoundsTestEnable = VK_FALSE;
+		// depth_stencil.minDepthBounds = 0.0f;
+		// depth_stencil.maxDepthBounds = 1.0f;
+		depth_stencil.stencilTestEnable = VK_FALSE;
+		// depth_stencil.front = {};
+		// depth_stencil.back = {};
+
+		pipeline_info.pDepthStencilState = &depth_stencil;
+
+		// color blending
+		VkPipelineColorBlendAttachmentState blend_attachment{};
+		blend_attachment.colorWriteMask =
+			VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+			VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		blend_attachment.blendEnable = state.blend.has_value() ? VK_TRUE : VK_FALSE;
+		if (state.blend.has_value()) {
+			// straight alpha, additive keeps the destination and adds the weighted source on top
+			blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+			blend_attachment.dstColorBlendFactor = state.blend == BlendMode::ADDITIVE
+				? VK_BLEND_FACTOR_ONE
+				: VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+			blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
+			blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+			blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+		}
+
+		VkPipelineColorBlendStateCreateInfo blending_state{};
+		blending_state.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		blending_state.logicOpEnable = VK_FALSE;
+		blending_state.attachmentCount = 1;
+		blending_state.pAttachments = &blend_attachment;
+		pipeline_info.pColorBlendState = &blending_state;
+
+		// dynamic states
+		std::vector<VkDynamicState> dynamic_states = {
+			VK_DYNAMIC_STATE_VIEWPORT,
+			VK_DYNAMIC_STATE_SCISSOR
+		};
+
+		VkPipelineDynamicStateCreateInfo dynamic_state_info{};
+		dynamic_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamic_state_info.dynamicStateCount = dynamic_states.size();
+		dynamic_state_info.pDynamicStates = dynamic_states.data();
+
+		pipeline_info.pDynamicState = &dynamic_state_info;
+
+		pipeline_info.layout = program.layout;
+		pipeline_info.renderPass = _render_pass;
+		pipeline_info.subpass = 0;
+
+		pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
+		pipeline_info.basePipelineIndex = -1;
+
+		VkPipeline pipeline;
+		if (vkCreateGraphicsPipelines(
+			_logical_device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline
+		) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create graphics pipeline!");
+		}
+
+		return pipeline;
+	}
+
+	// pipelines are only looked up while recording, compile_pipelines builds all of them ahead of the frame
+	static void compile_pipeline(uint32_t features) {
+		const auto permutation = std::ranges::find(SHADER_PERMUTATIONS, features);
+		if (permutation == std::ranges::end(SHADER_PERMUTATIONS)) {
+			throw std::runtime_error("Requested shader permutation was not declared!");
+		}
+		auto &pipeline = _pipelines[permutation - std::ranges::begin(SHADER_PERMUTATIONS)];
+		if (pipeline != VK_NULL_HANDLE) {
+			return;
+		}
+
+		std::printf("Vulkan: compiling shader permutation {");
+		for (uint32_t i = 0; i < SHADER_FEATURE_COUNT; i++) {
+			if (features & (1u << i)) {
+				std::printf(" %s", SHADER_FEATURE_NAMES[i]);
+			}
+		}
+		std::printf(" }\n");
+
+		pipeline = create_pipeline(_mesh_program, {}, features);
+		set_debug_name(_logical_device, pipeline, "mesh pipeline %#x", features);
+	}
+
+	static const ShaderProgram &canvas_program(CanvasPipeline pipeline) {
+		switch (pipeline) {
+			case CanvasPipeline::PATHS:
+				return _path_program;
+			case CanvasPipeline::TEXT:
+				return _text_program;
+			default:
+				return _canvas_program;
+		}
+	}
+
+	static VkPipeline get_canvas_pipeline(CanvasPipeline type, BlendMode blend) {
+		const auto pipeline = _canvas_pipelines[static_cast<size_t>(type)][static_cast<size_t>(blend)];
+		if (pipeline == VK_NULL_HANDLE) {
+			throw std::runtime_error("Canvas pipeline was not compiled before recording!");
+		}
+		return pipeline;
+	}
+
+	static void compile_canvas_pipeline(CanvasPipeline type, BlendMode blend) {
+		auto &pipeline = _canvas_pipelines[static_cast<size_t>(type)][static_cast<size_t>(blend)];
+		if (pipeline != VK_NULL_HANDLE) {
+			return;
+		}
+
+		PipelineState state{};
+		state.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+		state.input_rate = VK_VERTEX_INPUT_RATE_INSTANCE;
+		state.cull_mode = VK_CULL_MODE_NONE;
+		state.depth = false;
+		state.blend = blend;
+		pipeline = create_pipeline(canvas_program(type), state, 0);
+		set_debug_name(
+			_logical_device, pipeline, "canvas pipeline %u blend %u", static_cast<uint32_t>(type),
+			static_cast<uint32_t>(blend)
+		);
+	}
+
+	// everything a frame can bind is compiled ahead of it, so recording never waits on the driver, every material's
+	// pipeline since any may come into view and every canvas pipeline since the frame callback may draw anything
+	static void compile_pipelines() {
+		for (const auto &material : materials) {
+			compile_pipeline(material.features);
+		}
+		for (const auto type : {CanvasPipeline::SHAPES, CanvasPipeline::PATHS, CanvasPipeline::TEXT}) {
+			for (const auto blend : {BlendMode::ALPHA, BlendMode::ADDITIVE}) {
+				compile_canvas_pipeline(type, blend);
+			}
+		}
+	}
+
+	// 2D draws go on top of the scene, one instanced draw per chunk and binds only when state changes
+	static void record_canvas(VkCommandBuffer cmd_buffer, std::span<const CanvasChunk> chunks, const char *label) {
+		if (chunks.empty()) {
+			return;
+		}
+		DEBUG_LABEL(cmd_buffer, label);
+
+		const std::array scale = {
+			2.0f / static_cast<float>(_swapchain_extent.width), 2.0f / static_cast<float>(_swapchain_extent.height)
+		};
+
+		VkPipeline bound_pipeline = VK_NULL_HANDLE;
+		const ShaderProgram *bound_program = nullptr;
+		VkDescriptorSet bound_set = VK_NULL_HANDLE;
+		for (const auto &chunk : chunks) {
+			if (chunk.count == 0) {
+				continue;
+			}
+
+			const auto pipeline = get_canvas_pipeline(chunk.pipeline(), chunk.blend());
+			if (pipeline != bound_pipeline) {
+				vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+				bound_pipeline = pipeline;
+				_render_counters.pipeline_binds++;
+			}
+
+			const auto &program = canvas_program(chunk.pipeline());
+			if (&program != bound_program) {
+				vkCmdPushConstants(
+					cmd_buffer, program.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(scale), scale.data()
+				);
+				bound_program = &program;
+				bound_set = VK_NULL_HANDLE;
+			}
+
+			// paths read the frame's path data, shapes and glyphs sample their texture
+			const auto set = chunk.pipeline() == CanvasPipeline::PATHS
+				? _path_descriptor_sets[_current_frame]
+				: _canvas_textures[chunk.texture()].set;
+			if (set != bound_set) {
+				vkCmdBindDescriptorSets(
+					cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, program.layout,
+					0, 1, &set,
+					0, nullptr
+				);
+				bound_set = set;
+				_render_counters.descriptor_binds++;
+			}
+
+			vkCmdBindVertexBuffers(cmd_buffer, 0, 1, &chunk.buffer, &chunk.offset);
+			vkCmdDraw(cmd_buffer, 4, chunk.count, 0, 0);
+			_render_counters.buffer_binds++;
+			_render_counters.draws++;
+			_render_counters.triangles += 2ull * chunk.count;
+		}
+	}
+
+	// glyphs added this frame, copied in before the render pass so no upload ever waits on the queue
+	static void record_atlas_uploads(VkCommandBuffer cmd_buffer, std::span<const AtlasUpload> uploads) {
+		if (uploads.empty()) {
+			return;
+		}
+		TRACE_SCOPE("record_atlas_uploads");
+		DEBUG_LABEL(cmd_buffer, "atlas uploads");
+
+		std::vector<VkImageMemoryBarrier> barriers(uploads.size());
+		for (size_t i = 0; i < uploads.size(); i++) {
+			auto &barrier = barriers[i];
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			// earlier frames may still be sampling the page, their glyphs are left as they were
+			barrier.oldLayout = uploads[i].initial
+				? VK_IMAGE_LAYOUT_UNDEFINED
+				: VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = _canvas_textures[uploads[i].texture].image;
+			barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+		}
+		vkCmdPipelineBarrier(
+			cmd_buffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0,
+			0, nullptr,
+			0, nullptr,
+			barriers.size(), barriers.data()
+		);
+		_render_counters.barriers++;
+
+		for (const auto &upload : uploads) {
+			VkBufferImageCopy region{};
+			region.bufferOffset = upload.offset;
+			region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+			region.imageOffset = {0, static_cast<int32_t>(upload.y), 0};
+			region.imageExtent = {FontAtlas::PAGE_SIZE, upload.height, 1};
+			vkCmdCopyBufferToImage(
+				cmd_buffer, upload.buffer, _canvas_textures[upload.texture].image,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region
+			);
+		}
+
+		for (auto &barrier : barriers) {
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		}
+		vkCmdPipelineBarrier(
+			cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0,
+			0, nullptr,
+			0, nullptr,
+			barriers.size(), barriers.data()
+		);
+		_render_counters.barriers++;
+	}
+
+	// swapchain images can only be copied from when the surface allows it
+	static bool capture_available() {
+		return _swapchain_support.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT &&
+			FrameCapture::supported(_swapchain_format.format);
+	}
+
+	static void record_command(
+		VkCommandBuffer cmd_buffer, uint32_t image_idx, VkDeviceSize ubo_offset, std::span<const CanvasChunk> canvas,
+		std::span<const CanvasChunk> overlay, std::span<const AtlasUpload> atlas_uploads
+	) {
+		TRACE_SCOPE("record_command");
+
 		VkCommandBufferBeginInfo buffer_info{};
 		buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
@@ -198,6 +680,10 @@ namespace VkDraw {
 			throw std::runtime_error("Failed to begin command buffer!");
 		}
 
+		_gpu_timer.begin(cmd_buffer, _current_frame);
+		record_atlas_uploads(cmd_buffer, atlas_uploads);
+		_gpu_timer.end_pass(cmd_buffer, _current_frame, GpuPass::UPLOADS);
+
 		VkRenderPassBeginInfo render_info{};
 		render_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 		render_info.renderPass = _render_pass;
@@ -212,18 +698,9 @@ namespace VkDraw {
 		render_info.clearValueCount = clear_colors.size();
 		render_info.pClearValues = clear_colors.data();
 
+		_pipeline_stats.begin(cmd_buffer, _current_frame);
 		vkCmdBeginRenderPass(cmd_buffer, &render_info, VK_SUBPASS_CONTENTS_INLINE);
-		vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
-
-		VkBuffer buffers[] = {_vertex_buffer};
-		VkDeviceSize offsets[] = {0};
-		vkCmdBindVertexBuffers(cmd_buffer, 0, 1, buffers, offsets);
-		vkCmdBindIndexBuffer(cmd_buffer, _index_buffer, 0, VK_INDEX_TYPE_UINT16); // TODO: use uint32_t if needed
-		vkCmdBindDescriptorSets(
-			cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline_layout,
-			0, 1, &_descriptor_sets[_current_frame],
-			0, nullptr
-		);
+		begin_debug_label(cmd_buffer, "scene");
 
 		VkViewport viewport{};
 		viewport.x = 0.0f;
@@ -239,15 +716,45 @@ namespace VkDraw {
 		scissor.extent = _swapchain_extent;
 		vkCmdSetScissor(cmd_buffer, 0, 1, &scissor);
 
-		vkCmdDrawIndexed(cmd_buffer, indices.size(), 1, 0, 0, 0);
+		// draws are sorted by the state they need, so each bind is only recorded when it differs from the last
+		// draw's, compile_pipelines already built every material's pipeline
+		DrawBindings bindings{};
+		bindings.pipelines = _pipelines;
+		bindings.layout = _mesh_program.layout;
+		bindings.vertex_buffer = _vertex_buffer;
+		bindings.index_buffer = _index_buffer;
+		bindings.index_type = VK_INDEX_TYPE_UINT16; // TODO: use uint32_t
+		bindings.index_count = indices.size();
+		bindings.set = _descriptor_sets[_current_frame];
+		bindings.dynamic_offset = static_cast<uint32_t>(ubo_offset);
+		bindings.models = _scene.world_matrices();
+		record_draws(cmd_buffer, _mesh_draws, bindings, _render_counters);
+		end_debug_label(cmd_buffer);
+		_gpu_timer.end_pass(cmd_buffer, _current_frame, GpuPass::SCENE);
+
+		record_canvas(cmd_buffer, canvas, "canvas");
+		_gpu_timer.end_pass(cmd_buffer, _current_frame, GpuPass::CANVAS);
+		record_canvas(cmd_buffer, overlay, "overlay");
+		_gpu_timer.end_pass(cmd_buffer, _current_frame, GpuPass::OVERLAY);
 		vkCmdEndRenderPass(cmd_buffer);
+		_pipeline_stats.end(cmd_buffer, _current_frame);
+
+		if (_capture.wanted() && capture_available()) {
+			DEBUG_LABEL(cmd_buffer, "capture");
+			if (_capture.record(
+				_logical_device, cmd_buffer, _current_frame, _swapchain_images[image_idx], _swapchain_extent,
+				_swapchain_format.format, _frame_number
+			)) {
+				_render_counters.barriers += 2;
+			}
+		}
 
 		if (vkEndCommandBuffer(cmd_buffer) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to record command buffer!");
 		}
 	}
 
-	static void create_swapchain() {
+	static void query_swapchain_support() {
 		// get swapchain support information
 		{
 			// get surface capabilities
@@ -280,26 +787,31 @@ namespace VkDraw {
 
 		// select swapchain format
 		{
-			for (auto format : _swapchain_support.formats) {
-				if (format.format == VK_FORMAT_B8G8R8A8_SRGB &&
-					format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
-					_swapchain_format = format;
-					break;
-				}
+			const auto choice = choose_surface_format(_swapchain_support.formats, _options.surface.output);
+			if (choice.format.format != _swapchain_format.format ||
+				choice.format.colorSpace != _swapchain_format.colorSpace) {
+				std::printf(
+					"Vulkan: using %s output (format %d, color space %d, %u bytes per pixel)\n",
+					color_output_name(choice.output), choice.format.format, choice.format.colorSpace,
+					choice.bytes_per_pixel
+				);
 			}
-			// TODO: "rank" format preferences
+			_swapchain_format = choice.format;
+			_swapchain_encoding = choice.encoding;
 		}
 
 		// select swapchain presentation mode
 		{
-			for (const auto mode : _swapchain_support.present_modes) {
-				if (mode == VK_PRESENT_MODE_MAILBOX_KHR) {
-					_swapchain_mode = mode;
-				}
-			}
-			// TODO: consider FIFO for low power device
+			const auto type = _device_caps.properties.deviceType;
+			const bool low_power =
+				type == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU || type == VK_PHYSICAL_DEVICE_TYPE_CPU;
+			_swapchain_mode = choose_present_mode(
+				_swapchain_support.present_modes, _options.surface.present, low_power
+			);
 		}
+	}
 
+	static void create_swapchain(VkSwapchainKHR old_swapchain = VK_NULL_HANDLE) {
 		// select swapchain extent
 		{
 			if (_swapchain_support.capabilities.currentExtent.width == std::numeric_limits<uint32_t>::max()) {
@@ -338,11 +850,14 @@ namespace VkDraw {
 		info.imageArrayLayers = 1; // unless using VR
 		info.imageExtent = _swapchain_extent;
 		info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; // render direct to image for now
+		if (_swapchain_support.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) {
+			info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT; // for FrameCapture
+		}
 		info.preTransform = _swapchain_support.capabilities.currentTransform;
 		info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 		info.presentMode = _swapchain_mode;
 		info.clipped = VK_TRUE;
-		info.oldSwapchain = nullptr;
+		info.oldSwapchain = old_swapchain;
 
 		uint32_t queue_indices[] = {_queue_family.gfx_family.value(), _queue_family.present_family.value()};
 
@@ -357,6 +872,7 @@ namespace VkDraw {
 		if (vkCreateSwapchainKHR(_logical_device, &info, nullptr, &_swapchain) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create swapchain!");
 		}
+		set_debug_name(_logical_device, _swapchain, "swapchain");
 	}
 
 	static VkImageView create_image_view(VkImage image, VkFormat format, VkImageAspectFlags aspect) {
@@ -389,6 +905,8 @@ namespace VkDraw {
 			_swapchain_image_views[i] = create_image_view(
 				_swapchain_images[i], _swapchain_format.format, VK_IMAGE_ASPECT_COLOR_BIT
 			);
+			set_debug_name(_logical_device, _swapchain_images[i], "swapchain image %u", i);
+			set_debug_name(_logical_device, _swapchain_image_views[i], "swapchain image view %u", i);
 		}
 	}
 
@@ -413,10 +931,27 @@ namespace VkDraw {
 			if (vkCreateFramebuffer(_logical_device, &info, nullptr, &_framebuffers[i]) != VK_SUCCESS) {
 				throw std::runtime_error("Failed to create framebuffer!");
 			}
+			set_debug_name(_logical_device, _framebuffers[i], "framebuffer %zu", i);
+		}
+	}
+
+	// queues an object for destruction once every frame recorded so far has finished on the GPU
+	template <typename T>
+	static void defer_destroy(T handle) {
+		_deletion_queue.push(_frame_number, handle);
+	}
+
+	// must be called after waiting on the fence of the current frame, which guarantees every frame
+	// up to _frame_number - MAX_FRAMES_IN_FLIGHT has finished on the GPU
+	static void collect_deferred() {
+		if (_frame_number + 1 >= MAX_FRAMES_IN_FLIGHT) {
+			_deletion_queue.collect(_logical_device, _frame_number + 1 - MAX_FRAMES_IN_FLIGHT);
 		}
 	}
 
 	static void cleanup_swapchain() {
+		_deletion_queue.flush(_logical_device);
+
 		vkDestroyImageView(_logical_device, _depth_image_view, nullptr);
 		vkDestroyImage(_logical_device, _depth_image, nullptr);
 		vkFreeMemory(_logical_device, _depth_image_memory, nullptr);
@@ -431,31 +966,197 @@ namespace VkDraw {
 	}
 
 	static void create_depth_resources(); // FORWARD DECLARATION
+	static void create_render_pass(); // FORWARD DECLARATION
 
+	// the old swapchain is handed to the new one and everything replaced is destroyed once the frames
+	// still in flight have retired, so resizing doesn't need to drain the GPU
 	static void recreate_swapchain() {
 		if (SDL_GetWindowFlags(_window) & SDL_WINDOW_MINIMIZED) {
 			return;
 		}
-		vkDeviceWaitIdle(_logical_device);
-		cleanup_swapchain();
-		create_swapchain();
+
+		for (const auto buffer : _framebuffers) {
+			defer_destroy(buffer);
+		}
+		for (const auto view : _swapchain_image_views) {
+			defer_destroy(view);
+		}
+		_framebuffers.clear();
+		_swapchain_image_views.clear();
+
+		const auto old_format = _swapchain_format;
+		const auto old_encoding = _swapchain_encoding;
+		query_swapchain_support();
+
+		// moving between SDR and HDR displays can change the format, the render pass and every pipeline
+		// depend on it and are rebuilt before the next frame records
+		if (_swapchain_format.format != old_format.format || _swapchain_encoding != old_encoding) {
+			for (auto &pipeline : _pipelines) {
+				defer_destroy(pipeline);
+				pipeline = VK_NULL_HANDLE;
+			}
+			for (auto &pipelines : _canvas_pipelines) {
+				for (auto &pipeline : pipelines) {
+					defer_destroy(pipeline);
+					pipeline = VK_NULL_HANDLE;
+				}
+			}
+			defer_destroy(_render_pass);
+			create_render_pass();
+			compile_pipelines();
+		}
+
+		// the old swapchain is retired even if creation fails
+		const auto old_swapchain = _swapchain;
+		_swapchain = VK_NULL_HANDLE;
+		defer_destroy(old_swapchain);
+		create_swapchain(old_swapchain);
 		create_image_views();
-		create_depth_resources();
+
+		// the depth image is only reallocated when it's too small, framebuffers may be smaller than it
+		if (_swapchain_extent.width > _depth_capacity.width || _swapchain_extent.height > _depth_capacity.height) {
+			defer_destroy(_depth_image_view);
+			defer_destroy(_depth_image);
+			defer_destroy(_depth_image_memory);
+			create_depth_resources();
+		}
+
 		create_framebuffers();
 		_window_resized = false;
 	}
 
-	static void update_ubos(uint32_t current) {
-		static auto start_time = std::chrono::high_resolution_clock::now();
-		auto current_time = std::chrono::high_resolution_clock::now();
-		float time = std::chrono::duration<float>(current_time - start_time).count();
+	static bool device_extension_enabled(std::string_view name) {
+		return std::ranges::find(_device_extensions, name) != _device_extensions.end();
+	}
+
+	// transient allocations for the frame being recorded, released once its fence signals
+	static std::pmr::memory_resource *frame_memory() {
+		return &_frame_arenas[_current_frame];
+	}
+
+	// bump allocates from the current frame's region, usable for uniform, storage, vertex and index data
+	static GpuAllocation frame_allocate(VkDeviceSize size, VkDeviceSize alignment) {
+		const VkDeviceSize aligned = (_transient_buffer_head + alignment - 1) & ~(alignment - 1);
+		if (aligned + size > TRANSIENT_BUFFER_SIZE) {
+			throw std::runtime_error("Transient buffer is out of memory!");
+		}
+		_transient_buffer_head = aligned + size;
+
+		const VkDeviceSize offset = _current_frame * TRANSIENT_BUFFER_SIZE + aligned;
+		return {_transient_buffer, offset, _transient_buffer_mapped + offset};
+	}
+
+	static CanvasAllocation allocate_canvas(VkDeviceSize size) {
+		const auto alloc = frame_allocate(size, 16);
+		return {
+			alloc.buffer, alloc.offset, alloc.offset - _current_frame * TRANSIENT_BUFFER_SIZE,
+			static_cast<std::byte *>(alloc.data)
+		};
+	}
+
+	template <typename T>
+	static GpuAllocation frame_push_uniform(const T &data) {
+		const auto alloc = frame_allocate(sizeof(T), _device_caps.properties.limits.minUniformBufferOffsetAlignment);
+		memcpy(alloc.data, &data, sizeof(T));
+		return alloc;
+	}
+
+	// copies of the mesh in a square grid centred on the origin, so a single copy sits at the origin
+	static void create_mesh_nodes(uint32_t count) {
+		constexpr float SPACING = 1.25f;
+		const auto side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+		const float offset = static_cast<float>(side - 1) * SPACING * 0.5f;
+		for (uint32_t i = 0; i < count; i++) {
+			Transform local;
+			local.translation = {
+				static_cast<float>(i % side) * SPACING - offset, static_cast<float>(i / side) * SPACING - offset, 0.0f
+			};
+			_mesh_nodes.push_back(_scene.add(local));
+			_mesh_materials.push_back(i % materials.size());
+		}
+		_mesh_spheres.resize(count);
+
+		glm::vec3 min = vertices[0].pos;
+		glm::vec3 max = min;
+		for (const auto &vertex : vertices) {
+			min = glm::min(min, vertex.pos);
+			max = glm::max(max, vertex.pos);
+		}
+		const auto center = (min + max) * 0.5f;
+		float radius = 0.0f;
+		for (const auto &vertex : vertices) {
+			radius = std::max(radius, glm::length(vertex.pos - center));
+		}
+		_mesh_bounds = glm::vec4(center, radius);
+	}
+
+	// moves every copy's bounding sphere to where it is this frame, then keeps the ones in view as the draw list
+	static void cull_meshes(const glm::mat4 &view_proj) {
+		TRACE_SCOPE("cull_meshes");
+		constexpr uint32_t GRAIN = 16384; // spheres per range
+
+		const auto count = static_cast<uint32_t>(_mesh_nodes.size());
+		const glm::vec4 local_center(_mesh_bounds.x, _mesh_bounds.y, _mesh_bounds.z, 1.0f);
+		parallel_for(*_thread_pool, count, GRAIN, [&local_center](uint32_t, uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++) {
+				const auto &world = _scene.world(_mesh_nodes[i]);
+				const auto center = world * local_center;
+				// the longest axis, so the sphere still covers the mesh under non-uniform scale
+				float scale = 0.0f;
+				for (int axis = 0; axis < 3; axis++) {
+					const auto &column = world[axis];
+					scale = std::max(scale, column.x * column.x + column.y * column.y + column.z * column.z);
+				}
+				_mesh_spheres.set(i, {center.x, center.y, center.z}, _mesh_bounds.w * std::sqrt(scale));
+			}
+		});
+
+		cull_spheres(extract_frustum(view_proj), _mesh_spheres, *_thread_pool, _visible_meshes, _cull_scratch);
+		_render_counters.culled = count - _visible_meshes.size();
+	}
+
+	// a draw per visible copy, keyed so copies sharing a pipeline and material are drawn together front to back
+	static void build_mesh_draws(const glm::mat4 &view_proj) {
+		TRACE_SCOPE("build_mesh_draws");
+		constexpr uint32_t GRAIN = 16384; // draws per range
+
+		// the pipeline field is the position of the material's permutation, a stable order for its pipelines
+		std::array<uint32_t, materials.size()> permutations{};
+		for (size_t i = 0; i < materials.size(); i++) {
+			const auto permutation = std::ranges::find(SHADER_PERMUTATIONS, materials[i].features);
+			permutations[i] = static_cast<uint32_t>(permutation - std::begin(SHADER_PERMUTATIONS));
+		}
+		// clip space w, the distance along the view direction
+		const glm::vec4 depth(view_proj[0][3], view_proj[1][3], view_proj[2][3], view_proj[3][3]);
+
+		const auto count = static_cast<uint32_t>(_visible_meshes.size());
+		_mesh_draws.resize(count);
+		parallel_for(*_thread_pool, count, GRAIN, [&permutations, &depth](uint32_t, uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++) {
+				const uint32_t object = _visible_meshes[i];
+				const uint32_t material = _mesh_materials[object];
+				const float distance = depth.x * _mesh_spheres.x[object] + depth.y * _mesh_spheres.y[object] +
+					depth.z * _mesh_spheres.z[object] + depth.w;
+				_mesh_draws[i] = {
+					draw_sort_key(DRAW_PASS_OPAQUE, permutations[material], material, distance),
+					_scene.index_of(_mesh_nodes[object])
+				};
+			}
+		});
+
+		sort_draws(_mesh_draws, _mesh_draw_scratch, *_thread_pool);
+	}
+
+	static GpuAllocation update_ubos() {
+		const float time = _scene_time;
+
+		const auto spin = glm::angleAxis(time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		for (const auto node : _mesh_nodes) {
+			_scene.set_rotation(node, spin);
+		}
+		_scene.update();
 
 		UniformBufferObject ubo{};
-		ubo.model = glm::rotate(
-			glm::mat4(1.0f),
-			time * glm::radians(90.0f),
-			glm::vec3(0.0f, 0.0f, 1.0f)
-		);
 		ubo.view = glm::lookAt(
 			glm::vec3(2.0f, 2.0f, 2.0f),
 			glm::vec3(0.0f, 0.0f, 0.0f),
@@ -469,16 +1170,102 @@ namespace VkDraw {
 		);
 		ubo.proj[1][1] *= -1; // flip y coordinate, glm uses OpenGL convention
 
-		memcpy(_mapped_uniform_buffers[current], &ubo, sizeof(ubo));
+		const auto view_proj = ubo.proj * ubo.view;
+		cull_meshes(view_proj);
+		build_mesh_draws(view_proj);
+		return frame_push_uniform(ubo);
+	}
+
+	// device local heaps only, left at zero without VK_EXT_memory_budget
+	static void query_memory_budget(FrameStats &stats) {
+		if (!device_extension_enabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) ||
+			_device_caps.properties.apiVersion < VK_API_VERSION_1_1) {
+			return;
+		}
+
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+		budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+		VkPhysicalDeviceMemoryProperties2 memory{};
+		memory.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+		memory.pNext = &budget;
+		vkGetPhysicalDeviceMemoryProperties2(_physical_device, &memory);
+
+		for (uint32_t i = 0; i < memory.memoryProperties.memoryHeapCount; i++) {
+			if (memory.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+				stats.memory_used += budget.heapUsage[i];
+				stats.memory_budget += budget.heapBudget[i];
+			}
+		}
+	}
+
+	// without calibration the GPU frame is placed at its submission, which is never later than it started
+	static void trace_gpu_frame(const GpuFrameTimings &gpu) {
+		if (!tracing() || !gpu.valid || gpu.begin_ticks == _traced_gpu_ticks) {
+			return;
+		}
+		_traced_gpu_ticks = gpu.begin_ticks;
+
+		int64_t start = _submit_ns[_current_frame];
+		if (_gpu_timer.calibrated()) {
+			_gpu_timer.calibrate(_logical_device);
+			start = _gpu_timer.host_ns(gpu.begin_ticks);
+		}
+		for (size_t i = 0; i < GPU_PASS_COUNT; i++) {
+			const auto duration = static_cast<int64_t>(gpu.pass_ms[i] * 1e6);
+			trace_gpu_event(gpu_pass_name(static_cast<GpuPass>(i)), start, duration);
+			start += duration;
+		}
+	}
+
+	// GPU results arrive once the frame slot's fence has signalled, counters are from the last frame recorded
+	static void record_frame_stats(std::chrono::steady_clock::time_point frame_start) {
+		FrameStats stats;
+		stats.cpu_ms = _frame_cpu_ms;
+		stats.frame_ms = std::chrono::duration<double, std::milli>(frame_start - _last_frame_start).count();
+
+		stats.gpu = _gpu_timer.collect(_logical_device, _current_frame);
+		trace_gpu_frame(stats.gpu);
+		stats.pipeline = _pipeline_stats.collect(_logical_device, _current_frame);
+		stats.counters = _render_counters;
+		stats.canvas_primitives = canvas().stats().primitives;
+		stats.pixels = static_cast<uint64_t>(_swapchain_extent.width) * _swapchain_extent.height;
+		if (_overlay.visible() || _benchmark) {
+			query_memory_budget(stats);
+		}
+		_overlay.record(stats);
+		if (_benchmark) {
+			_benchmark->record(stats);
+		}
 	}
 
-	static void draw_frame() {
-		vkWaitForFences(_logical_device, 1, &_in_flight[_current_frame], VK_TRUE, UINT64_MAX);
+	static void draw_frame(const FrameCallback &on_frame, float delta) {
+		TRACE_SCOPE("draw_frame");
+		{
+			TRACE_SCOPE("vkWaitForFences");
+			vkWaitForFences(_logical_device, 1, &_in_flight[_current_frame], VK_TRUE, UINT64_MAX);
+		}
+		const auto frame_start = std::chrono::steady_clock::now();
+		// a frame whose acquire failed submitted nothing, recording again would repeat the last frame's results
+		if (_frame_submitted) {
+			record_frame_stats(frame_start);
+			_frame_submitted = false;
+		}
+		_last_frame_start = frame_start;
+		_capture.collect(_logical_device, _current_frame);
+		_render_counters = {};
+		collect_deferred();
+		_arena_upstream_allocations += _frame_arenas[_current_frame].reset().upstream_allocations;
+		_transient_buffer_head = 0;
 
 		uint32_t image_idx;
-		auto res = vkAcquireNextImageKHR(
-			_logical_device, _swapchain, UINT64_MAX, _image_available[_current_frame],VK_NULL_HANDLE, &image_idx
-		);
+		VkResult res;
+		{
+			TRACE_SCOPE("vkAcquireNextImageKHR");
+			res = vkAcquireNextImageKHR(
+				_logical_device, _swapchain, UINT64_MAX, _image_available[_current_frame], VK_NULL_HANDLE, &image_idx
+			);
+		}
 		if (res == VK_ERROR_OUT_OF_DATE_KHR) {
 			recreate_swapchain();
 			return;
@@ -487,10 +1274,38 @@ namespace VkDraw {
 		}
 
 		vkResetFences(_logical_device, 1, &_in_flight[_current_frame]);
-		update_ubos(_current_frame);
+		if (_options.golden.has_value() && _frame_number == GOLDEN_FRAMES - 1) {
+			_capture.capture_next([](const CapturedFrame &frame) {
+				_golden_frame = captured_surface(frame);
+			});
+		}
+		_scene_time += delta;
+		const auto ubo = update_ubos();
+
+		// the frame's transient memory is free again, so 2D draws are written straight into it
+		canvas().begin(allocate_canvas, frame_memory());
+		if (on_frame) {
+			TRACE_SCOPE("on_frame");
+			on_frame(delta);
+		}
+		const auto canvas_chunks = canvas().end();
+
+		// the overlay is its own canvas, so it neither sorts with nor counts towards the frame's 2D draws
+		std::span<const CanvasChunk> overlay_chunks;
+		if (_overlay.visible()) {
+			_overlay_canvas.begin(allocate_canvas, frame_memory());
+			{
+				CanvasScope scope(_overlay_canvas);
+				_overlay.draw(_default_font);
+			}
+			overlay_chunks = _overlay_canvas.end();
+		}
+		const auto atlas_uploads = font_atlas().flush(allocate_canvas);
 
 		vkResetCommandBuffer(_command_buffer[_current_frame], 0);
-		record_command(_command_buffer[_current_frame], image_idx);
+		record_command(
+			_command_buffer[_current_frame], image_idx, ubo.offset, canvas_chunks, overlay_chunks, atlas_uploads
+		);
 
 		VkSemaphore wait[] = {_image_available[_current_frame]};
 		VkSemaphore signal[] = {_render_finished[_current_frame]};
@@ -506,9 +1321,15 @@ namespace VkDraw {
 		submit.signalSemaphoreCount = 1;
 		submit.pSignalSemaphores = signal;
 
-		if (vkQueueSubmit(_gfx_queue, 1, &submit, _in_flight[_current_frame]) != VK_SUCCESS) {
-			throw std::runtime_error("Failed to submit queue!");
+		{
+			TRACE_SCOPE("vkQueueSubmit");
+			_submit_ns[_current_frame] = trace_now();
+			if (vkQueueSubmit(_gfx_queue, 1, &submit, _in_flight[_current_frame]) != VK_SUCCESS) {
+				throw std::runtime_error("Failed to submit queue!");
+			}
 		}
+		_frame_submitted = true;
+		_frame_number++;
 
 		VkSwapchainKHR swapchains[] = {_swapchain};
 
@@ -520,29 +1341,20 @@ namespace VkDraw {
 		present.pSwapchains = swapchains;
 		present.pImageIndices = &image_idx;
 
-		res = vkQueuePresentKHR(_present_queue, &present);
+		{
+			TRACE_SCOPE("vkQueuePresentKHR");
+			res = vkQueuePresentKHR(_present_queue, &present);
+		}
 		if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR || _window_resized) {
 			recreate_swapchain();
 		} else if (res != VK_SUCCESS) {
 			throw std::runtime_error("Failed to present swap chain image!");
 		}
 
+		_frame_cpu_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count();
 		_current_frame = (_current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
 	}
 
-	static uint32_t find_memory_type(const uint32_t filter, const VkMemoryPropertyFlags flags) {
-		VkPhysicalDeviceMemoryProperties properties{};
-		vkGetPhysicalDeviceMemoryProperties(_physical_device, &properties);
-
-		for (uint32_t i = 0; i < properties.memoryTypeCount; i++) {
-			if (filter & (1 << i) && (properties.memoryTypes[i].propertyFlags & flags) == flags) {
-				return i;
-			}
-		}
-
-		throw std::runtime_error("Failed to find suitable memory type!");
-	}
-
 	static void create_buffer(
 		VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer,
 		VkDeviceMemory &memory
@@ -563,7 +1375,7 @@ namespace VkDraw {
 		VkMemoryAllocateInfo alloc_info{};
 		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
 		alloc_info.allocationSize = requirements.size;
-		alloc_info.memoryTypeIndex = find_memory_type(requirements.memoryTypeBits, properties);
+		alloc_info.memoryTypeIndex = _device_caps.find_memory_type(requirements.memoryTypeBits, properties);
 
 		if (vkAllocateMemory(_logical_device, &alloc_info, nullptr, &memory) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to allocate buffer memory!");
@@ -601,7 +1413,7 @@ namespace VkDraw {
 		VkMemoryAllocateInfo alloc_info{};
 		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
 		alloc_info.allocationSize = requirements.size;
-		alloc_info.memoryTypeIndex = find_memory_type(requirements.memoryTypeBits, properties);
+		alloc_info.memoryTypeIndex = _device_caps.find_memory_type(requirements.memoryTypeBits, properties);
 
 		if (vkAllocateMemory(_logical_device, &alloc_info, nullptr, &memory) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to allocate image memory!");
@@ -688,6 +1500,7 @@ namespace VkDraw {
 	}
 
 	static void copy_buffer_to_image(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
+		TRACE_SCOPE("copy_buffer_to_image");
 		VkCommandBuffer cmd = begin_single_use_command();
 
 		VkBufferImageCopy region{};
@@ -709,6 +1522,7 @@ namespace VkDraw {
 	}
 
 	static void copy_buffer(VkBuffer src, VkBuffer dest, VkDeviceSize size) {
+		TRACE_SCOPE("copy_buffer");
 		VkCommandBuffer cmd = begin_single_use_command();
 
 		VkBufferCopy copy{};
@@ -718,56 +1532,45 @@ namespace VkDraw {
 		end_single_use_command(cmd);
 	}
 
-	static VkFormat find_supported_format(
-		const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features
-	) {
-		for (const auto format : candidates) {
-			VkFormatProperties props;
-			vkGetPhysicalDeviceFormatProperties(_physical_device, format, &props);
-
-			if (tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features) {
-				return format;
-			}
-			if (tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features) {
-				return format;
-			}
-		}
-
-		throw std::runtime_error("Failed to find supported format!");
-	}
-
 	static void create_depth_resources() {
-		VkFormat format = find_supported_format(
-			{VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
-			VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
-		);
+		_depth_capacity.width = std::max(_depth_capacity.width, _swapchain_extent.width);
+		_depth_capacity.height = std::max(_depth_capacity.height, _swapchain_extent.height);
+
 		create_image(
-			_swapchain_extent.width, _swapchain_extent.height, format, VK_IMAGE_TILING_OPTIMAL,
+			_depth_capacity.width, _depth_capacity.height, _depth_format, VK_IMAGE_TILING_OPTIMAL,
 			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 			_depth_image, _depth_image_memory
 		);
-		_depth_image_view = create_image_view(_depth_image, format, VK_IMAGE_ASPECT_DEPTH_BIT);
+		_depth_image_view = create_image_view(_depth_image, _depth_format, VK_IMAGE_ASPECT_DEPTH_BIT);
+		set_debug_name(_logical_device, _depth_image, "depth target");
+		set_debug_name(_logical_device, _depth_image_memory, "depth target memory");
+		set_debug_name(_logical_device, _depth_image_view, "depth target view");
 		// TODO: cleanup
 	}
 
-	int run(std::span<std::string_view> args) {
-		// print all arguments
-		for (auto [idx, arg] : std::views::enumerate(args)) {
-			std::printf("arg[%zu] = %s\n", idx, arg.data());
-			// TODO: parse arguments
-		}
-
+	static void init_window() {
 		if (SDL_Init(SDL_INIT_VIDEO) != 0) {
 			throw std::runtime_error("Failed to initialize SDL!");
 		}
 
 		if (_window = SDL_CreateWindow(
 			"VkDraw", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WIDTH, HEIGHT,
-			SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE
+			SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE | (_options.headless ? SDL_WINDOW_HIDDEN : 0)
 		); _window == nullptr) {
 			throw std::runtime_error("Failed to create SDL Window!");
 		}
+	}
+
+	// SDL window queries are only made from the main thread, instance creation runs on a worker
+	static std::vector<const char *> query_window_extensions() {
+		uint32_t count;
+		SDL_Vulkan_GetInstanceExtensions(_window, &count, nullptr);
+		std::vector<const char *> extensions(count);
+		SDL_Vulkan_GetInstanceExtensions(_window, &count, extensions.data());
+		return extensions;
+	}
 
+	static void create_instance(std::vector<const char *> window_extensions) {
 		uint32_t ver;
 		vkEnumerateInstanceVersion(&ver);
 		std::printf(
@@ -804,14 +1607,55 @@ namespace VkDraw {
 
 		// check required Vulkan extensions
 		{
-			uint32_t count;
-			SDL_Vulkan_GetInstanceExtensions(_window, &count, nullptr);
-			_required_extensions.resize(count);
-			SDL_Vulkan_GetInstanceExtensions(_window, &count, _required_extensions.data());
+			_required_extensions = std::move(window_extensions);
+
+			// HDR and extended color spaces are only exposed with this extension
+			if (_options.surface.output != ColorOutput::SDR) {
+				for (const auto &ext : _supported_extensions) {
+					if (strcmp(ext.extensionName, "VK_EXT_swapchain_colorspace") == 0) {
+						_required_extensions.push_back("VK_EXT_swapchain_colorspace");
+						break;
+					}
+				}
+			}
+
+			// object names and command labels for captures, which are compiled out of release builds,
+			// and the messenger validation reports through
+			bool want_debug_utils = _use_validation;
+#ifndef NDEBUG
+			want_debug_utils = true;
+#endif
+			for (const auto &ext : _supported_extensions) {
+				if (want_debug_utils && strcmp(ext.extensionName, VK_EXT_DEBUG_UTILS_EXTENSION_NAME) == 0) {
+					_required_extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+					_debug_utils = true;
+					break;
+				}
+			}
+
+			// gpu assisted, synchronization and best practices validation are switched on through the layer
+			if (!validation_features(_validation_mode).empty()) {
+				uint32_t count;
+				vkEnumerateInstanceExtensionProperties(VALIDATION_LAYERS[0], &count, nullptr);
+				std::vector<VkExtensionProperties> layer_extensions(count);
+				vkEnumerateInstanceExtensionProperties(VALIDATION_LAYERS[0], &count, layer_extensions.data());
+
+				bool found = false;
+				for (const auto &ext : layer_extensions) {
+					if (strcmp(ext.extensionName, "VK_EXT_validation_features") == 0) {
+						found = true;
+						break;
+					}
+				}
+				if (!found) {
+					throw std::runtime_error("Validation layer does not support VK_EXT_validation_features!");
+				}
+				_required_extensions.push_back("VK_EXT_validation_features");
+			}
 
 			// TODO: push additional required extensions
 
-			std::printf("Vulkan: %u extension/s required {\n", count);
+			std::printf("Vulkan: %zu extension/s required {\n", _required_extensions.size());
 			for (const auto ext : _required_extensions) {
 				std::printf("\t%s\n", ext);
 			}
@@ -847,9 +1691,25 @@ namespace VkDraw {
 			info.enabledExtensionCount = _required_extensions.size();
 			info.ppEnabledExtensionNames = _required_extensions.data();
 
+			// the chained messenger also reports on instance creation and destruction
+			const auto features = validation_features(_validation_mode);
+			VkValidationFeaturesEXT validation{};
+			validation.sType = VK_STRUCTURE_TYPE_VALIDATION_FEATURES_EXT;
+			validation.enabledValidationFeatureCount = features.size();
+			validation.pEnabledValidationFeatures = features.data();
+			auto messenger = _validation.create_info();
+
 			if (_use_validation) {
 				info.enabledLayerCount = VALIDATION_LAYERS.size();
 				info.ppEnabledLayerNames = VALIDATION_LAYERS.data();
+				if (_debug_utils) {
+					messenger.pNext = info.pNext;
+					info.pNext = &messenger;
+				}
+				if (!features.empty()) {
+					validation.pNext = info.pNext;
+					info.pNext = &validation;
+				}
 			} else {
 				info.enabledLayerCount = 0;
 				info.ppEnabledLayerNames = nullptr;
@@ -860,13 +1720,176 @@ namespace VkDraw {
 			}
 		}
 
+		if (_debug_utils) {
+			init_debug_utils(_instance);
+		}
+		if (_debug_utils && _use_validation) {
+			_validation.init(_instance);
+		}
+	}
+
+	static void create_surface() {
 		// create window surface
 		{
 			if (SDL_Vulkan_CreateSurface(_window, _instance, &_surface) != SDL_TRUE) {
 				throw std::runtime_error("Failed to create window surface!");
 			}
 		}
+	}
+
+	static const char *device_type_name(VkPhysicalDeviceType type) {
+		switch (type) {
+			case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+				return "discrete";
+			case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+				return "integrated";
+			case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+				return "virtual";
+			case VK_PHYSICAL_DEVICE_TYPE_CPU:
+				return "cpu";
+			default:
+				return "other";
+		}
+	}
+
+	static QueueFamilyIndex find_queue_families(VkPhysicalDevice device) {
+		QueueFamilyIndex result;
+
+		uint32_t count;
+		vkGetPhysicalDeviceQueueFamilyProperties(device, &count, nullptr);
+		std::vector<VkQueueFamilyProperties> families(count);
+		vkGetPhysicalDeviceQueueFamilyProperties(device, &count, families.data());
+
+		for (auto [idx, family] : std::views::enumerate(families)) {
+			bool support_gfx = family.queueFlags & VK_QUEUE_GRAPHICS_BIT;
+			if (support_gfx) {
+				result.gfx_family = idx;
+			}
+
+			VkBool32 support_presentation = false;
+			vkGetPhysicalDeviceSurfaceSupportKHR(device, idx, _surface, &support_presentation);
+			if (support_presentation) {
+				result.present_family = idx;
+			}
+
+			if (support_gfx && support_presentation) {
+				break;
+			}
+		}
+
+		return result;
+	}
+
+	// devices missing a hard requirement are rejected, the rest are rated by device type, then memory size and
+	// then a score of optional features, queues and limits
+	static DeviceRating rate_device(VkPhysicalDevice device) {
+		DeviceRating rating{};
+		rating.device = device;
+		rating.caps = query_device_capabilities(device);
+
+		const auto &features = rating.caps.features;
+		const auto &memory = rating.caps.memory;
+
+		// check if device supports required extensions
+		for (const auto &required : DEVICE_EXTENSIONS) {
+			if (!rating.caps.has_extension(required)) {
+				rating.rejected = "missing required extensions";
+				return rating;
+			}
+		}
+
+		if (!features.samplerAnisotropy) {
+			rating.rejected = "missing required features";
+			return rating;
+		}
+
+		const auto queues = find_queue_families(device);
+		if (!queues.gfx_family.has_value() || !queues.present_family.has_value()) {
+			rating.rejected = "no graphics and presentation queues";
+			return rating;
+		}
+
+		// check if device can present to the window surface
+		{
+			uint32_t format_count;
+			vkGetPhysicalDeviceSurfaceFormatsKHR(device, _surface, &format_count, nullptr);
+			uint32_t mode_count;
+			vkGetPhysicalDeviceSurfacePresentModesKHR(device, _surface, &mode_count, nullptr);
+
+			if (format_count == 0 || mode_count == 0) {
+				rating.rejected = "no swapchain support";
+				return rating;
+			}
+		}
+
+		switch (rating.caps.properties.deviceType) {
+			case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+				rating.type_rank = 4;
+				break;
+			case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+				rating.type_rank = 3;
+				break;
+			case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+				rating.type_rank = 2;
+				break;
+			case VK_PHYSICAL_DEVICE_TYPE_CPU:
+				rating.type_rank = 1;
+				break;
+			default:
+				break;
+		}
+
+		VkDeviceSize vram = 0;
+		for (uint32_t i = 0; i < memory.memoryHeapCount; i++) {
+			if (memory.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+				vram = std::max(vram, memory.memoryHeaps[i].size);
+			}
+		}
+		rating.vram = static_cast<uint32_t>(vram >> 28);
+
+		for (const auto optional : {
+			features.fillModeNonSolid, features.wideLines, features.largePoints, features.multiDrawIndirect,
+			features.shaderInt64, features.pipelineStatisticsQuery, features.textureCompressionBC
+		}) {
+			if (optional) {
+				rating.score += 100;
+			}
+		}
 
+		if (queues.gfx_family == queues.present_family) {
+			rating.score += 200;
+		}
+
+		// a transfer only queue family usually maps to a dedicated copy engine
+		{
+			uint32_t count;
+			vkGetPhysicalDeviceQueueFamilyProperties(device, &count, nullptr);
+			std::vector<VkQueueFamilyProperties> families(count);
+			vkGetPhysicalDeviceQueueFamilyProperties(device, &count, families.data());
+
+			for (const auto &family : families) {
+				if ((family.queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+					!(family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+					rating.score += 100;
+					break;
+				}
+			}
+		}
+
+		const auto &limits = rating.caps.properties.limits;
+		rating.score += limits.maxImageDimension2D / 256;
+		if (limits.timestampComputeAndGraphics) {
+			rating.score += 100;
+		}
+
+		return rating;
+	}
+
+	static bool is_better_device(const DeviceRating &a, const DeviceRating &b) {
+		return std::tie(a.type_rank, a.vram, a.score) > std::tie(b.type_rank, b.vram, b.score);
+	}
+
+	static void select_device() {
 		// select appropriate GPU
 		{
 			uint32_t count;
@@ -874,79 +1897,69 @@ namespace VkDraw {
 			std::vector<VkPhysicalDevice> devices(count);
 			vkEnumeratePhysicalDevices(_instance, &count, devices.data());
 
-			std::printf("Vulkan: %u device/s found {\n", count);
+			std::vector<DeviceRating> ratings;
 			for (const auto &device : devices) {
-				VkPhysicalDeviceProperties properties;
-				vkGetPhysicalDeviceProperties(device, &properties);
-				VkPhysicalDeviceFeatures features;
-				vkGetPhysicalDeviceFeatures(device, &features);
-
-				std::printf("\t%s\n", properties.deviceName);
-
-				bool dedicated = properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
-				bool supports_extensions = true;
-				bool supports_features = features.samplerAnisotropy; // TODO: add more features
-
-				// check if device supports required extensions
-				{
-					uint32_t ext_count;
-					vkEnumerateDeviceExtensionProperties(device, nullptr, &ext_count, nullptr);
-					std::vector<VkExtensionProperties> ext_properties(ext_count);
-					vkEnumerateDeviceExtensionProperties(device, nullptr, &ext_count, ext_properties.data());
-
-					for (const auto &required : DEVICE_EXTENSIONS) {
-						bool found = false;
-						for (const auto &ext : ext_properties) {
-							if (strcmp(ext.extensionName, required) == 0) {
-								found = true;
-								break;
-							}
-						}
-						if (!found) {
-							supports_extensions = false;
-							break;
-						}
-					}
-				}
+				ratings.push_back(rate_device(device));
+			}
 
-				// TODO: also check queue family support
-				// TODO: also check swapchain support
-				// TODO: "rank" devices by non-essential features
-				if (dedicated && supports_extensions && supports_features) {
-					_physical_device = device;
+			std::printf("Vulkan: %u device/s found {\n", count);
+			for (auto [idx, rating] : std::views::enumerate(ratings)) {
+				if (rating.rejected) {
+					std::printf(
+						"\t[%zu] %s (%s) rejected: %s\n", idx, rating.caps.properties.deviceName,
+						device_type_name(rating.caps.properties.deviceType), rating.rejected
+					);
+				} else {
+					std::printf(
+						"\t[%zu] %s (%s) vram: %uMiB score: %llu\n", idx, rating.caps.properties.deviceName,
+						device_type_name(rating.caps.properties.deviceType), rating.vram * 256,
+						static_cast<unsigned long long>(rating.score)
+					);
 				}
 			}
 			std::printf("}\n");
 
-			if (_physical_device == nullptr) {
-				throw std::runtime_error("No suitable graphics device was found!");
-			}
-		}
-
-		// find queue families
-		{
-			uint32_t count;
-			vkGetPhysicalDeviceQueueFamilyProperties(_physical_device, &count, nullptr);
-			std::vector<VkQueueFamilyProperties> families(count);
-			vkGetPhysicalDeviceQueueFamilyProperties(_physical_device, &count, families.data());
-
-			for (auto [idx, family] : std::views::enumerate(families)) {
-				bool support_gfx = family.queueFlags & VK_QUEUE_GRAPHICS_BIT;
-				if (support_gfx) {
-					_queue_family.gfx_family = idx;
+			const DeviceRating *selected = nullptr;
+			if (_options.device.has_value()) {
+				for (auto [idx, rating] : std::views::enumerate(ratings)) {
+					const auto index = static_cast<uint32_t>(idx);
+					if (device_matches(*_options.device, index, rating.caps.properties.deviceName)) {
+						selected = &rating;
+						break;
+					}
 				}
 
-				VkBool32 support_presentation = false;
-				vkGetPhysicalDeviceSurfaceSupportKHR(_physical_device, idx, _surface, &support_presentation);
-				if (support_presentation) {
-					_queue_family.present_family = idx;
+				if (selected == nullptr) {
+					throw std::runtime_error("Requested graphics device was not found!");
+				}
+				if (selected->rejected) {
+					throw std::runtime_error("Requested graphics device is not suitable!");
+				}
+			} else {
+				for (const auto &rating : ratings) {
+					if (!rating.rejected && (selected == nullptr || is_better_device(rating, *selected))) {
+						selected = &rating;
+					}
 				}
 
-				if (support_gfx && support_presentation) {
-					break;
+				if (selected == nullptr) {
+					throw std::runtime_error("No suitable graphics device was found!");
 				}
 			}
 
+			_physical_device = selected->device;
+			_device_caps = selected->caps;
+			_depth_format = _device_caps.find_supported_format(
+				{VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
+				VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
+			);
+			std::printf("Vulkan: using %s\n", selected->caps.properties.deviceName);
+		}
+
+		// find queue families
+		{
+			_queue_family = find_queue_families(_physical_device);
+
 			if (!_queue_family.gfx_family.has_value()) {
 				throw std::runtime_error("No suitable graphics queue family available!");
 			}
@@ -954,7 +1967,9 @@ namespace VkDraw {
 				throw std::runtime_error("No suitable presentation queue family available!");
 			}
 		}
+	}
 
+	static void create_logical_device() {
 		// create logical device
 		{
 			std::vector<VkDeviceQueueCreateInfo> families;
@@ -974,15 +1989,23 @@ namespace VkDraw {
 
 			VkPhysicalDeviceFeatures features{};
 			features.samplerAnisotropy = VK_TRUE;
+			features.pipelineStatisticsQuery = _device_caps.features.pipelineStatisticsQuery;
 			// TODO: add features
 
+			_device_extensions.assign(DEVICE_EXTENSIONS.begin(), DEVICE_EXTENSIONS.end());
+			for (const auto extension : OPTIONAL_DEVICE_EXTENSIONS) {
+				if (_device_caps.has_extension(extension)) {
+					_device_extensions.push_back(extension);
+				}
+			}
+
 			VkDeviceCreateInfo info{};
 			info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 			info.pQueueCreateInfos = families.data();
 			info.queueCreateInfoCount = families.size();
 			info.pEnabledFeatures = &features;
-			info.ppEnabledExtensionNames = DEVICE_EXTENSIONS.data();
-			info.enabledExtensionCount = DEVICE_EXTENSIONS.size();
+			info.ppEnabledExtensionNames = _device_extensions.data();
+			info.enabledExtensionCount = _device_extensions.size();
 
 			if (_use_validation) {
 				info.enabledLayerCount = VALIDATION_LAYERS.size();
@@ -1001,253 +2024,146 @@ namespace VkDraw {
 		{
 			vkGetDeviceQueue(_logical_device, _queue_family.gfx_family.value(), 0, &_gfx_queue);
 			vkGetDeviceQueue(_logical_device, _queue_family.present_family.value(), 0, &_present_queue);
+			set_debug_name(_logical_device, _gfx_queue, "graphics queue");
+			if (_present_queue != _gfx_queue) {
+				set_debug_name(_logical_device, _present_queue, "present queue");
+			}
 		}
+	}
 
-		create_swapchain();
-		create_image_views();
-
-		// create description set layout
+	static void create_render_pass() {
+		// create render pass
 		{
-			VkDescriptorSetLayoutBinding ubos{};
-			ubos.binding = 0;
-			ubos.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			ubos.descriptorCount = 1;
-			ubos.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; // TODO: change if needed in other stages
-			ubos.pImmutableSamplers = nullptr;
-
-			VkDescriptorSetLayoutBinding sampler{};
-			sampler.binding = 1;
-			sampler.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			sampler.descriptorCount = 1;
-			sampler.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-			sampler.pImmutableSamplers = nullptr;
-
-			std::array bindings = {ubos, sampler};
-
-			VkDescriptorSetLayoutCreateInfo info{};
-			info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-			info.pBindings = bindings.data();
-			info.bindingCount = bindings.size();
+			VkAttachmentDescription color_attach{};
+			color_attach.format = _swapchain_format.format;
+			color_attach.samples = VK_SAMPLE_COUNT_1_BIT;
+			color_attach.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+			color_attach.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+			color_attach.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			color_attach.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			color_attach.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			color_attach.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+			VkAttachmentDescription depth_attach{};
+			depth_attach.format = _depth_format;
+			depth_attach.samples = VK_SAMPLE_COUNT_1_BIT;
+			depth_attach.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+			depth_attach.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE; // TODO: change if needed
+			depth_attach.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			depth_attach.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			depth_attach.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			depth_attach.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+			std::array attachments = {color_attach, depth_attach};
+
+			VkAttachmentReference color_ref{};
+			color_ref.attachment = 0;
+			color_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+			VkAttachmentReference depth_ref{};
+			depth_ref.attachment = 1;
+			depth_ref.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+			VkSubpassDescription subpass{};
+			subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+			subpass.colorAttachmentCount = 1;
+			subpass.pColorAttachments = &color_ref;
+			subpass.pDepthStencilAttachment = &depth_ref;
+
+			VkSubpassDependency dependency{};
+			dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+			dependency.dstSubpass = 0;
+			dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+				VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+			dependency.srcAccessMask = 0;
+			dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+				VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+			dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+			VkRenderPassCreateInfo info{};
+			info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+			info.attachmentCount = attachments.size();
+			info.pAttachments = attachments.data();
+			info.subpassCount = 1;
+			info.pSubpasses = &subpass;
+			info.dependencyCount = 1;
+			info.pDependencies = &dependency;
 
-			if (vkCreateDescriptorSetLayout(_logical_device, &info, nullptr, &_descriptor_set_layout) != VK_SUCCESS) {
-				throw std::runtime_error("Failed to create descriptor set layout!");
+			if (vkCreateRenderPass(_logical_device, &info, nullptr, &_render_pass) != VK_SUCCESS) {
+				throw std::runtime_error("Failed to create render pass!");
 			}
+			set_debug_name(_logical_device, _render_pass, "main render pass");
 		}
+	}
 
-		// create graphics pipeline
-		{
-			VkGraphicsPipelineCreateInfo pipeline_info{};
-			pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-
-			// create shader modules
-			auto vert_shader = create_module(VERT_SHADER_PATH);
-			auto frag_shader = create_module(FRAG_SHADER_PATH);
-
-			VkPipelineShaderStageCreateInfo vert_stage{};
-			vert_stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-			vert_stage.stage = VK_SHADER_STAGE_VERTEX_BIT;
-			vert_stage.module = vert_shader;
-			vert_stage.pName = "main";
-
-			VkPipelineShaderStageCreateInfo frag_stage{};
-			frag_stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-			frag_stage.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-			frag_stage.module = frag_shader;
-			frag_stage.pName = "main";
-
-			VkPipelineShaderStageCreateInfo stages[] = {vert_stage, frag_stage};
-
-			pipeline_info.stageCount = 2;
-			pipeline_info.pStages = stages;
-
-			// vertex input stage
-			auto binding = Vertex::get_binding();
-			auto attribs = Vertex::get_attribute();
-			VkPipelineVertexInputStateCreateInfo vertex_input_stage{};
-			vertex_input_stage.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-			vertex_input_stage.vertexBindingDescriptionCount = 1;
-			vertex_input_stage.pVertexBindingDescriptions = &binding;
-			vertex_input_stage.vertexAttributeDescriptionCount = attribs.size();
-			vertex_input_stage.pVertexAttributeDescriptions = attribs.data();
-			pipeline_info.pVertexInputState = &vertex_input_stage;
-
-			// input assembly
-			VkPipelineInputAssemblyStateCreateInfo input_assembly{};
-			input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-			input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-			input_assembly.primitiveRestartEnable = VK_FALSE;
-			pipeline_info.pInputAssemblyState = &input_assembly;
-
-			// viewport state
-			VkPipelineViewportStateCreateInfo viewport_state{};
-			viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-			viewport_state.viewportCount = 1;
-			viewport_state.scissorCount = 1;
-			pipeline_info.pViewportState = &viewport_state;
-
-			// rasterization
-			VkPipelineRasterizationStateCreateInfo rasterization_stage{};
-			rasterization_stage.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-			rasterization_stage.depthClampEnable = VK_FALSE;
-			rasterization_stage.rasterizerDiscardEnable = VK_FALSE;
-			rasterization_stage.polygonMode = VK_POLYGON_MODE_FILL;
-			rasterization_stage.lineWidth = 1.0f;
-			rasterization_stage.cullMode = VK_CULL_MODE_BACK_BIT;
-			rasterization_stage.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-			rasterization_stage.depthBiasEnable = VK_FALSE;
-			pipeline_info.pRasterizationState = &rasterization_stage;
-
-			// multisampling
-			VkPipelineMultisampleStateCreateInfo multisampling_state{};
-			multisampling_state.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-			multisampling_state.sampleShadingEnable = VK_FALSE;
-			multisampling_state.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-			pipeline_info.pMultisampleState = &multisampling_state;
-
-			// depth and stencil
-			VkPipelineDepthStencilStateCreateInfo depth_stencil{};
-			depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-			depth_stencil.depthTestEnable = VK_TRUE;
-			depth_stencil.depthWriteEnable = VK_TRUE;
-			depth_stencil.depthCompareOp = VK_COMPARE_OP_LESS;
-			depth_stencil.depthBoundsTestEnable = VK_FALSE;
-			// depth_stencil.minDepthBounds = 0.0f;
-			// depth_stencil.maxDepthBounds = 1.0f;
-			depth_stencil.stencilTestEnable = VK_FALSE;
-			// depth_stencil.front = {};
-			// depth_stencil.back = {};
-
-			pipeline_info.pDepthStencilState = &depth_stencil;
-
-			// color blending
-			VkPipelineColorBlendAttachmentState blend_attachment{};
-			blend_attachment.colorWriteMask =
-				VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-				VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-			blend_attachment.blendEnable = VK_FALSE;
-
-			VkPipelineColorBlendStateCreateInfo blending_state{};
-			blending_state.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-			blending_state.logicOpEnable = VK_FALSE;
-			blending_state.attachmentCount = 1;
-			blending_state.pAttachments = &blend_attachment;
-			pipeline_info.pColorBlendState = &blending_state;
-
-			// dynamic states
-			std::vector<VkDynamicState> dynamic_states = {
-				VK_DYNAMIC_STATE_VIEWPORT,
-				VK_DYNAMIC_STATE_SCISSOR
-			};
-
-			VkPipelineDynamicStateCreateInfo dynamic_state_info{};
-			dynamic_state_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-			dynamic_state_info.dynamicStateCount = dynamic_states.size();
-			dynamic_state_info.pDynamicStates = dynamic_states.data();
-
-			pipeline_info.pDynamicState = &dynamic_state_info;
+	static ShaderProgram create_program(
+		const char *name, std::span<const uint32_t> vert_code, std::span<const uint32_t> frag_code
+	) {
+		ShaderProgram program{};
 
-			// pipeline layout
-			{
-				VkPipelineLayoutCreateInfo info{};
-				info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-				info.setLayoutCount = 1;
-				info.pSetLayouts = &_descriptor_set_layout;
-				info.pushConstantRangeCount = 0;
-				info.pPushConstantRanges = nullptr;
-
-				if (vkCreatePipelineLayout(_logical_device, &info, nullptr, &_pipeline_layout) != VK_SUCCESS) {
-					throw std::runtime_error("Failed to create pipeline layout!");
+		// reflect shader interface
+		{
+			std::array stages = {reflect_shader(vert_code), reflect_shader(frag_code)};
+			program.reflection = reflect_pipeline(stages);
+
+			// uniform buffers live in the transient buffer, their offsets change every frame
+			for (auto &bindings : program.reflection.sets) {
+				for (auto &binding : bindings) {
+					if (binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+						binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+					}
 				}
-
-				pipeline_info.layout = _pipeline_layout;
 			}
 
-			// create render pass
-			{
-				VkAttachmentDescription color_attach{};
-				color_attach.format = _swapchain_format.format;
-				color_attach.samples = VK_SAMPLE_COUNT_1_BIT;
-				color_attach.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-				color_attach.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-				color_attach.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-				color_attach.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-				color_attach.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-				color_attach.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-				VkAttachmentDescription depth_attach{};
-				depth_attach.format = find_supported_format(
-					{VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
-					VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
-				); // TODO: call this function once earlier
-				depth_attach.samples = VK_SAMPLE_COUNT_1_BIT;
-				depth_attach.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-				depth_attach.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE; // TODO: change if needed
-				depth_attach.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-				depth_attach.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-				depth_attach.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-				depth_attach.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-				std::array attachments = {color_attach, depth_attach};
-
-				VkAttachmentReference color_ref{};
-				color_ref.attachment = 0;
-				color_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-				VkAttachmentReference depth_ref{};
-				depth_ref.attachment = 1;
-				depth_ref.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-				VkSubpassDescription subpass{};
-				subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-				subpass.colorAttachmentCount = 1;
-				subpass.pColorAttachments = &color_ref;
-				subpass.pDepthStencilAttachment = &depth_ref;
-
-				VkSubpassDependency dependency{};
-				dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-				dependency.dstSubpass = 0;
-				dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-					VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-				dependency.srcAccessMask = 0;
-				dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
-					VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-				dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
-					VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-				VkRenderPassCreateInfo info{};
-				info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-				info.attachmentCount = attachments.size();
-				info.pAttachments = attachments.data();
-				info.subpassCount = 1;
-				info.pSubpasses = &subpass;
-				info.dependencyCount = 1;
-				info.pDependencies = &dependency;
-
-				if (vkCreateRenderPass(_logical_device, &info, nullptr, &_render_pass) != VK_SUCCESS) {
-					throw std::runtime_error("Failed to create render pass!");
-				}
-
-				pipeline_info.renderPass = _render_pass;
-				pipeline_info.subpass = 0;
-			}
-
-			pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
-			pipeline_info.basePipelineIndex = -1;
-
-			if (vkCreateGraphicsPipelines(
-				_logical_device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &_pipeline
-			) != VK_SUCCESS) {
-				throw std::runtime_error("Failed to create graphics pipeline!");
+			// set numbers the shaders skip get an empty layout, so the pipeline layout's indices match
+			for (const auto &bindings : program.reflection.sets) {
+				program.set_layouts.push_back(get_set_layout(_logical_device, bindings));
 			}
+			program.layout = get_pipeline_layout(
+				_logical_device, program.set_layouts, program.reflection.push_constants
+			);
+		}
 
-			// cleanup shader modules
-			vkDestroyShaderModule(_logical_device, vert_shader, nullptr);
-			vkDestroyShaderModule(_logical_device, frag_shader, nullptr);
+		// create shader modules
+		{
+			program.vert = create_module(vert_code);
+			program.frag = create_module(frag_code);
+			set_debug_name(_logical_device, program.vert, "%s.vert", name);
+			set_debug_name(_logical_device, program.frag, "%s.frag", name);
 		}
 
-		create_depth_resources();
-		create_framebuffers();
+		return program;
+	}
+
+	static void create_pipelines() {
+		// shaders are embedded at build time, see cmake/embed_spirv.cmake
+		_mesh_program = create_program("mesh", SHADER_VERT_SPV, SHADER_FRAG_SPV);
+		apply_vertex_layout(_mesh_program.reflection, std::array<uint32_t, 3>{
+			offsetof(Vertex, pos), offsetof(Vertex, color), offsetof(Vertex, tex_coord)
+		}, sizeof(Vertex));
+
+		static constexpr std::array<uint32_t, 7> CANVAS_OFFSETS = {
+			offsetof(CanvasInstance, origin), offsetof(CanvasInstance, axis_x), offsetof(CanvasInstance, axis_y),
+			offsetof(CanvasInstance, uv_min), offsetof(CanvasInstance, uv_max), offsetof(CanvasInstance, color),
+			offsetof(CanvasInstance, shape)
+		};
+		_canvas_program = create_program("canvas", CANVAS_VERT_SPV, CANVAS_FRAG_SPV);
+		apply_vertex_layout(_canvas_program.reflection, CANVAS_OFFSETS, sizeof(CanvasInstance));
+
+		_text_program = create_program("text", CANVAS_VERT_SPV, TEXT_FRAG_SPV);
+		apply_vertex_layout(_text_program.reflection, CANVAS_OFFSETS, sizeof(CanvasInstance));
+
+		_path_program = create_program("path", PATH_VERT_SPV, PATH_FRAG_SPV);
+		apply_vertex_layout(_path_program.reflection, std::array<uint32_t, 7>{
+			offsetof(PathBand, min), offsetof(PathBand, max), offsetof(PathBand, first), offsetof(PathBand, count),
+			offsetof(PathBand, color), offsetof(PathBand, mode), offsetof(PathBand, half_width)
+		}, sizeof(PathBand));
+
+		compile_pipelines();
+	}
 
+	static void create_command_objects() {
 		// create command pools
 		{
 			VkCommandPoolCreateInfo info{};
@@ -1258,6 +2174,7 @@ namespace VkDraw {
 			if (vkCreateCommandPool(_logical_device, &info, nullptr, &_command_pool) != VK_SUCCESS) {
 				throw std::runtime_error("Failed to create command pool!");
 			}
+			set_debug_name(_logical_device, _command_pool, "graphics command pool");
 		}
 
 		// setup in-flight arrays
@@ -1300,9 +2217,15 @@ namespace VkDraw {
 				if (vkCreateFence(_logical_device, &fence_info, nullptr, &_in_flight[i]) != VK_SUCCESS) {
 					throw std::runtime_error("Failed to create in_flight fence!");
 				}
+				set_debug_name(_logical_device, _command_buffer[i], "frame %d command buffer", i);
+				set_debug_name(_logical_device, _image_available[i], "frame %d image available", i);
+				set_debug_name(_logical_device, _render_finished[i], "frame %d render finished", i);
+				set_debug_name(_logical_device, _in_flight[i], "frame %d in flight", i);
 			}
 		}
+	}
 
+	static void create_geometry_buffers() {
 		// create vertex buffer
 		{
 			VkDeviceSize size = sizeof(vertices[0]) * vertices.size();
@@ -1329,6 +2252,9 @@ namespace VkDraw {
 				_vertex_buffer, _vertex_buffer_memory
 			);
 
+			set_debug_name(_logical_device, _vertex_buffer, "vertex buffer");
+			set_debug_name(_logical_device, _vertex_buffer_memory, "vertex buffer memory");
+
 			// copy staging buffer to vertex buffer
 			copy_buffer(staging_buffer, _vertex_buffer, size);
 
@@ -1363,6 +2289,9 @@ namespace VkDraw {
 				_index_buffer, _index_buffer_memory
 			);
 
+			set_debug_name(_logical_device, _index_buffer, "index buffer");
+			set_debug_name(_logical_device, _index_buffer_memory, "index buffer memory");
+
 			// copy staging buffer to index buffer
 			copy_buffer(staging_buffer, _index_buffer, size);
 
@@ -1370,35 +2299,56 @@ namespace VkDraw {
 			vkDestroyBuffer(_logical_device, staging_buffer, nullptr);
 			vkFreeMemory(_logical_device, staging_memory, nullptr);
 		}
+	}
 
-		// create uniform buffers
+	static void create_transient_buffer() {
+		// create transient buffer
 		{
-			VkDeviceSize size = sizeof(UniformBufferObject);
+			const VkDeviceSize size = TRANSIENT_BUFFER_SIZE * MAX_FRAMES_IN_FLIGHT;
+
+			// prefer memory the GPU reads at full speed when the host can also map it
+			VkMemoryPropertyFlags flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			for (uint32_t i = 0; i < _device_caps.memory.memoryTypeCount; i++) {
+				const auto type_flags = _device_caps.memory.memoryTypes[i].propertyFlags;
+				if ((type_flags & (flags | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) ==
+					(flags | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+					flags |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+					break;
+				}
+			}
 
-			_uniform_buffers.resize(MAX_FRAMES_IN_FLIGHT);
-			_uniform_buffers_memory.resize(MAX_FRAMES_IN_FLIGHT);
-			_mapped_uniform_buffers.resize(MAX_FRAMES_IN_FLIGHT);
+			create_buffer(
+				size,
+				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+				VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+				flags, _transient_buffer, _transient_buffer_memory
+			);
+			set_debug_name(_logical_device, _transient_buffer, "transient buffer");
+			set_debug_name(_logical_device, _transient_buffer_memory, "transient buffer memory");
 
-			for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-				create_buffer(
-					size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-					_uniform_buffers[i], _uniform_buffers_memory[i]
-				);
-				vkMapMemory(_logical_device, _uniform_buffers_memory[i], 0, size, 0, &_mapped_uniform_buffers[i]);
-			}
+			void *mapped;
+			vkMapMemory(_logical_device, _transient_buffer_memory, 0, size, 0, &mapped);
+			_transient_buffer_mapped = static_cast<std::byte *>(mapped);
 		}
+	}
 
-		// load texture data
+	static SDL_Surface *decode_texture(const char *path) {
+		SDL_Surface *img = IMG_Load(path);
+		if (!img) {
+			throw std::runtime_error("Failed to load texture image!");
+		}
+		if (img->format->BytesPerPixel != 4) {
+			// TODO: support other formats
+			SDL_FreeSurface(img);
+			throw std::runtime_error("Texture image must have 4 bytes per pixel!");
+		}
+		return img;
+	}
+
+	static void upload_texture(SDL_Surface *img, VkImage &image, VkDeviceMemory &memory) {
+		TRACE_SCOPE("upload_texture");
+		// upload texture data
 		{
-			SDL_Surface *img = IMG_Load("textures/texture.png");
-			if (!img) {
-				throw std::runtime_error("Failed to load texture image!");
-			}
-			if (img->format->BytesPerPixel != 4) {
-				// TODO: support other formats
-				throw std::runtime_error("Texture image must have 4 bytes per pixel!");
-			}
 			VkDeviceSize size = img->w * img->h * img->format->BytesPerPixel;
 
 			VkBuffer staging_buffer;
@@ -1417,34 +2367,107 @@ namespace VkDraw {
 			create_image(
 				img->w, img->h, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
 				VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _texture_image, _texture_image_memory
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory
 			);
 
 			transition_image_layout(
-				_texture_image, VK_IMAGE_LAYOUT_UNDEFINED,
+				image, VK_IMAGE_LAYOUT_UNDEFINED,
 				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
 			);
-			copy_buffer_to_image(staging_buffer, _texture_image, img->w, img->h);
+			copy_buffer_to_image(staging_buffer, image, img->w, img->h);
 			transition_image_layout(
-				_texture_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
 			);
 
 			vkDestroyBuffer(_logical_device, staging_buffer, nullptr);
 			vkFreeMemory(_logical_device, staging_memory, nullptr);
-			SDL_FreeSurface(img);
 		}
+	}
+
+	static void create_texture(SDL_Surface *img) {
+		upload_texture(img, _texture_image, _texture_image_memory);
+		set_debug_name(_logical_device, _texture_image, "mesh texture");
+		set_debug_name(_logical_device, _texture_image_memory, "mesh texture memory");
 
 		// create texture image view
 		{
 			_texture_image_view = create_image_view(_texture_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+			set_debug_name(_logical_device, _texture_image_view, "mesh texture view");
+		}
+	}
+
+	// compares the captured frame with the golden image, or replaces the image with it
+	// the capture thread must have been joined, returns whether the run passed
+	static bool finish_golden() {
+		const char *path = _options.golden->c_str();
+		if (_frame_number < GOLDEN_FRAMES) {
+			std::fprintf(stderr, "Golden: the run ended before frame %u was drawn\n", GOLDEN_FRAMES);
+			return false;
+		}
+
+		SDL_Surface *actual = _golden_frame;
+		_golden_frame = nullptr;
+		if (actual == nullptr) {
+			throw std::runtime_error("Failed to capture the golden frame!");
 		}
+		const int width = actual->w;
+		const int height = actual->h;
 
+		GoldenResult result{};
+		try {
+			if (_options.golden_update) {
+				update_golden(path, *actual);
+			} else {
+				result = check_golden(path, *actual);
+			}
+		} catch (...) {
+			SDL_FreeSurface(actual);
+			throw;
+		}
+		SDL_FreeSurface(actual);
+
+		if (_options.golden_update) {
+			std::printf("Golden: %s updated\n", path);
+			return true;
+		}
+		if (!result.size_matches) {
+			std::fprintf(
+				stderr, "Golden: %s differs in size from the %dx%d frame\n", path, width, height
+			);
+			return false;
+		}
+		std::printf(
+			"Golden: %s %s, %llu of %llu pixels differ (largest difference %.3f)\n", path,
+			result.passed() ? "passed" : "FAILED", static_cast<unsigned long long>(result.mismatched),
+			static_cast<unsigned long long>(result.pixels), result.max_delta
+		);
+		return result.passed();
+	}
+
+	static void create_query_pools() {
+		uint32_t count;
+		vkGetPhysicalDeviceQueueFamilyProperties(_physical_device, &count, nullptr);
+		std::vector<VkQueueFamilyProperties> families(count);
+		vkGetPhysicalDeviceQueueFamilyProperties(_physical_device, &count, families.data());
+
+		const auto &family = families[_queue_family.gfx_family.value()];
+		_gpu_timer.init(
+			_logical_device, _device_caps.properties.limits.timestampPeriod, family.timestampValidBits,
+			MAX_FRAMES_IN_FLIGHT
+		);
+
+		if (device_extension_enabled(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME)) {
+			_gpu_timer.enable_calibration(_instance, _physical_device, _logical_device);
+		}
+		if (_device_caps.features.pipelineStatisticsQuery) {
+			_pipeline_stats.init(_logical_device, MAX_FRAMES_IN_FLIGHT);
+		}
+	}
+
+	static void create_texture_sampler() {
 		// create texture sampler
 		{
-			VkPhysicalDeviceProperties props;
-			vkGetPhysicalDeviceProperties(_physical_device, &props); // TODO: cache the properties from earlier
-
 			VkSamplerCreateInfo info{};
 			info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
 			info.magFilter = VK_FILTER_LINEAR;
@@ -1453,7 +2476,7 @@ namespace VkDraw {
 			info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 			info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 			info.anisotropyEnable = VK_TRUE;
-			info.maxAnisotropy = props.limits.maxSamplerAnisotropy; // TODO: provide options to user
+			info.maxAnisotropy = _device_caps.properties.limits.maxSamplerAnisotropy; // TODO: provide options to user
 			info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 			info.unnormalizedCoordinates = VK_FALSE;
 			info.compareEnable = VK_FALSE;
@@ -1466,19 +2489,22 @@ namespace VkDraw {
 			if (vkCreateSampler(_logical_device, &info, nullptr, &_texture_sampler) != VK_SUCCESS) {
 				throw std::runtime_error("Failed to create texture sampler!");
 			}
+			set_debug_name(_logical_device, _texture_sampler, "texture sampler");
 		}
+	}
 
+	static void create_descriptors() {
 		// create descriptor pool
 		{
-			VkDescriptorPoolSize ubo_size{};
-			ubo_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			ubo_size.descriptorCount = MAX_FRAMES_IN_FLIGHT;
-
-			VkDescriptorPoolSize sampler_size{};
-			sampler_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			sampler_size.descriptorCount = MAX_FRAMES_IN_FLIGHT;
-
-			std::array sizes = {ubo_size, sampler_size};
+			std::vector<VkDescriptorPoolSize> sizes;
+			for (const auto &binding : _mesh_program.reflection.sets[0]) {
+				auto size = std::ranges::find(sizes, binding.descriptorType, &VkDescriptorPoolSize::type);
+				if (size == sizes.end()) {
+					sizes.push_back({binding.descriptorType, 0});
+					size = sizes.end() - 1;
+				}
+				size->descriptorCount += binding.descriptorCount * MAX_FRAMES_IN_FLIGHT;
+			}
 
 			VkDescriptorPoolCreateInfo info{};
 			info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -1490,11 +2516,12 @@ namespace VkDraw {
 			if (vkCreateDescriptorPool(_logical_device, &info, nullptr, &_descriptor_pool) != VK_SUCCESS) {
 				throw std::runtime_error("Failed to create descriptor pool!");
 			}
+			set_debug_name(_logical_device, _descriptor_pool, "mesh descriptor pool");
 		}
 
 		// create descriptor sets
 		{
-			std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, _descriptor_set_layout);
+			std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, _mesh_program.set_layouts[0]);
 
 			VkDescriptorSetAllocateInfo info{};
 			info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -1508,8 +2535,11 @@ namespace VkDraw {
 			}
 
 			for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+				set_debug_name(_logical_device, _descriptor_sets[i], "frame %d mesh descriptor set", i);
+
+				// the offset into the transient buffer is supplied when binding
 				VkDescriptorBufferInfo ubo_buffer{};
-				ubo_buffer.buffer = _uniform_buffers[i];
+				ubo_buffer.buffer = _transient_buffer;
 				ubo_buffer.offset = 0;
 				ubo_buffer.range = sizeof(UniformBufferObject);
 
@@ -1524,7 +2554,7 @@ namespace VkDraw {
 				writes[0].dstSet = _descriptor_sets[i];
 				writes[0].dstBinding = 0;
 				writes[0].dstArrayElement = 0;
-				writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+				writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 				writes[0].descriptorCount = 1;
 				writes[0].pBufferInfo = &ubo_buffer;
 
@@ -1539,6 +2569,352 @@ namespace VkDraw {
 				vkUpdateDescriptorSets(_logical_device, writes.size(), writes.data(), 0, nullptr);
 			}
 		}
+	}
+
+	static TextureId add_canvas_texture(CanvasTexture texture) {
+		// create descriptor set
+		{
+			VkDescriptorSetAllocateInfo info{};
+			info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			info.descriptorPool = _canvas_descriptor_pool;
+			info.descriptorSetCount = 1;
+			info.pSetLayouts = &_canvas_program.set_layouts[0];
+
+			if (vkAllocateDescriptorSets(_logical_device, &info, &texture.set) != VK_SUCCESS) {
+				throw std::runtime_error("Failed to allocate descriptor sets!");
+			}
+
+			VkDescriptorImageInfo sampler_info{};
+			sampler_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			sampler_info.imageView = texture.view;
+			sampler_info.sampler = _texture_sampler;
+
+			VkWriteDescriptorSet write{};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = texture.set;
+			write.dstBinding = 0;
+			write.dstArrayElement = 0;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			write.descriptorCount = 1;
+			write.pImageInfo = &sampler_info;
+
+			vkUpdateDescriptorSets(_logical_device, 1, &write, 0, nullptr);
+			_render_counters.descriptor_updates++;
+		}
+
+		const auto id = static_cast<TextureId>(_canvas_textures.size());
+		set_debug_name(_logical_device, texture.image, "canvas texture %u", id);
+		set_debug_name(_logical_device, texture.memory, "canvas texture %u memory", id);
+		set_debug_name(_logical_device, texture.view, "canvas texture %u view", id);
+		set_debug_name(_logical_device, texture.set, "canvas texture %u descriptor set", id);
+
+		_canvas_textures.push_back(texture);
+		return _canvas_textures.size() - 1;
+	}
+
+	static TextureId create_canvas_texture(SDL_Surface *img) {
+		if (_canvas_textures.size() >= CANVAS_MAX_TEXTURES) {
+			throw std::runtime_error("Too many canvas textures!");
+		}
+
+		CanvasTexture texture{};
+		upload_texture(img, texture.image, texture.memory);
+		texture.view = create_image_view(texture.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+		return add_canvas_texture(texture);
+	}
+
+	// an empty glyph atlas page, its contents are uploaded by the frames that add glyphs to it
+	static TextureId create_font_page() {
+		if (_canvas_textures.size() >= CANVAS_MAX_TEXTURES) {
+			throw std::runtime_error("Too many canvas textures!");
+		}
+
+		CanvasTexture texture{};
+		create_image(
+			FontAtlas::PAGE_SIZE, FontAtlas::PAGE_SIZE, VK_FORMAT_R8_UNORM, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture.image, texture.memory
+		);
+		texture.view = create_image_view(texture.image, VK_FORMAT_R8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
+		return add_canvas_texture(texture);
+	}
+
+	static void create_canvas_resources() {
+		// create descriptor pool, one set per texture and one per frame for path data
+		{
+			std::array<VkDescriptorPoolSize, 2> sizes = {{
+				{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, CANVAS_MAX_TEXTURES},
+				{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MAX_FRAMES_IN_FLIGHT}
+			}};
+
+			VkDescriptorPoolCreateInfo info{};
+			info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			info.poolSizeCount = sizes.size();
+			info.pPoolSizes = sizes.data();
+			info.maxSets = CANVAS_MAX_TEXTURES + MAX_FRAMES_IN_FLIGHT;
+			info.flags = 0;
+
+			if (vkCreateDescriptorPool(_logical_device, &info, nullptr, &_canvas_descriptor_pool) != VK_SUCCESS) {
+				throw std::runtime_error("Failed to create descriptor pool!");
+			}
+			set_debug_name(_logical_device, _canvas_descriptor_pool, "canvas descriptor pool");
+		}
+
+		// create path data descriptor sets
+		{
+			std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, _path_program.set_layouts[0]);
+
+			VkDescriptorSetAllocateInfo info{};
+			info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			info.descriptorPool = _canvas_descriptor_pool;
+			info.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
+			info.pSetLayouts = layouts.data();
+
+			_path_descriptor_sets.resize(MAX_FRAMES_IN_FLIGHT);
+			if (vkAllocateDescriptorSets(_logical_device, &info, _path_descriptor_sets.data()) != VK_SUCCESS) {
+				throw std::runtime_error("Failed to allocate descriptor sets!");
+			}
+
+			for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+				set_debug_name(_logical_device, _path_descriptor_sets[i], "frame %d path descriptor set", i);
+
+				VkDescriptorBufferInfo data_buffer{};
+				data_buffer.buffer = _transient_buffer;
+				data_buffer.offset = i * TRANSIENT_BUFFER_SIZE;
+				data_buffer.range = TRANSIENT_BUFFER_SIZE;
+
+				VkWriteDescriptorSet write{};
+				write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				write.dstSet = _path_descriptor_sets[i];
+				write.dstBinding = 0;
+				write.dstArrayElement = 0;
+				write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				write.descriptorCount = 1;
+				write.pBufferInfo = &data_buffer;
+
+				vkUpdateDescriptorSets(_logical_device, 1, &write, 0, nullptr);
+			}
+		}
+
+		// texture 0 is a white pixel so untextured shapes use the same pipeline as sprites
+		{
+			SDL_Surface *white = SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 32, SDL_PIXELFORMAT_RGBA32);
+			if (!white) {
+				throw std::runtime_error("Failed to create white texture!");
+			}
+			SDL_FillRect(white, nullptr, 0xffffffff);
+
+			try {
+				create_canvas_texture(white);
+			} catch (...) {
+				SDL_FreeSurface(white);
+				throw;
+			}
+			SDL_FreeSurface(white);
+		}
+
+		font_atlas().init(create_font_page);
+	}
+
+	TextureId load_texture(const char *path) {
+		if (_logical_device == nullptr) {
+			throw std::runtime_error("Textures can only be loaded while running!");
+		}
+		if (auto it = _canvas_texture_paths.find(path); it != _canvas_texture_paths.end()) {
+			return it->second;
+		}
+
+		// uploads wait for the queue to go idle, so load ahead of time rather than mid animation
+		SDL_Surface *img = decode_texture(path);
+		TextureId texture;
+		try {
+			texture = create_canvas_texture(img);
+		} catch (...) {
+			SDL_FreeSurface(img);
+			throw;
+		}
+		SDL_FreeSurface(img);
+
+		_canvas_texture_paths.emplace(path, texture);
+		return texture;
+	}
+
+	std::optional<FontId> default_font() {
+		return _default_font;
+	}
+
+	Vec2 screen_size() {
+		return {static_cast<float>(_swapchain_extent.width), static_cast<float>(_swapchain_extent.height)};
+	}
+
+	// F12 saves the next frame, F11 starts or stops recording every frame
+	static void toggle_capture(bool stream) {
+		if (!capture_available()) {
+			std::fprintf(stderr, "Capture: needs an 8-bit swapchain that can be copied from, try --output sdr\n");
+			return;
+		}
+
+		char path[64];
+		if (!stream) {
+			std::snprintf(path, sizeof(path), "screenshot-%llu.png", static_cast<unsigned long long>(_frame_number));
+			_capture.capture_next(png_capture(path));
+		} else if (_capture.streaming()) {
+			_capture.set_stream(nullptr);
+			std::printf("Capture: recording stopped\n");
+		} else {
+			std::snprintf(path, sizeof(path), "capture-%llu.y4m", static_cast<unsigned long long>(_frame_number));
+			try {
+				_capture.set_stream(open_capture_stream(path));
+				std::printf("Capture: recording to %s\n", path);
+			} catch (const std::runtime_error &e) {
+				std::fprintf(stderr, "Capture: %s\n", e.what());
+			}
+		}
+	}
+
+	int run(std::span<std::string_view> args, const FrameCallback &on_frame) {
+		// parse arguments
+		for (size_t i = 1; i < args.size(); i++) {
+			if (args[i] == "--device" && i + 1 < args.size()) {
+				_options.device = args[++i];
+			} else if (args[i] == "--output" && i + 1 < args.size()) {
+				_options.surface.output = parse_color_output(args[++i]);
+			} else if (args[i] == "--present" && i + 1 < args.size()) {
+				_options.surface.present = parse_present_preference(args[++i]);
+			} else if (args[i] == "--font" && i + 1 < args.size()) {
+				_options.font = std::string(args[++i]);
+			} else if (args[i] == "--overlay") {
+				_options.overlay = true;
+			} else if (args[i] == "--benchmark" && i + 1 < args.size()) {
+				_options.benchmark = std::string(args[++i]);
+			} else if (args[i] == "--validation" && i + 1 < args.size()) {
+				_options.validation = parse_validation_mode(args[++i]);
+			} else if (args[i] == "--fail-on-validation") {
+				_options.fail_on_validation = true;
+			} else if (args[i] == "--trace" && i + 1 < args.size()) {
+				_options.trace = std::string(args[++i]);
+			} else if (args[i] == "--golden" && i + 1 < args.size()) {
+				_options.golden = std::string(args[++i]);
+			} else if (args[i] == "--golden-update") {
+				_options.golden_update = true;
+			} else if (args[i] == "--capture" && i + 1 < args.size()) {
+				_options.capture = std::string(args[++i]);
+			} else if (args[i] == "--headless") {
+				_options.headless = true;
+			} else if (args[i] == "--frames" && i + 1 < args.size()) {
+				const auto count = args[++i];
+				const auto res = std::from_chars(count.data(), count.data() + count.size(), _options.frames);
+				if (res.ec != std::errc{} || res.ptr != count.data() + count.size() || _options.frames == 0) {
+					throw std::runtime_error("Invalid frame count: " + std::string(count));
+				}
+			} else if (args[i] == "--objects" && i + 1 < args.size()) {
+				const auto count = args[++i];
+				const auto res = std::from_chars(count.data(), count.data() + count.size(), _options.objects);
+				if (res.ec != std::errc{} || res.ptr != count.data() + count.size() || _options.objects == 0) {
+					throw std::runtime_error("Invalid object count: " + std::string(count));
+				}
+			} else {
+				throw std::runtime_error("Unknown argument: " + std::string(args[i]));
+			}
+		}
+
+		if (_options.golden_update && !_options.golden.has_value()) {
+			throw std::runtime_error("--golden-update needs a golden image given with --golden");
+		}
+
+		if (_options.validation.has_value()) {
+			_validation_mode = _options.validation.value();
+			_use_validation = _validation_mode != ValidationMode::OFF;
+		}
+
+		// started before the pool so startup uploads are traced too
+		if (_options.trace.has_value()) {
+			set_trace_thread_name("main");
+			start_trace();
+		}
+
+		_thread_pool = std::make_unique<ThreadPool>(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+
+		// startup runs as a dependency graph so asset decoding and pipeline compilation
+		// overlap with device and swapchain creation, window and surface work stays on this thread
+		{
+			SDL_Surface *texture = nullptr;
+			std::vector<const char *> window_extensions;
+			TaskGraph startup;
+
+			auto window = startup.add("init window", [&window_extensions] {
+				init_window();
+				window_extensions = query_window_extensions();
+			}, {}, true);
+			auto decode = startup.add("decode texture", [&texture] {
+				texture = decode_texture("textures/texture.png");
+			});
+			auto instance = startup.add("create instance", [&window_extensions] {
+				create_instance(std::move(window_extensions));
+			}, {window});
+			auto surface = startup.add("create surface", create_surface, {instance}, true);
+			auto device = startup.add("select device", [] {
+				select_device();
+				create_logical_device();
+			}, {surface});
+			auto format = startup.add("query swapchain support", query_swapchain_support, {device});
+			auto swapchain = startup.add("create swapchain", [] {
+				create_swapchain();
+				create_image_views();
+			}, {format}, true);
+			auto render_pass = startup.add("create render pass", create_render_pass, {format});
+			auto pipelines = startup.add("compile pipelines", create_pipelines, {render_pass});
+			startup.add("create framebuffers", [] {
+				create_depth_resources();
+				create_framebuffers();
+			}, {swapchain, render_pass});
+			auto commands = startup.add("create command objects", create_command_objects, {device});
+			startup.add("upload geometry", [] {
+				std::scoped_lock lock(_upload_mutex);
+				create_geometry_buffers();
+			}, {commands});
+			auto transient = startup.add("create transient buffer", create_transient_buffer, {device});
+			auto upload = startup.add("upload texture", [&texture] {
+				std::scoped_lock lock(_upload_mutex);
+				create_texture(texture);
+				SDL_FreeSurface(texture);
+				texture = nullptr;
+			}, {decode, commands});
+			auto sampler = startup.add("create texture sampler", create_texture_sampler, {device});
+			startup.add("create query pools", create_query_pools, {device});
+			startup.add("create descriptors", create_descriptors, {pipelines, transient, upload, sampler});
+			startup.add("create canvas", [] {
+				std::scoped_lock lock(_upload_mutex);
+				create_canvas_resources();
+			}, {pipelines, commands, transient, sampler});
+
+			try {
+				startup.run(*_thread_pool);
+			} catch (...) {
+				SDL_FreeSurface(texture);
+				throw;
+			}
+
+			_startup_epoch = startup.epoch();
+			startup.print_timeline();
+		}
+
+		if (_options.font.has_value()) {
+			_default_font = load_font(_options.font->c_str());
+		}
+		// the overlay shows timings, which would differ between every golden run
+		_overlay.set_visible(_options.overlay && !_options.golden.has_value());
+		if (_options.benchmark.has_value()) {
+			_benchmark = std::make_unique<BenchmarkRecorder>(_options.frames);
+		}
+		_capture.init(_device_caps, MAX_FRAMES_IN_FLIGHT);
+		create_mesh_nodes(_options.objects);
+		if (_options.golden.has_value() && !capture_available()) {
+			throw std::runtime_error("Golden runs need an 8-bit swapchain that can be copied from, try --output sdr!");
+		}
+		if (_options.capture.has_value()) {
+			_capture.set_stream(open_capture_stream(*_options.capture));
+		}
 
 		SDL_Event event;
 		bool running = true;
@@ -1547,20 +2923,28 @@ namespace VkDraw {
 		float accumulator = 0.0f;
 		float frame_count = 0.0f;
 
-		while (running) {
+		const auto finished = [] {
+			const bool golden_done = _options.golden.has_value() && _frame_number >= GOLDEN_FRAMES;
+			return golden_done || (_benchmark && _benchmark->done());
+		};
+		while (running && !finished()) {
 			auto now = static_cast<float>(SDL_GetTicks());
-			float delta = now - last;
+			float delta = _options.golden.has_value() ? GOLDEN_DELTA * 1000.0f : now - last;
 			last = now;
 			accumulator += delta;
 			frame_count++;
 
 			if (accumulator >= 1000) {
-				char title[64];
+				char title[128];
 				float avg = accumulator / frame_count;
 				accumulator = 0.0f;
 				frame_count = 0.0f;
 
-				std::snprintf(title, sizeof(title), "VkDraw | FPS: %.0f (%.2fms)", 1000.0f / avg, avg);
+				std::snprintf(
+					title, sizeof(title), "VkDraw | FPS: %.0f (%.2fms) | arena heap allocs: %llu",
+					1000.0f / avg, avg, static_cast<unsigned long long>(_arena_upstream_allocations)
+				);
+				_arena_upstream_allocations = 0;
 				SDL_SetWindowTitle(_window, title);
 			}
 
@@ -1573,22 +2957,66 @@ namespace VkDraw {
 						if (event.window.type == SDL_WINDOWEVENT_RESIZED) {
 							_window_resized = true;
 						}
+						break;
+					case SDL_KEYDOWN:
+						if (event.key.repeat) {
+							break;
+						}
+						if (event.key.keysym.sym == SDLK_F3) {
+							_overlay.set_visible(!_overlay.visible());
+						} else if (event.key.keysym.sym == SDLK_F11 || event.key.keysym.sym == SDLK_F12) {
+							toggle_capture(event.key.keysym.sym == SDLK_F11);
+						}
+						break;
 					default:
 						break;
 				}
 			}
 
-			draw_frame();
+			draw_frame(on_frame, delta / 1000.0f);
+
+			if (_startup_epoch != std::chrono::steady_clock::time_point{}) {
+				const std::chrono::duration<double, std::milli> elapsed =
+					std::chrono::steady_clock::now() - _startup_epoch;
+				std::printf("Startup: first frame submitted after %.1fms\n", elapsed.count());
+				_startup_epoch = {};
+			}
 		}
 
 		vkDeviceWaitIdle(_logical_device);
 
+		if (_benchmark) {
+			_benchmark->write(_options.benchmark->c_str(), {
+				.device = _device_caps.properties.deviceName,
+				.width = _swapchain_extent.width,
+				.height = _swapchain_extent.height,
+				.frames_in_flight = MAX_FRAMES_IN_FLIGHT
+			});
+			std::printf("Benchmark: results written to %s\n", _options.benchmark->c_str());
+			_benchmark.reset();
+		}
+		if (_options.trace.has_value()) {
+			write_trace(_options.trace->c_str());
+			std::printf("Trace: written to %s\n", _options.trace->c_str());
+		}
+		_capture.destroy(_logical_device);
+		const bool golden_passed = !_options.golden.has_value() || finish_golden();
+
 		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
 			vkDestroyFence(_logical_device, _in_flight[i], nullptr);
 			vkDestroySemaphore(_logical_device, _render_finished[i], nullptr);
 			vkDestroySemaphore(_logical_device, _image_available[i], nullptr);
 		}
 
+		_pipeline_stats.destroy(_logical_device);
+		_gpu_timer.destroy(_logical_device);
+		font_atlas().shutdown();
+		for (const auto &texture : _canvas_textures) {
+			vkDestroyImageView(_logical_device, texture.view, nullptr);
+			vkDestroyImage(_logical_device, texture.image, nullptr);
+			vkFreeMemory(_logical_device, texture.memory, nullptr);
+		}
+		vkDestroyDescriptorPool(_logical_device, _canvas_descriptor_pool, nullptr);
 		vkDestroyDescriptorPool(_logical_device, _descriptor_pool, nullptr);
 		vkDestroyCommandPool(_logical_device, _command_pool, nullptr);
 
@@ -1596,29 +3024,49 @@ namespace VkDraw {
 		vkDestroyImageView(_logical_device, _texture_image_view, nullptr);
 		vkDestroyImage(_logical_device, _texture_image, nullptr);
 		vkFreeMemory(_logical_device, _texture_image_memory, nullptr);
-		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-			vkDestroyBuffer(_logical_device, _uniform_buffers[i], nullptr);
-			vkFreeMemory(_logical_device, _uniform_buffers_memory[i], nullptr);
-		}
+		vkUnmapMemory(_logical_device, _transient_buffer_memory);
+		vkDestroyBuffer(_logical_device, _transient_buffer, nullptr);
+		vkFreeMemory(_logical_device, _transient_buffer_memory, nullptr);
 		vkDestroyBuffer(_logical_device, _index_buffer, nullptr);
 		vkFreeMemory(_logical_device, _index_buffer_memory, nullptr);
 		vkDestroyBuffer(_logical_device, _vertex_buffer, nullptr);
 		vkFreeMemory(_logical_device, _vertex_buffer_memory, nullptr);
 
-		vkDestroyPipeline(_logical_device, _pipeline, nullptr);
+		for (const auto pipeline : _pipelines) {
+			vkDestroyPipeline(_logical_device, pipeline, nullptr);
+		}
+		for (const auto &pipelines : _canvas_pipelines) {
+			for (const auto pipeline : pipelines) {
+				vkDestroyPipeline(_logical_device, pipeline, nullptr);
+			}
+		}
+		for (const auto &program : {_mesh_program, _canvas_program, _path_program, _text_program}) {
+			vkDestroyShaderModule(_logical_device, program.vert, nullptr);
+			vkDestroyShaderModule(_logical_device, program.frag, nullptr);
+		}
 		vkDestroyRenderPass(_logical_device, _render_pass, nullptr);
-		vkDestroyPipelineLayout(_logical_device, _pipeline_layout, nullptr);
-		vkDestroyDescriptorSetLayout(_logical_device, _descriptor_set_layout, nullptr);
+		destroy_layout_cache(_logical_device);
 
 		cleanup_swapchain();
 
 		vkDestroyDevice(_logical_device, nullptr);
 		vkDestroySurfaceKHR(_instance, _surface, nullptr);
+		_validation.destroy(_instance);
 		vkDestroyInstance(_instance, nullptr);
 
+		_thread_pool.reset();
+
 		SDL_DestroyWindow(_window);
 		SDL_Quit();
 
-		return EXIT_SUCCESS;
+		if (_use_validation) {
+			_validation.print_summary();
+			if (_options.fail_on_validation && _validation.errors() > 0) {
+				std::fprintf(stderr, "Validation reported %u error/s, failing the run\n", _validation.errors());
+				return EXIT_FAILURE;
+			}
+		}
+
+		return golden_passed ? EXIT_SUCCESS : EXIT_FAILURE;
 	}
 }
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <bit>
+
+#include "arena.h"
+
+namespace VkDraw {
+	static constexpr size_t BLOCK_ALIGNMENT = alignof(std::max_align_t);
+
+	FrameArena::FrameArena(size_t capacity, std::pmr::memory_resource *upstream)
+		: _upstream(upstream), _capacity(std::bit_ceil(std::max<size_t>(capacity, BLOCK_ALIGNMENT))) {
+		_block = static_cast<std::byte *>(_upstream->allocate(_capacity, BLOCK_ALIGNMENT));
+		_head = _block;
+		_end = _block + _capacity;
+		_overflow.reserve(8);
+	}
+
+	FrameArena::~FrameArena() {
+		for (const auto &block : _overflow) {
+			_upstream->deallocate(block.data, block.size, BLOCK_ALIGNMENT);
+		}
+		_upstream->deallocate(_block, _capacity, BLOCK_ALIGNMENT);
+	}
+
+	FrameArenaStats FrameArena::reset() {
+		const auto stats = _stats;
+
+		if (!_overflow.empty()) {
+			for (const auto &block : _overflow) {
+				_upstream->deallocate(block.data, block.size, BLOCK_ALIGNMENT);
+			}
+			_overflow.clear();
+
+			// grow to the frame's total so it fits without overflowing next time
+			_upstream->deallocate(_block, _capacity, BLOCK_ALIGNMENT);
+			_capacity = std::bit_ceil(std::max(_capacity * 2, stats.bytes));
+			_block = static_cast<std::byte *>(_upstream->allocate(_capacity, BLOCK_ALIGNMENT));
+		}
+
+		_head = _block;
+		_end = _block + _capacity;
+		_stats = {};
+		return stats;
+	}
+
+	void *FrameArena::do_allocate(size_t bytes, size_t alignment) {
+		auto address = reinterpret_cast<uintptr_t>(_head);
+		auto aligned = (address + alignment - 1) & ~(alignment - 1);
+
+		if (aligned + bytes > reinterpret_cast<uintptr_t>(_end)) {
+			const size_t size = std::max(_capacity, bytes + alignment);
+			auto *block = static_cast<std::byte *>(_upstream->allocate(size, BLOCK_ALIGNMENT));
+			_overflow.push_back({block, size});
+			_stats.upstream_allocations++;
+
+			_head = block;
+			_end = block + size;
+			address = reinterpret_cast<uintptr_t>(_head);
+			aligned = (address + alignment - 1) & ~(alignment - 1);
+		}
+
+		const auto padded = aligned - address + bytes;
+		_head += padded;
+		_stats.allocations++;
+		_stats.bytes += padded;
+		return reinterpret_cast<void *>(aligned);
+	}
+
+	void FrameArena::do_deallocate(void *, size_t, size_t) {
+		// memory is reclaimed all at once by reset()
+	}
+
+	bool FrameArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+		return this == &other;
+	}
+}
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "benchmark.h"
+
+namespace VkDraw {
+	BenchmarkRecorder::BenchmarkRecorder(uint32_t frames) : _frames(frames) {
+		_samples.reserve(frames);
+	}
+
+	void BenchmarkRecorder::record(const FrameStats &stats) {
+		// the first frame has nothing to be timed against
+		if (done() || stats.frame_ms <= 0.0) {
+			return;
+		}
+		_samples.push_back(stats);
+	}
+
+	static void write_times(std::FILE *file, const char *name, std::vector<double> values, bool last = false) {
+		std::fprintf(file, "\t\t\"%s\": ", name);
+		if (values.empty()) {
+			std::fprintf(file, "null%s\n", last ? "" : ",");
+			return;
+		}
+
+		std::ranges::sort(values);
+		double sum = 0.0;
+		for (const auto value : values) {
+			sum += value;
+		}
+		// nearest rank
+		const auto percentile = [&values](double p) {
+			const auto rank = static_cast<size_t>(p * static_cast<double>(values.size() - 1) + 0.5);
+			return values[rank];
+		};
+
+		std::fprintf(
+			file, "{\"mean\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s\n",
+			sum / static_cast<double>(values.size()), values.front(), percentile(0.5), percentile(0.95),
+			percentile(0.99), values.back(), last ? "" : ","
+		);
+	}
+
+	void BenchmarkRecorder::write(const char *path, const BenchmarkInfo &info) const {
+		std::FILE *file = std::fopen(path, "w");
+		if (file == nullptr) {
+			throw std::runtime_error("Failed to open benchmark output: " + std::string(path));
+		}
+
+		std::vector<double> cpu_ms;
+		std::vector<double> frame_ms;
+		std::vector<double> gpu_ms;
+		std::array<double, GPU_PASS_COUNT> pass_ms{};
+		for (const auto &sample : _samples) {
+			cpu_ms.push_back(sample.cpu_ms);
+			frame_ms.push_back(sample.frame_ms);
+			if (sample.gpu.valid) {
+				gpu_ms.push_back(sample.gpu.total_ms);
+				for (size_t i = 0; i < GPU_PASS_COUNT; i++) {
+					pass_ms[i] += sample.gpu.pass_ms[i];
+				}
+			}
+		}
+
+		// per frame means, over only the frames that had a value where the GPU may not have reported one
+		const auto mean = [this](auto &&value, auto &&has_value) {
+			double sum = 0.0;
+			size_t count = 0;
+			for (const auto &sample : _samples) {
+				if (has_value(sample)) {
+					sum += static_cast<double>(value(sample));
+					count++;
+				}
+			}
+			return count > 0 ? sum / static_cast<double>(count) : 0.0;
+		};
+		const auto always = [](const FrameStats &) { return true; };
+		const auto has_pipeline = [](const FrameStats &sample) { return sample.pipeline.valid; };
+
+		std::fprintf(file, "{\n");
+		std::fprintf(file, "\t\"device\": \"");
+		for (const char c : info.device) {
+			if (c == '"' || c == '\\') {
+				std::fputc('\\', file);
+			}
+			std::fputc(c, file);
+		}
+		std::fprintf(file, "\",\n");
+		std::fprintf(file, "\t\"width\": %u,\n\t\"height\": %u,\n", info.width, info.height);
+		std::fprintf(file, "\t\"frames_in_flight\": %u,\n", info.frames_in_flight);
+		std::fprintf(file, "\t\"frames\": %zu,\n", _samples.size());
+
+		std::fprintf(file, "\t\"times_ms\": {\n");
+		write_times(file, "cpu", cpu_ms);
+		write_times(file, "frame", frame_ms);
+		write_times(file, "gpu", gpu_ms, true);
+		std::fprintf(file, "\t},\n");
+
+		std::fprintf(file, "\t\"gpu_pass_ms\": {");
+		for (size_t i = 0; i < GPU_PASS_COUNT; i++) {
+			const double value = gpu_ms.empty() ? 0.0 : pass_ms[i] / static_cast<double>(gpu_ms.size());
+			std::fprintf(
+				file, "%s\"%s\": %.4f", i == 0 ? "" : ", ", gpu_pass_name(static_cast<GpuPass>(i)), value
+			);
+		}
+		std::fprintf(file, "},\n");
+
+		std::fprintf(file, "\t\"counters\": {\n");
+		const std::pair<const char *, double> counters[] = {
+			{"draws", mean([](const FrameStats &s) { return s.counters.draws; }, always)},
+			{"culled", mean([](const FrameStats &s) { return s.counters.culled; }, always)},
+			{"triangles", mean([](const FrameStats &s) { return s.counters.triangles; }, always)},
+			{"pipeline_binds", mean([](const FrameStats &s) { return s.counters.pipeline_binds; }, always)},
+			{"descriptor_binds", mean([](const FrameStats &s) { return s.counters.descriptor_binds; }, always)},
+			{"buffer_binds", mean([](const FrameStats &s) { return s.counters.buffer_binds; }, always)},
+			{"binds_saved", mean([](const FrameStats &s) { return s.counters.binds_saved; }, always)},
+			{"barriers", mean([](const FrameStats &s) { return s.counters.barriers; }, always)},
+			{"descriptor_updates", mean([](const FrameStats &s) { return s.counters.descriptor_updates; }, always)},
+			{"canvas_primitives", mean([](const FrameStats &s) { return s.canvas_primitives; }, always)}
+		};
+		for (size_t i = 0; i < std::size(counters); i++) {
+			std::fprintf(
+				file, "\t\t\"%s\": %.2f%s\n", counters[i].first, counters[i].second,
+				i + 1 < std::size(counters) ? "," : ""
+			);
+		}
+		std::fprintf(file, "\t},\n");
+
+		// null rather than zeros when the device has no pipeline statistics queries
+		if (std::ranges::any_of(_samples, has_pipeline)) {
+			const double pixels = mean([](const FrameStats &s) { return s.pixels; }, has_pipeline);
+			const double fragments = mean(
+				[](const FrameStats &s) { return s.pipeline.fragment_invocations; }, has_pipeline
+			);
+			const double clipped_in = mean(
+				[](const FrameStats &s) { return s.pipeline.clipping_invocations; }, has_pipeline
+			);
+			const double clipped_out = mean(
+				[](const FrameStats &s) { return s.pipeline.clipping_primitives; }, has_pipeline
+			);
+
+			std::fprintf(file, "\t\"pipeline_statistics\": {\n");
+			std::fprintf(
+				file, "\t\t\"input_vertices\": %.2f,\n",
+				mean([](const FrameStats &s) { return s.pipeline.input_vertices; }, has_pipeline)
+			);
+			std::fprintf(
+				file, "\t\t\"input_primitives\": %.2f,\n",
+				mean([](const FrameStats &s) { return s.pipeline.input_primitives; }, has_pipeline)
+			);
+			std::fprintf(
+				file, "\t\t\"vertex_invocations\": %.2f,\n",
+				mean([](const FrameStats &s) { return s.pipeline.vertex_invocations; }, has_pipeline)
+			);
+			std::fprintf(file, "\t\t\"clipping_invocations\": %.2f,\n", clipped_in);
+			std::fprintf(file, "\t\t\"clipping_primitives\": %.2f,\n", clipped_out);
+			std::fprintf(file, "\t\t\"fragment_invocations\": %.2f,\n", fragments);
+			std::fprintf(file, "\t\t\"overdraw\": %.4f,\n", pixels > 0.0 ? fragments / pixels : 0.0);
+			std::fprintf(file, "\t\t\"primitives_kept\": %.4f\n", clipped_in > 0.0 ? clipped_out / clipped_in : 0.0);
+			std::fprintf(file, "\t},\n");
+		} else {
+			std::fprintf(file, "\t\"pipeline_statistics\": null,\n");
+		}
+
+		uint64_t memory_peak = 0;
+		for (const auto &sample : _samples) {
+			memory_peak = std::max(memory_peak, sample.memory_used);
+		}
+		std::fprintf(file, "\t\"device_memory_peak\": %llu\n", static_cast<unsigned long long>(memory_peak));
+		std::fprintf(file, "}\n");
+
+		const bool failed = std::ferror(file) != 0;
+		std::fclose(file);
+		if (failed) {
+			throw std::runtime_error("Failed to write benchmark output: " + std::string(path));
+		}
+	}
+}
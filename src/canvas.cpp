@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "canvas.h"
+
+namespace VkDraw {
+	static constexpr uint32_t MAX_TEXTURE_ID = 0xffffff;
+
+	static uint64_t make_key(int32_t layer, CanvasPipeline pipeline, BlendMode blend, TextureId texture) {
+		// flipping the sign bit makes negative layers sort before positive ones
+		const uint64_t ordered_layer = static_cast<uint32_t>(layer) ^ 0x80000000u;
+		return ordered_layer << 32 | static_cast<uint64_t>(pipeline) << 28 | static_cast<uint64_t>(blend) << 24 |
+			texture;
+	}
+
+	uint32_t pack_color(Color color) {
+		return color.r | color.g << 8 | color.b << 16 | static_cast<uint32_t>(color.a) << 24;
+	}
+
+	void Canvas::begin(Allocator allocate, std::pmr::memory_resource *scratch) {
+		_allocate = std::move(allocate);
+		_scratch = scratch;
+		_recording = true;
+		_layer = 0;
+		_blend = BlendMode::ALPHA;
+		_buckets.clear();
+		_chunks.clear();
+		_last_bucket = 0;
+		_stats = {};
+	}
+
+	std::span<const CanvasChunk> Canvas::end() {
+		_recording = false;
+		_allocate = nullptr;
+		_scratch = nullptr;
+
+		std::ranges::stable_sort(_chunks, {}, &CanvasChunk::key);
+		_stats.chunks = _chunks.size();
+		return _chunks;
+	}
+
+	CanvasInstance *Canvas::push(TextureId texture, uint32_t count) {
+		if (texture > MAX_TEXTURE_ID) {
+			throw std::runtime_error("Texture id is out of range!");
+		}
+		const uint64_t key = make_key(_layer, CanvasPipeline::SHAPES, _blend, texture);
+		return reinterpret_cast<CanvasInstance *>(push_instances(key, sizeof(CanvasInstance), count));
+	}
+
+	PathBand *Canvas::push_bands(uint32_t count) {
+		const uint64_t key = make_key(_layer, CanvasPipeline::PATHS, _blend, 0);
+		return reinterpret_cast<PathBand *>(push_instances(key, sizeof(PathBand), count));
+	}
+
+	CanvasInstance *Canvas::push_glyphs(TextureId page, uint32_t count) {
+		if (page > MAX_TEXTURE_ID) {
+			throw std::runtime_error("Texture id is out of range!");
+		}
+		const uint64_t key = make_key(_layer, CanvasPipeline::TEXT, _blend, page);
+		return reinterpret_cast<CanvasInstance *>(push_instances(key, sizeof(CanvasInstance), count));
+	}
+
+	CanvasAllocation Canvas::allocate(VkDeviceSize size) {
+		if (!_recording) {
+			throw std::runtime_error("Drawing is only valid inside the frame callback!");
+		}
+		return _allocate(size);
+	}
+
+	std::byte *Canvas::push_instances(uint64_t key, uint32_t stride, uint32_t count) {
+		if (!_recording) {
+			throw std::runtime_error("Drawing is only valid inside the frame callback!");
+		}
+
+		// consecutive draws almost always share state, otherwise there are only a handful of buckets
+		if (_last_bucket >= _buckets.size() || _buckets[_last_bucket].key != key) {
+			auto it = std::ranges::find(_buckets, key, &Bucket::key);
+			if (it == _buckets.end()) {
+				_chunks.push_back(allocate_chunk(key, stride, count, FIRST_CHUNK_SIZE));
+				it = _buckets.insert(_buckets.end(), {key, static_cast<uint32_t>(_chunks.size() - 1)});
+			}
+			_last_bucket = it - _buckets.begin();
+		}
+
+		auto &bucket = _buckets[_last_bucket];
+		if (_chunks[bucket.chunk].count + count > _chunks[bucket.chunk].capacity) {
+			const uint32_t capacity = std::min(_chunks[bucket.chunk].capacity * 2, MAX_CHUNK_SIZE);
+			_chunks.push_back(allocate_chunk(key, stride, count, capacity));
+			bucket.chunk = _chunks.size() - 1;
+		}
+
+		auto &chunk = _chunks[bucket.chunk];
+		std::byte *instances = chunk.data + static_cast<size_t>(chunk.count) * stride;
+		chunk.count += count;
+		_stats.primitives += count;
+		return instances;
+	}
+
+	CanvasChunk Canvas::allocate_chunk(uint64_t key, uint32_t stride, uint32_t count, uint32_t capacity) {
+		capacity = std::max(capacity, count);
+		const auto alloc = _allocate(static_cast<VkDeviceSize>(capacity) * stride);
+		return {key, alloc.buffer, alloc.offset, alloc.data, 0, capacity};
+	}
+
+	static Canvas _frame_canvas;
+	static Canvas *_bound_canvas = &_frame_canvas;
+
+	Canvas &canvas() {
+		return *_bound_canvas;
+	}
+
+	CanvasScope::CanvasScope(Canvas &target) : _previous(_bound_canvas) {
+		_bound_canvas = &target;
+	}
+
+	CanvasScope::~CanvasScope() {
+		_bound_canvas = _previous;
+	}
+
+	void set_layer(int32_t layer) {
+		canvas().set_layer(layer);
+	}
+
+	void set_blend_mode(BlendMode mode) {
+		canvas().set_blend_mode(mode);
+	}
+
+	// instances live in write combined memory, so each one is written whole and never read back
+	static void write_box(CanvasInstance *instance, Vec2 origin, Vec2 axis_x, Vec2 axis_y, Color color) {
+		*instance = {origin, axis_x, axis_y, {0.0f, 0.0f}, {1.0f, 1.0f}, pack_color(color), -1.0f};
+	}
+
+	static void write_ellipse(CanvasInstance *instance, Vec2 center, float radius, float inner, Color color) {
+		*instance = {
+			{center.x - radius, center.y - radius}, {radius * 2.0f, 0.0f}, {0.0f, radius * 2.0f},
+			{0.0f, 0.0f}, {1.0f, 1.0f}, pack_color(color), inner
+		};
+	}
+
+	static bool write_segment(CanvasInstance *instance, Vec2 from, Vec2 to, float thickness, Color color) {
+		const Vec2 dir = {to.x - from.x, to.y - from.y};
+		const float length = std::sqrt(dir.x * dir.x + dir.y * dir.y);
+		if (length <= 0.0f) {
+			return false;
+		}
+
+		const float scale = thickness * 0.5f / length;
+		const Vec2 normal = {-dir.y * scale, dir.x * scale};
+		write_box(
+			instance, {from.x - normal.x, from.y - normal.y}, dir, {normal.x * 2.0f, normal.y * 2.0f}, color
+		);
+		return true;
+	}
+
+	void draw_line(Vec2 from, Vec2 to, float thickness, Color color) {
+		CanvasInstance segment;
+		if (write_segment(&segment, from, to, thickness, color)) {
+			*canvas().push(0) = segment;
+		}
+	}
+
+	void draw_polyline(std::span<const Vec2> points, float thickness, Color color, bool closed) {
+		if (points.size() < 2) {
+			return;
+		}
+
+		// each segment is a box and each joint a disc, which gives round joins without tessellating
+		const size_t segments = closed ? points.size() : points.size() - 1;
+		const size_t joints = closed ? points.size() : points.size() - 2;
+		CanvasInstance *instances = canvas().push(0, segments + joints);
+
+		size_t written = 0;
+		for (size_t i = 0; i < segments; i++) {
+			if (write_segment(&instances[written], points[i], points[(i + 1) % points.size()], thickness, color)) {
+				written++;
+			}
+		}
+		for (size_t i = 0; i < joints; i++) {
+			write_ellipse(&instances[written++], points[closed ? i : i + 1], thickness * 0.5f, 0.0f, color);
+		}
+
+		// degenerate segments leave unused slots, they are drawn as empty boxes
+		while (written < segments + joints) {
+			write_box(&instances[written++], points[0], {0.0f, 0.0f}, {0.0f, 0.0f}, color);
+		}
+	}
+
+	void draw_rect(Vec2 pos, Vec2 size, float thickness, Color color) {
+		// four boxes, the top and bottom edges span the full width so the corners are covered once
+		const float t = std::min({thickness, size.x * 0.5f, size.y * 0.5f});
+		CanvasInstance *instances = canvas().push(0, 4);
+		write_box(&instances[0], pos, {size.x, 0.0f}, {0.0f, t}, color);
+		write_box(&instances[1], {pos.x, pos.y + size.y - t}, {size.x, 0.0f}, {0.0f, t}, color);
+		write_box(&instances[2], {pos.x, pos.y + t}, {t, 0.0f}, {0.0f, size.y - t * 2.0f}, color);
+		write_box(&instances[3], {pos.x + size.x - t, pos.y + t}, {t, 0.0f}, {0.0f, size.y - t * 2.0f}, color);
+	}
+
+	void fill_rect(Vec2 pos, Vec2 size, Color color) {
+		write_box(canvas().push(0), pos, {size.x, 0.0f}, {0.0f, size.y}, color);
+	}
+
+	void draw_circle(Vec2 center, float radius, float thickness, Color color) {
+		// the stroke is centered on the radius
+		const float outer = radius + thickness * 0.5f;
+		if (outer <= 0.0f) {
+			return;
+		}
+		const float inner = std::max(radius - thickness * 0.5f, 0.0f) / outer;
+		write_ellipse(canvas().push(0), center, outer, inner, color);
+	}
+
+	void fill_circle(Vec2 center, float radius, Color color) {
+		write_ellipse(canvas().push(0), center, radius, 0.0f, color);
+	}
+
+	void draw_sprite(TextureId texture, Vec2 pos, Vec2 size, Color tint) {
+		draw_sprite(texture, pos, size, {0.0f, 0.0f}, {1.0f, 1.0f}, tint);
+	}
+
+	void draw_sprite(TextureId texture, Vec2 pos, Vec2 size, Vec2 uv_min, Vec2 uv_max, Color tint) {
+		*canvas().push(texture) = {pos, {size.x, 0.0f}, {0.0f, size.y}, uv_min, uv_max, pack_color(tint), -1.0f};
+	}
+}
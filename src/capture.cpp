@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <string_view>
+
+#include <SDL_image.h>
+
+#include "capture.h"
+#include "debug.h"
+#include "trace.h"
+
+namespace VkDraw {
+	SDL_Surface *captured_surface(const CapturedFrame &frame) {
+		SDL_Surface *view = SDL_CreateRGBSurfaceWithFormatFrom(
+			const_cast<uint8_t *>(frame.pixels), static_cast<int>(frame.width), static_cast<int>(frame.height), 32,
+			static_cast<int>(frame.width * 4), frame.bgra ? SDL_PIXELFORMAT_BGRA32 : SDL_PIXELFORMAT_RGBA32
+		);
+		if (view == nullptr) {
+			return nullptr;
+		}
+		SDL_Surface *copy = SDL_ConvertSurfaceFormat(view, SDL_PIXELFORMAT_RGBA32, 0);
+		SDL_FreeSurface(view);
+		return copy;
+	}
+
+	static void write_png(const CapturedFrame &frame, const std::string &path) {
+		TRACE_SCOPE("write_png");
+
+		// SDL_image converts while encoding, so the frame is wrapped rather than copied
+		SDL_Surface *view = SDL_CreateRGBSurfaceWithFormatFrom(
+			const_cast<uint8_t *>(frame.pixels), static_cast<int>(frame.width), static_cast<int>(frame.height), 32,
+			static_cast<int>(frame.width * 4), frame.bgra ? SDL_PIXELFORMAT_BGRA32 : SDL_PIXELFORMAT_RGBA32
+		);
+		if (view == nullptr) {
+			throw std::runtime_error("Failed to wrap captured frame!");
+		}
+		const int res = IMG_SavePNG(view, path.c_str());
+		SDL_FreeSurface(view);
+		if (res != 0) {
+			throw std::runtime_error("Failed to write " + path + ": " + SDL_GetError());
+		}
+	}
+
+	CaptureSink png_capture(std::string path) {
+		return [path = std::move(path)](const CapturedFrame &frame) {
+			write_png(frame, path);
+			std::printf("Capture: %s written\n", path.c_str());
+		};
+	}
+
+	// closed with the last copy of the sink holding it, which is after the frames queued for it are written
+	class CaptureFile {
+	public:
+		explicit CaptureFile(std::string path) : _path(std::move(path)) {
+			if (_file = std::fopen(_path.c_str(), "wb"); _file == nullptr) {
+				throw std::runtime_error("Failed to open " + _path + "!");
+			}
+		}
+		~CaptureFile() { std::fclose(_file); }
+
+		CaptureFile(const CaptureFile &) = delete;
+		CaptureFile &operator=(const CaptureFile &) = delete;
+
+		void write(const void *data, size_t size) {
+			if (std::fwrite(data, 1, size, _file) != size) {
+				throw std::runtime_error("Failed to write " + _path + "!");
+			}
+		}
+
+		const std::string &path() const { return _path; }
+
+	private:
+		std::string _path;
+		FILE *_file;
+	};
+
+	// video files have one size throughout, it is taken from the first frame and other sizes are skipped
+	struct VideoStream {
+		CaptureFile file;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		bool skipping = false; // a frame has been skipped since the last one written
+
+		explicit VideoStream(std::string path) : file(std::move(path)) {}
+
+		// true for the first frame, which decides the size
+		bool first(const CapturedFrame &frame) {
+			if (width == 0) {
+				width = frame.width;
+				height = frame.height;
+				return true;
+			}
+			return false;
+		}
+
+		bool accept(const CapturedFrame &frame) {
+			if (frame.width == width && frame.height == height) {
+				skipping = false;
+				return true;
+			}
+			if (!skipping) {
+				std::fprintf(
+					stderr, "Capture: skipping %ux%u frames in %s, the stream is %ux%u\n", frame.width, frame.height,
+					file.path().c_str(), width, height
+				);
+				skipping = true;
+			}
+			return false;
+		}
+	};
+
+	// full range BT.601 in 16 bit fixed point, chroma from the mean of each 2x2 block
+	static void convert_yuv420(const CapturedFrame &frame, std::vector<uint8_t> &planes) {
+		const uint32_t width = frame.width;
+		const uint32_t height = frame.height;
+		const uint32_t chroma_width = (width + 1) / 2;
+		const uint32_t chroma_height = (height + 1) / 2;
+		planes.resize(width * height + chroma_width * chroma_height * 2);
+
+		uint8_t *y_plane = planes.data();
+		uint8_t *u_plane = y_plane + width * height;
+		uint8_t *v_plane = u_plane + chroma_width * chroma_height;
+		const int r = frame.bgra ? 2 : 0;
+		const int b = frame.bgra ? 0 : 2;
+
+		for (uint32_t y = 0; y < height; y++) {
+			const uint8_t *row = frame.pixels + y * width * 4;
+			for (uint32_t x = 0; x < width; x++) {
+				const uint8_t *pixel = row + x * 4;
+				y_plane[y * width + x] = static_cast<uint8_t>(
+					(19595 * pixel[r] + 38470 * pixel[1] + 7471 * pixel[b] + 32768) >> 16
+				);
+			}
+		}
+
+		for (uint32_t cy = 0; cy < chroma_height; cy++) {
+			const uint32_t y0 = cy * 2;
+			const uint32_t y1 = std::min(y0 + 1, height - 1);
+			for (uint32_t cx = 0; cx < chroma_width; cx++) {
+				const uint32_t x0 = cx * 2;
+				const uint32_t x1 = std::min(x0 + 1, width - 1);
+
+				// sums of four, the extra two bits are shifted out with the fixed point
+				int sum[3] = {};
+				for (const uint32_t y : {y0, y1}) {
+					for (const uint32_t x : {x0, x1}) {
+						const uint8_t *pixel = frame.pixels + (y * width + x) * 4;
+						sum[0] += pixel[r];
+						sum[1] += pixel[1];
+						sum[2] += pixel[b];
+					}
+				}
+				const int u = 128 + ((-11059 * sum[0] - 21709 * sum[1] + 32768 * sum[2] + (1 << 17)) >> 18);
+				const int v = 128 + ((32768 * sum[0] - 27439 * sum[1] - 5329 * sum[2] + (1 << 17)) >> 18);
+				u_plane[cy * chroma_width + cx] = static_cast<uint8_t>(std::clamp(u, 0, 255));
+				v_plane[cy * chroma_width + cx] = static_cast<uint8_t>(std::clamp(v, 0, 255));
+			}
+		}
+	}
+
+	static CaptureSink open_y4m(const std::string &path) {
+		struct Y4mStream : VideoStream {
+			using VideoStream::VideoStream;
+			std::vector<uint8_t> planes;
+		};
+		auto stream = std::make_shared<Y4mStream>(path);
+
+		return [stream](const CapturedFrame &frame) {
+			TRACE_SCOPE("write_y4m");
+			if (stream->first(frame)) {
+				// the presentation rate isn't known up front, players assume 60 fps
+				char header[96];
+				const int length = std::snprintf(
+					header, sizeof(header), "YUV4MPEG2 W%u H%u F60:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n",
+					frame.width, frame.height
+				);
+				stream->file.write(header, length);
+			} else if (!stream->accept(frame)) {
+				return;
+			}
+
+			convert_yuv420(frame, stream->planes);
+			stream->file.write("FRAME\n", 6);
+			stream->file.write(stream->planes.data(), stream->planes.size());
+		};
+	}
+
+	static CaptureSink open_raw(const std::string &path) {
+		auto stream = std::make_shared<VideoStream>(path);
+
+		return [stream](const CapturedFrame &frame) {
+			TRACE_SCOPE("write_raw");
+			if (stream->first(frame)) {
+				std::printf(
+					"Capture: %s holds %ux%u frames, ffplay -f rawvideo -pixel_format %s -video_size %ux%u %s\n",
+					stream->file.path().c_str(), frame.width, frame.height, frame.bgra ? "bgra" : "rgba", frame.width,
+					frame.height, stream->file.path().c_str()
+				);
+			} else if (!stream->accept(frame)) {
+				return;
+			}
+			stream->file.write(frame.pixels, static_cast<size_t>(frame.width) * frame.height * 4);
+		};
+	}
+
+	CaptureSink open_capture_stream(const std::string &path) {
+		const auto slash = path.find_last_of("/\\");
+		const auto dot = path.rfind('.');
+		const bool has_extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+		const std::string_view extension = has_extension ? std::string_view(path).substr(dot) : std::string_view();
+
+		if (extension == ".y4m") {
+			return open_y4m(path);
+		}
+		if (extension == ".raw") {
+			return open_raw(path);
+		}
+
+		// capture.png becomes capture-000042.png for frame 42
+		const std::string stem = has_extension ? path.substr(0, dot) : path;
+		const std::string suffix = has_extension ? std::string(extension) : ".png";
+		return [stem, suffix](const CapturedFrame &frame) {
+			char number[32];
+			std::snprintf(number, sizeof(number), "-%06llu", static_cast<unsigned long long>(frame.number));
+			write_png(frame, stem + number + suffix);
+		};
+	}
+
+	void FrameCapture::init(const DeviceCapabilities &caps, uint32_t frames) {
+		_caps = &caps;
+		_slots = std::vector<Slot>(frames + 2);
+		_writer = std::make_unique<ThreadPool>(1);
+		_writer->submit([] { set_trace_thread_name("capture"); });
+	}
+
+	void FrameCapture::destroy(VkDevice device) {
+		// collected in presentation order, so streams stay in order
+		std::vector<const Slot *> pending;
+		for (const auto &slot : _slots) {
+			if (slot.frame != NO_FRAME) {
+				pending.push_back(&slot);
+			}
+		}
+		std::ranges::sort(pending, {}, [](const Slot *slot) { return slot->image.number; });
+		for (const auto *slot : pending) {
+			collect(device, slot->frame);
+		}
+
+		// joining the writer drains its queue
+		_writer.reset();
+		for (auto &slot : _slots) {
+			release(device, slot);
+		}
+		_slots.clear();
+		_next.clear();
+		_stream = nullptr;
+
+		if (_dropped > 0) {
+			std::printf("Capture: %u frame/s dropped while the writer was behind\n", _dropped);
+		}
+	}
+
+	bool FrameCapture::supported(VkFormat format) {
+		switch (format) {
+			case VK_FORMAT_B8G8R8A8_SRGB:
+			case VK_FORMAT_B8G8R8A8_UNORM:
+			case VK_FORMAT_R8G8B8A8_SRGB:
+			case VK_FORMAT_R8G8B8A8_UNORM:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	void FrameCapture::allocate(VkDevice device, Slot &slot, VkDeviceSize size) {
+		VkBufferCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		info.size = size;
+		info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if (vkCreateBuffer(device, &info, nullptr, &slot.buffer) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create capture buffer!");
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(device, slot.buffer, &requirements);
+
+		// reading uncached memory from the CPU is slow, so cached memory is preferred even if it isn't coherent
+		const uint32_t type = _caps->find_memory_type(requirements.memoryTypeBits, {
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		});
+		slot.coherent = _caps->memory.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+		VkMemoryAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		alloc_info.allocationSize = requirements.size;
+		alloc_info.memoryTypeIndex = type;
+
+		if (vkAllocateMemory(device, &alloc_info, nullptr, &slot.memory) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to allocate capture buffer memory!");
+		}
+		vkBindBufferMemory(device, slot.buffer, slot.memory, 0);
+		vkMapMemory(device, slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mapped);
+		slot.size = size;
+
+		const auto index = static_cast<uint32_t>(&slot - _slots.data());
+		set_debug_name(device, slot.buffer, "capture buffer %u", index);
+		set_debug_name(device, slot.memory, "capture buffer %u memory", index);
+	}
+
+	void FrameCapture::release(VkDevice device, Slot &slot) {
+		if (slot.buffer == VK_NULL_HANDLE) {
+			return;
+		}
+		vkUnmapMemory(device, slot.memory);
+		vkDestroyBuffer(device, slot.buffer, nullptr);
+		vkFreeMemory(device, slot.memory, nullptr);
+		slot.buffer = VK_NULL_HANDLE;
+		slot.memory = VK_NULL_HANDLE;
+		slot.mapped = nullptr;
+		slot.size = 0;
+	}
+
+	bool FrameCapture::record(
+		VkDevice device, VkCommandBuffer cmd, uint32_t frame, VkImage image, VkExtent2D extent, VkFormat format,
+		uint64_t number
+	) {
+		if (!supported(format) || _slots.empty()) {
+			return false;
+		}
+
+		const auto free = std::ranges::find_if(_slots, [](const Slot &slot) {
+			return slot.frame == NO_FRAME && !slot.writing.load(std::memory_order_acquire);
+		});
+		if (free == _slots.end()) {
+			// a screenshot waits for the next frame, a stream loses this one
+			if (_stream) {
+				_dropped++;
+			}
+			return false;
+		}
+		Slot &slot = *free;
+
+		// buffers only grow, so a resize costs one reallocation per buffer
+		const VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+		if (slot.size < size) {
+			release(device, slot);
+			allocate(device, slot, size);
+		}
+
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.layerCount = 1;
+		vkCmdPipelineBarrier(
+			cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+			0, nullptr, 0, nullptr, 1, &barrier
+		);
+
+		VkBufferImageCopy region{};
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = {extent.width, extent.height, 1};
+		vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &region);
+
+		// back to presentable, and the copy made visible to the host once the fence signals
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = 0;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+		VkBufferMemoryBarrier host_barrier{};
+		host_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		host_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		host_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		host_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		host_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		host_barrier.buffer = slot.buffer;
+		host_barrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(
+			cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+			0, nullptr, 1, &host_barrier, 1, &barrier
+		);
+
+		const bool bgra = format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_B8G8R8A8_UNORM;
+		slot.frame = frame;
+		slot.image = {static_cast<const uint8_t *>(slot.mapped), extent.width, extent.height, bgra, number};
+		slot.sinks = std::move(_next);
+		_next.clear();
+		if (_stream) {
+			slot.sinks.push_back(_stream);
+		}
+		return true;
+	}
+
+	void FrameCapture::collect(VkDevice device, uint32_t frame) {
+		for (auto &slot : _slots) {
+			if (slot.frame != frame) {
+				continue;
+			}
+			slot.frame = NO_FRAME;
+
+			if (!slot.coherent) {
+				VkMappedMemoryRange range{};
+				range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+				range.memory = slot.memory;
+				range.size = VK_WHOLE_SIZE;
+				vkInvalidateMappedMemoryRanges(device, 1, &range);
+			}
+
+			slot.writing.store(true, std::memory_order_relaxed);
+			_writer->submit([&slot] {
+				for (const auto &sink : slot.sinks) {
+					try {
+						sink(slot.image);
+					} catch (const std::exception &e) {
+						std::fprintf(stderr, "Capture: %s\n", e.what());
+					}
+				}
+				slot.sinks.clear();
+				slot.writing.store(false, std::memory_order_release);
+			});
+		}
+	}
+}
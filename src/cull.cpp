@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "cull.h"
+#include "trace.h"
+
+namespace VkDraw {
+	// each range has enough spheres to be worth waking a worker for
+	static constexpr uint32_t CULL_GRAIN = 16384;
+
+	Frustum extract_frustum(const glm::mat4 &view_proj) {
+		// rows of the column major matrix, clip space x, y and w, depth is z from 0 to w
+		const auto row = [&view_proj](int i) {
+			return glm::vec4(view_proj[0][i], view_proj[1][i], view_proj[2][i], view_proj[3][i]);
+		};
+		const auto r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+		Frustum frustum;
+		frustum.planes = {r3 + r0, r3 - r0, r3 + r1, r3 - r1, r2, r3 - r2};
+		for (auto &plane : frustum.planes) {
+			plane = plane / std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		}
+		return frustum;
+	}
+
+	void BoundingSpheres::resize(size_t count) {
+		x.resize(count);
+		y.resize(count);
+		z.resize(count);
+		radius.resize(count);
+	}
+
+	uint32_t cull_spheres(
+		const Frustum &frustum, const BoundingSpheres &spheres, uint32_t begin, uint32_t end, uint32_t *visible
+	) {
+		const auto &planes = frustum.planes;
+		uint32_t count = 0;
+		uint32_t i = begin;
+
+		// a sphere is kept unless its center is further than its radius outside any plane, a lane per sphere
+		// and a bit per lane in the mask of those kept
+#if defined(__AVX__)
+		for (; i + 8 <= end; i += 8) {
+			const __m256 x = _mm256_loadu_ps(&spheres.x[i]);
+			const __m256 y = _mm256_loadu_ps(&spheres.y[i]);
+			const __m256 z = _mm256_loadu_ps(&spheres.z[i]);
+			const __m256 neg_radius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (const auto &plane : planes) {
+				__m256 distance = _mm256_mul_ps(_mm256_set1_ps(plane.x), x);
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.y), y));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.z), z));
+				distance = _mm256_add_ps(distance, _mm256_set1_ps(plane.w));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, neg_radius, _CMP_GE_OQ));
+			}
+			for (auto mask = static_cast<uint32_t>(_mm256_movemask_ps(inside)); mask != 0; mask &= mask - 1) {
+				visible[count++] = i + std::countr_zero(mask);
+			}
+		}
+#elif defined(__SSE2__)
+		for (; i + 4 <= end; i += 4) {
+			const __m128 x = _mm_loadu_ps(&spheres.x[i]);
+			const __m128 y = _mm_loadu_ps(&spheres.y[i]);
+			const __m128 z = _mm_loadu_ps(&spheres.z[i]);
+			const __m128 neg_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const auto &plane : planes) {
+				__m128 distance = _mm_mul_ps(_mm_set1_ps(plane.x), x);
+				distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.y), y));
+				distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.z), z));
+				distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, neg_radius));
+			}
+			for (auto mask = static_cast<uint32_t>(_mm_movemask_ps(inside)); mask != 0; mask &= mask - 1) {
+				visible[count++] = i + std::countr_zero(mask);
+			}
+		}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+		for (; i + 4 <= end; i += 4) {
+			const float32x4_t x = vld1q_f32(&spheres.x[i]);
+			const float32x4_t y = vld1q_f32(&spheres.y[i]);
+			const float32x4_t z = vld1q_f32(&spheres.z[i]);
+			const float32x4_t neg_radius = vnegq_f32(vld1q_f32(&spheres.radius[i]));
+			uint32x4_t inside = vdupq_n_u32(~0u);
+			for (const auto &plane : planes) {
+				float32x4_t distance = vdupq_n_f32(plane.w);
+				distance = vmlaq_n_f32(distance, x, plane.x);
+				distance = vmlaq_n_f32(distance, y, plane.y);
+				distance = vmlaq_n_f32(distance, z, plane.z);
+				inside = vandq_u32(inside, vcgeq_f32(distance, neg_radius));
+			}
+			const uint32x4_t bits = {1, 2, 4, 8};
+			for (uint32_t mask = vaddvq_u32(vandq_u32(inside, bits)); mask != 0; mask &= mask - 1) {
+				visible[count++] = i + std::countr_zero(mask);
+			}
+		}
+#endif
+		for (; i < end; i++) {
+			bool inside = true;
+			for (const auto &plane : planes) {
+				const float distance =
+					plane.x * spheres.x[i] + plane.y * spheres.y[i] + plane.z * spheres.z[i] + plane.w;
+				inside &= distance >= -spheres.radius[i];
+			}
+			if (inside) {
+				visible[count++] = i;
+			}
+		}
+
+		return count;
+	}
+
+	void cull_spheres(
+		const Frustum &frustum, const BoundingSpheres &spheres, ThreadPool &pool, std::vector<uint32_t> &visible,
+		std::vector<uint32_t> &scratch
+	) {
+		TRACE_SCOPE("cull_spheres");
+		const auto count = static_cast<uint32_t>(spheres.size());
+		visible.resize(count);
+
+		// each range fills the start of its own slice, which are then packed down in order, scratch holds the
+		// first index and the number found of each range
+		const uint32_t chunks = pool.size() + 1;
+		scratch.assign(chunks * 2, 0);
+		parallel_for(pool, count, CULL_GRAIN, [&](uint32_t chunk, uint32_t begin, uint32_t end) {
+			scratch[chunk * 2] = begin;
+			scratch[chunk * 2 + 1] = cull_spheres(frustum, spheres, begin, end, visible.data() + begin);
+		});
+
+		uint32_t total = 0;
+		for (uint32_t chunk = 0; chunk < chunks; chunk++) {
+			const auto first = visible.begin() + scratch[chunk * 2];
+			const uint32_t found = scratch[chunk * 2 + 1];
+			std::copy(first, first + found, visible.begin() + total);
+			total += found;
+		}
+		visible.resize(total);
+	}
+}
@@ -0,0 +1,61 @@
+#ifndef NDEBUG
+#include <cstdarg>
+#include <cstdio>
+
+#include "debug.h"
+
+namespace VkDraw {
+	static PFN_vkSetDebugUtilsObjectNameEXT _set_object_name = nullptr;
+	static PFN_vkCmdBeginDebugUtilsLabelEXT _begin_label = nullptr;
+	static PFN_vkCmdEndDebugUtilsLabelEXT _end_label = nullptr;
+
+	void init_debug_utils(VkInstance instance) {
+		_set_object_name = reinterpret_cast<PFN_vkSetDebugUtilsObjectNameEXT>(
+			vkGetInstanceProcAddr(instance, "vkSetDebugUtilsObjectNameEXT")
+		);
+		_begin_label = reinterpret_cast<PFN_vkCmdBeginDebugUtilsLabelEXT>(
+			vkGetInstanceProcAddr(instance, "vkCmdBeginDebugUtilsLabelEXT")
+		);
+		_end_label = reinterpret_cast<PFN_vkCmdEndDebugUtilsLabelEXT>(
+			vkGetInstanceProcAddr(instance, "vkCmdEndDebugUtilsLabelEXT")
+		);
+	}
+
+	void set_debug_name(VkDevice device, VkObjectType type, uint64_t handle, const char *format, ...) {
+		if (_set_object_name == nullptr || handle == 0) {
+			return;
+		}
+
+		char name[128];
+		va_list args;
+		va_start(args, format);
+		std::vsnprintf(name, sizeof(name), format, args);
+		va_end(args);
+
+		VkDebugUtilsObjectNameInfoEXT info{};
+		info.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+		info.objectType = type;
+		info.objectHandle = handle;
+		info.pObjectName = name;
+		_set_object_name(device, &info);
+	}
+
+	void begin_debug_label(VkCommandBuffer cmd, const char *name) {
+		if (_begin_label == nullptr) {
+			return;
+		}
+
+		VkDebugUtilsLabelEXT label{};
+		label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+		label.pLabelName = name;
+		_begin_label(cmd, &label);
+	}
+
+	void end_debug_label(VkCommandBuffer cmd) {
+		if (_end_label == nullptr) {
+			return;
+		}
+		_end_label(cmd);
+	}
+}
+#endif
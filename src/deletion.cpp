@@ -0,0 +1,72 @@
+#include <stdexcept>
+
+#include "deletion.h"
+
+namespace VkDraw {
+	template <typename T>
+	static T from_handle(uint64_t handle) {
+		if constexpr (std::is_pointer_v<T>) {
+			return reinterpret_cast<T>(handle);
+		} else {
+			return static_cast<T>(handle);
+		}
+	}
+
+	static void destroy(VkDevice device, VkObjectType type, uint64_t handle) {
+		switch (type) {
+			case VK_OBJECT_TYPE_BUFFER:
+				vkDestroyBuffer(device, from_handle<VkBuffer>(handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_IMAGE:
+				vkDestroyImage(device, from_handle<VkImage>(handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_IMAGE_VIEW:
+				vkDestroyImageView(device, from_handle<VkImageView>(handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_DEVICE_MEMORY:
+				vkFreeMemory(device, from_handle<VkDeviceMemory>(handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_FRAMEBUFFER:
+				vkDestroyFramebuffer(device, from_handle<VkFramebuffer>(handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_SWAPCHAIN_KHR:
+				vkDestroySwapchainKHR(device, from_handle<VkSwapchainKHR>(handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_PIPELINE:
+				vkDestroyPipeline(device, from_handle<VkPipeline>(handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_RENDER_PASS:
+				vkDestroyRenderPass(device, from_handle<VkRenderPass>(handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_SAMPLER:
+				vkDestroySampler(device, from_handle<VkSampler>(handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+				vkDestroyDescriptorPool(device, from_handle<VkDescriptorPool>(handle), nullptr);
+				break;
+			default:
+				throw std::runtime_error("Unsupported object type in deletion queue!");
+		}
+	}
+
+	void DeletionQueue::push(uint64_t last_frame, VkObjectType type, uint64_t handle) {
+		if (!_entries.empty() && last_frame < _entries.back().last_frame) {
+			last_frame = _entries.back().last_frame; // keep the queue sorted, destroying later is always safe
+		}
+		_entries.push_back({last_frame, type, handle});
+	}
+
+	void DeletionQueue::collect(VkDevice device, uint64_t completed_frames) {
+		while (!_entries.empty() && _entries.front().last_frame < completed_frames) {
+			destroy(device, _entries.front().type, _entries.front().handle);
+			_entries.pop_front();
+		}
+	}
+
+	void DeletionQueue::flush(VkDevice device) {
+		for (const auto &entry : _entries) {
+			destroy(device, entry.type, entry.handle);
+		}
+		_entries.clear();
+	}
+}
@@ -0,0 +1,164 @@
+#include <charconv>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+#include "device.h"
+
+namespace VkDraw {
+	// contiguous runs of core formats, later versions promoted formats with sparse extension values
+	struct FormatRange {
+		VkFormat first;
+		VkFormat last;
+		uint32_t version; // formats are only queried on devices that know them
+	};
+
+	static constexpr FormatRange FORMAT_RANGES[] = {
+		{VK_FORMAT_UNDEFINED, VK_FORMAT_ASTC_12x12_SRGB_BLOCK, VK_API_VERSION_1_0},
+		{VK_FORMAT_G8B8G8R8_422_UNORM, VK_FORMAT_G16_B16_R16_3PLANE_444_UNORM, VK_API_VERSION_1_1},
+		{VK_FORMAT_G8_B8R8_2PLANE_444_UNORM, VK_FORMAT_G16_B16R16_2PLANE_444_UNORM, VK_API_VERSION_1_3},
+		{VK_FORMAT_A4R4G4B4_UNORM_PACK16, VK_FORMAT_A4B4G4R4_UNORM_PACK16, VK_API_VERSION_1_3},
+		{VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK, VK_FORMAT_ASTC_12x12_SFLOAT_BLOCK, VK_API_VERSION_1_3},
+	};
+
+	const VkFormatProperties &DeviceCapabilities::format(VkFormat format) const {
+		static constexpr VkFormatProperties unsupported{};
+
+		// formats holds every range back to back
+		size_t base = 0;
+		for (const auto &range : FORMAT_RANGES) {
+			if (format >= range.first && format <= range.last) {
+				const size_t index = base + (format - range.first);
+				return index < formats.size() ? formats[index] : unsupported;
+			}
+			base += range.last - range.first + 1;
+		}
+		return unsupported;
+	}
+
+	bool DeviceCapabilities::has_extension(const char *name) const {
+		for (const auto &extension : extensions) {
+			if (strcmp(extension.extensionName, name) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static std::optional<uint32_t> match_memory_type(
+		const VkPhysicalDeviceMemoryProperties &memory, const uint32_t filter, const VkMemoryPropertyFlags flags
+	) {
+		for (uint32_t i = 0; i < memory.memoryTypeCount; i++) {
+			if (filter & (1 << i) && (memory.memoryTypes[i].propertyFlags & flags) == flags) {
+				return i;
+			}
+		}
+		return std::nullopt;
+	}
+
+	uint32_t DeviceCapabilities::find_memory_type(const uint32_t filter, const VkMemoryPropertyFlags flags) const {
+		if (const auto type = match_memory_type(memory, filter, flags)) {
+			return *type;
+		}
+
+		throw std::runtime_error("Failed to find suitable memory type!");
+	}
+
+	uint32_t DeviceCapabilities::find_memory_type(
+		const uint32_t filter, std::initializer_list<VkMemoryPropertyFlags> preferences
+	) const {
+		for (const auto flags : preferences) {
+			if (const auto type = match_memory_type(memory, filter, flags)) {
+				return *type;
+			}
+		}
+
+		throw std::runtime_error("Failed to find suitable memory type!");
+	}
+
+	VkFormat DeviceCapabilities::find_supported_format(
+		std::initializer_list<VkFormat> candidates, VkImageTiling tiling, VkFormatFeatureFlags features
+	) const {
+		for (const auto candidate : candidates) {
+			const auto &props = format(candidate);
+
+			if (tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features) {
+				return candidate;
+			}
+			if (tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features) {
+				return candidate;
+			}
+		}
+
+		throw std::runtime_error("Failed to find supported format!");
+	}
+
+	DeviceCapabilities query_device_capabilities(VkPhysicalDevice device) {
+		DeviceCapabilities caps;
+
+		vkGetPhysicalDeviceProperties(device, &caps.properties);
+		vkGetPhysicalDeviceMemoryProperties(device, &caps.memory);
+
+		// only chain the feature structs the device version knows about
+		{
+			const auto version = caps.properties.apiVersion;
+
+			VkPhysicalDeviceFeatures2 features{};
+			features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			caps.features11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+			caps.features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+			caps.features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+			// the per-version aggregate structs only exist from 1.2, 1.1 devices query the core features alone
+			if (version >= VK_API_VERSION_1_2) {
+				features.pNext = &caps.features11;
+				caps.features11.pNext = &caps.features12;
+			}
+			if (version >= VK_API_VERSION_1_3) {
+				caps.features12.pNext = &caps.features13;
+			}
+
+			if (version >= VK_API_VERSION_1_1) {
+				vkGetPhysicalDeviceFeatures2(device, &features);
+			} else {
+				vkGetPhysicalDeviceFeatures(device, &features.features);
+			}
+			caps.features = features.features;
+
+			// the chain points into this object, don't let copies carry it around
+			caps.features11.pNext = nullptr;
+			caps.features12.pNext = nullptr;
+			caps.features13.pNext = nullptr;
+		}
+
+		uint32_t count;
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &count, nullptr);
+		caps.extensions.resize(count);
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &count, caps.extensions.data());
+
+		// ranges newer than the device stay zeroed, which reads as unsupported
+		for (const auto &range : FORMAT_RANGES) {
+			for (uint32_t i = range.first; i <= static_cast<uint32_t>(range.last); i++) {
+				auto &props = caps.formats.emplace_back();
+				if (caps.properties.apiVersion >= range.version) {
+					vkGetPhysicalDeviceFormatProperties(device, static_cast<VkFormat>(i), &props);
+				}
+			}
+		}
+
+		return caps;
+	}
+
+	bool device_matches(std::string_view selector, uint32_t index, std::string_view name) {
+		if (selector.empty()) {
+			return false;
+		}
+		// numbers too large for an index can still be part of a name
+		uint32_t selected;
+		const auto res = std::from_chars(selector.data(), selector.data() + selector.size(), selected);
+		if (res.ec == std::errc{} && res.ptr == selector.data() + selector.size() && selected == index) {
+			return true;
+		}
+		return name.contains(selector);
+	}
+}
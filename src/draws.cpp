@@ -0,0 +1,56 @@
+#include "draws.h"
+#include "trace.h"
+
+namespace VkDraw {
+	static constexpr uint32_t RADIX = 1u << SORT_RADIX_BITS;
+	// below this a draw list is sorted by the calling thread alone
+	static constexpr uint32_t SORT_GRAIN = 32768;
+
+	void sort_draws(std::vector<DrawItem> &draws, DrawSortScratch &scratch, ThreadPool &pool) {
+		TRACE_SCOPE("sort_draws");
+		const auto count = static_cast<uint32_t>(draws.size());
+		auto &sorted = scratch.draws;
+		sorted.resize(count);
+
+		// parallel_for splits the same count the same way every time, so a range counts and then scatters the
+		// very draws it counted
+		auto &histograms = scratch.histograms;
+		histograms.resize(pool.size() + 1);
+		for (uint32_t shift = 0; shift < 64; shift += SORT_RADIX_BITS) {
+			for (auto &histogram : histograms) {
+				histogram.fill(0);
+			}
+			parallel_for(pool, count, SORT_GRAIN, [&](uint32_t chunk, uint32_t begin, uint32_t end) {
+				auto &histogram = histograms[chunk];
+				for (uint32_t i = begin; i < end; i++) {
+					histogram[(draws[i].key >> shift) & (RADIX - 1)]++;
+				}
+			});
+
+			// each range's first slot for each digit, ranges in order within a digit keep the sort stable
+			uint32_t total = 0;
+			bool shared = false;
+			for (uint32_t digit = 0; digit < RADIX; digit++) {
+				uint32_t digit_count = 0;
+				for (auto &histogram : histograms) {
+					const uint32_t n = histogram[digit];
+					histogram[digit] = total;
+					total += n;
+					digit_count += n;
+				}
+				shared |= digit_count == count;
+			}
+			if (shared) {
+				continue;
+			}
+
+			parallel_for(pool, count, SORT_GRAIN, [&](uint32_t chunk, uint32_t begin, uint32_t end) {
+				auto &offsets = histograms[chunk];
+				for (uint32_t i = begin; i < end; i++) {
+					sorted[offsets[(draws[i].key >> shift) & (RADIX - 1)]++] = draws[i];
+				}
+			});
+			draws.swap(sorted);
+		}
+	}
+}
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include <SDL_image.h>
+
+#include "golden.h"
+
+namespace VkDraw {
+	// the largest squared distance rgb_delta can return, between black and white
+	static constexpr double MAX_YIQ_DELTA = 35215.0;
+
+	static double yiq_y(double r, double g, double b) {
+		return r * 0.29889531 + g * 0.58662247 + b * 0.11448223;
+	}
+
+	static double yiq_i(double r, double g, double b) {
+		return r * 0.59597799 - g * 0.27417610 - b * 0.32180189;
+	}
+
+	static double yiq_q(double r, double g, double b) {
+		return r * 0.21147017 - g * 0.52261711 + b * 0.31114694;
+	}
+
+	// weighted YIQ distance (Kotsarenko and Ramos), closer to perceived difference than RGB distance
+	static double rgb_delta(const uint8_t *a, const uint8_t *b) {
+		const double r1 = a[0], g1 = a[1], b1 = a[2];
+		const double r2 = b[0], g2 = b[1], b2 = b[2];
+
+		const double y = yiq_y(r1, g1, b1) - yiq_y(r2, g2, b2);
+		const double i = yiq_i(r1, g1, b1) - yiq_i(r2, g2, b2);
+		const double q = yiq_q(r1, g1, b1) - yiq_q(r2, g2, b2);
+		return 0.5053 * y * y + 0.299 * i * i + 0.1957 * q * q;
+	}
+
+	GoldenResult compare_images(const SDL_Surface &expected, const SDL_Surface &actual, SDL_Surface *diff) {
+		GoldenResult result{};
+		result.size_matches = expected.w == actual.w && expected.h == actual.h;
+		if (!result.size_matches) {
+			return result;
+		}
+		result.pixels = static_cast<uint64_t>(expected.w) * expected.h;
+
+		// thresholds compare squared distances, so the fraction is squared too
+		const double threshold = MAX_YIQ_DELTA * GOLDEN_THRESHOLD * GOLDEN_THRESHOLD;
+		for (int y = 0; y < expected.h; y++) {
+			const auto *expected_row = static_cast<const uint8_t *>(expected.pixels) + y * expected.pitch;
+			const auto *actual_row = static_cast<const uint8_t *>(actual.pixels) + y * actual.pitch;
+			auto *diff_row = diff != nullptr ? static_cast<uint8_t *>(diff->pixels) + y * diff->pitch : nullptr;
+
+			for (int x = 0; x < expected.w; x++) {
+				const uint8_t *a = expected_row + x * 4;
+				const uint8_t *b = actual_row + x * 4;
+				const double delta = rgb_delta(a, b);
+				result.max_delta = std::max(result.max_delta, delta);
+
+				const bool mismatch = delta > threshold;
+				if (mismatch) {
+					result.mismatched++;
+				}
+
+				if (diff_row != nullptr) {
+					uint8_t *out = diff_row + x * 4;
+					if (mismatch) {
+						out[0] = 255;
+						out[1] = 0;
+						out[2] = 0;
+					} else {
+						// faded grayscale, so the red stands out against any scene
+						const auto gray = static_cast<uint8_t>(255.0 - (255.0 - yiq_y(a[0], a[1], a[2])) * 0.1);
+						out[0] = gray;
+						out[1] = gray;
+						out[2] = gray;
+					}
+					out[3] = 255;
+				}
+			}
+		}
+
+		result.max_delta = std::sqrt(result.max_delta / MAX_YIQ_DELTA);
+		return result;
+	}
+
+	static void save_png(SDL_Surface &surface, const std::string &path) {
+		if (IMG_SavePNG(&surface, path.c_str()) != 0) {
+			throw std::runtime_error("Failed to write " + path + ": " + SDL_GetError());
+		}
+	}
+
+	GoldenResult check_golden(const char *path, SDL_Surface &actual) {
+		SDL_Surface *loaded = IMG_Load(path);
+		if (loaded == nullptr) {
+			throw std::runtime_error(
+				"Failed to load golden image " + std::string(path) + ", create it with --golden-update"
+			);
+		}
+		SDL_Surface *expected = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+		SDL_FreeSurface(loaded);
+		if (expected == nullptr) {
+			throw std::runtime_error("Failed to convert golden image!");
+		}
+
+		SDL_Surface *diff = SDL_CreateRGBSurfaceWithFormat(0, expected->w, expected->h, 32, SDL_PIXELFORMAT_RGBA32);
+		if (diff == nullptr) {
+			SDL_FreeSurface(expected);
+			throw std::runtime_error("Failed to create diff image!");
+		}
+
+		const auto result = compare_images(*expected, actual, diff);
+		SDL_FreeSurface(expected);
+
+		try {
+			if (!result.passed()) {
+				save_png(actual, std::string(path) + ".actual.png");
+				if (result.size_matches) {
+					save_png(*diff, std::string(path) + ".diff.png");
+				}
+			}
+		} catch (...) {
+			SDL_FreeSurface(diff);
+			throw;
+		}
+		SDL_FreeSurface(diff);
+		return result;
+	}
+
+	void update_golden(const char *path, SDL_Surface &actual) {
+		save_png(actual, path);
+	}
+}
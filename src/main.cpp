@@ -1,14 +1,84 @@
+#include <array>
+#include <cmath>
 #include <cstdio>
 #include <vector>
 
 #include "app.h"
 
+// a small scene exercising each of the 2D primitives
+static void draw_demo(float delta) {
+	using namespace VkDraw;
+
+	static float time = 0.0f;
+	time += delta;
+
+	const auto [width, height] = screen_size();
+	const TextureId texture = load_texture("textures/texture.png");
+
+	draw_sprite(texture, {width - 192.0f, 32.0f}, {160.0f, 160.0f});
+	draw_rect({24.0f, 24.0f}, {width - 48.0f, height - 48.0f}, 2.0f, {200, 200, 200});
+
+	for (int i = 0; i < 12; i++) {
+		const float angle = time + static_cast<float>(i) * 0.5236f;
+		const Vec2 center = {160.0f, 160.0f};
+		const Vec2 tip = {center.x + std::cos(angle) * 96.0f, center.y + std::sin(angle) * 96.0f};
+		draw_line(center, tip, 3.0f, {255, static_cast<uint8_t>(i * 20), 64});
+	}
+
+	std::array<Vec2, 64> wave{};
+	for (size_t i = 0; i < wave.size(); i++) {
+		const float x = static_cast<float>(i) / static_cast<float>(wave.size() - 1);
+		wave[i] = {48.0f + x * (width - 96.0f), height - 120.0f + std::sin(x * 12.0f + time * 2.0f) * 48.0f};
+	}
+	draw_polyline(wave, 4.0f, {64, 160, 255});
+
+	set_blend_mode(BlendMode::ADDITIVE);
+	constexpr std::array<Color, 3> colors = {Color{255, 0, 0, 160}, Color{0, 255, 0, 160}, Color{0, 0, 255, 160}};
+	for (size_t i = 0; i < colors.size(); i++) {
+		const float angle = time + static_cast<float>(i) * 2.094f;
+		const Vec2 center = {width * 0.5f + std::cos(angle) * 64.0f, height * 0.5f + std::sin(angle) * 64.0f};
+		fill_circle(center, 96.0f, colors[i]);
+	}
+	set_blend_mode(BlendMode::ALPHA);
+	draw_circle({width * 0.5f, height * 0.5f}, 200.0f, 6.0f, {255, 255, 255, 200});
+
+	// a self intersecting star shows the fill rules, the curve shows joins and caps
+	Path star;
+	for (int i = 0; i < 5; i++) {
+		const float angle = time * 0.5f + static_cast<float>(i * 2) * 1.2566f;
+		const Vec2 point = {width - 160.0f + std::cos(angle) * 96.0f, height * 0.5f + std::sin(angle) * 96.0f};
+		if (i == 0) {
+			star.move_to(point);
+		} else {
+			star.line_to(point);
+		}
+	}
+	star.close();
+	fill_path(star, {255, 200, 0}, FillRule::EVEN_ODD);
+	stroke_path(star, {.width = 4.0f, .join = LineJoin::ROUND}, {120, 60, 0});
+
+	Path curve;
+	curve.move_to({64.0f, height * 0.5f})
+		.cubic_to({128.0f, height * 0.5f - 160.0f}, {224.0f, height * 0.5f + 160.0f}, {288.0f, height * 0.5f})
+		.arc({288.0f, height * 0.5f + 48.0f}, 48.0f, -1.5708f, 1.5708f);
+	stroke_path(curve, {.width = 10.0f, .cap = LineCap::ROUND}, {64, 220, 128});
+
+	if (const auto font = default_font()) {
+		draw_text(*font, {40.0f, 40.0f}, 32.0f, "VkDraw", {255, 255, 255});
+		for (int i = 0; i < 4; i++) {
+			const float size = 12.0f + static_cast<float>(i) * 6.0f;
+			const Vec2 pos = {40.0f, 280.0f + static_cast<float>(i) * 36.0f};
+			draw_text(*font, pos, size, "Signed distance field text", {200, 220, 255});
+		}
+	}
+}
+
 int main(const int argc, char **argv) {
 	std::vector<std::string_view> args(argv, argv + argc);
 	int res = EXIT_SUCCESS;
 
 	try {
-		res = VkDraw::run(args);
+		res = VkDraw::run(args, draw_demo);
 	} catch (std::exception &e) {
 		std::fflush(stdout);
 		std::fprintf(stderr, "Unhandled exception: %s\n", e.what());
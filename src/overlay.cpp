@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "overlay.h"
+
+namespace VkDraw {
+	static constexpr float PADDING = 8.0f;
+	static constexpr float BAR_WIDTH = 1.5f; // pixels per frame of history
+	static constexpr float GRAPH_WIDTH = PerfOverlay::HISTORY * BAR_WIDTH;
+	static constexpr float GRAPH_HEIGHT = 64.0f;
+	static constexpr float GRAPH_MS = 100.0f / 3.0f; // the top of the graphs, longer frames are clipped
+	static constexpr float BUDGET_MS = 50.0f / 3.0f; // 60 fps
+	static constexpr float PASS_BAR_HEIGHT = 8.0f;
+	static constexpr float TEXT_SIZE = 14.0f;
+	static constexpr float LINE_HEIGHT = 18.0f;
+
+	static constexpr std::array<Color, GPU_PASS_COUNT> PASS_COLORS = {
+		Color{160, 160, 160}, Color{80, 160, 255}, Color{255, 160, 64}, Color{200, 96, 255}
+	};
+
+	// green within the 60 fps budget, yellow within 30 fps, red beyond
+	static Color budget_color(float ms) {
+		if (ms <= BUDGET_MS) {
+			return {96, 220, 96};
+		}
+		if (ms <= GRAPH_MS) {
+			return {240, 200, 64};
+		}
+		return {255, 64, 64};
+	}
+
+	static void draw_graph(Vec2 pos, const std::array<float, PerfOverlay::HISTORY> &samples, size_t oldest) {
+		fill_rect(pos, {GRAPH_WIDTH, GRAPH_HEIGHT}, {0, 0, 0, 160});
+
+		for (size_t i = 0; i < samples.size(); i++) {
+			const float ms = samples[(oldest + i) % samples.size()];
+			if (ms <= 0.0f) {
+				continue;
+			}
+			const float height = std::min(ms / GRAPH_MS, 1.0f) * GRAPH_HEIGHT;
+			const Vec2 bar = {pos.x + static_cast<float>(i) * BAR_WIDTH, pos.y + GRAPH_HEIGHT - height};
+			fill_rect(bar, {BAR_WIDTH, height}, budget_color(ms));
+		}
+
+		const float budget_y = pos.y + GRAPH_HEIGHT * (1.0f - BUDGET_MS / GRAPH_MS);
+		fill_rect({pos.x, budget_y}, {GRAPH_WIDTH, 1.0f}, {255, 255, 255, 96});
+	}
+
+	void PerfOverlay::record(const FrameStats &stats) {
+		_cpu_ms[_next] = static_cast<float>(stats.cpu_ms);
+		_gpu_ms[_next] = stats.gpu.valid ? static_cast<float>(stats.gpu.total_ms) : 0.0f;
+		_next = (_next + 1) % HISTORY;
+		_latest = stats;
+	}
+
+	void PerfOverlay::draw(std::optional<FontId> font) const {
+		const auto &stats = _latest;
+		// the last line's spacing is trimmed to one padding before the bar
+		float labels_height = 0.0f;
+		if (font.has_value()) {
+			const uint32_t lines = 4 + (stats.gpu.valid ? 2 : 1) + (stats.pipeline.valid ? 2 : 0) +
+				(stats.memory_budget > 0 ? 1 : 0);
+			labels_height = static_cast<float>(lines) * LINE_HEIGHT + PADDING - (LINE_HEIGHT - TEXT_SIZE);
+		}
+
+		Vec2 pos = {PADDING * 2.0f, PADDING * 2.0f};
+		const float panel_height = labels_height + PASS_BAR_HEIGHT + GRAPH_HEIGHT * 2.0f + PADDING * 4.0f;
+		fill_rect({PADDING, PADDING}, {GRAPH_WIDTH + PADDING * 2.0f, panel_height}, {16, 16, 16, 200});
+
+		if (font.has_value()) {
+			char line[160];
+			const auto text = [&](Color color) {
+				draw_text(*font, pos, TEXT_SIZE, line, color);
+				pos.y += LINE_HEIGHT;
+			};
+
+			const double fps = stats.frame_ms > 0.0 ? 1000.0 / stats.frame_ms : 0.0;
+			std::snprintf(
+				line, sizeof(line), "CPU %.2f ms   frame %.2f ms (%.0f fps)", stats.cpu_ms, stats.frame_ms, fps
+			);
+			text(budget_color(static_cast<float>(stats.cpu_ms)));
+
+			if (stats.gpu.valid) {
+				std::snprintf(line, sizeof(line), "GPU %.2f ms", stats.gpu.total_ms);
+				text(budget_color(static_cast<float>(stats.gpu.total_ms)));
+
+				// each pass in the color of its part of the bar below
+				float x = pos.x;
+				for (size_t i = 0; i < GPU_PASS_COUNT; i++) {
+					std::snprintf(
+						line, sizeof(line), "%s %.2f", gpu_pass_name(static_cast<GpuPass>(i)), stats.gpu.pass_ms[i]
+					);
+					draw_text(*font, {x, pos.y}, TEXT_SIZE, line, PASS_COLORS[i]);
+					x += measure_text(*font, TEXT_SIZE, line).x + TEXT_SIZE;
+				}
+				pos.y += LINE_HEIGHT;
+			} else {
+				std::snprintf(line, sizeof(line), "GPU timing unavailable");
+				text({200, 200, 200});
+			}
+
+			std::snprintf(
+				line, sizeof(line), "draws %u (culled %u)   triangles %llu   2d primitives %llu",
+				stats.counters.draws, stats.counters.culled,
+				static_cast<unsigned long long>(stats.counters.triangles),
+				static_cast<unsigned long long>(stats.canvas_primitives)
+			);
+			text({200, 200, 200});
+
+			std::snprintf(
+				line, sizeof(line), "binds %u (pipeline %u, set %u, buffer %u)   saved %u", stats.counters.binds(),
+				stats.counters.pipeline_binds, stats.counters.descriptor_binds, stats.counters.buffer_binds,
+				stats.counters.binds_saved
+			);
+			text({200, 200, 200});
+			std::snprintf(
+				line, sizeof(line), "barriers %u   descriptor writes %u", stats.counters.barriers,
+				stats.counters.descriptor_updates
+			);
+			text({200, 200, 200});
+
+			// overdraw counts every fragment shaded, including ones later hidden by depth or blended over
+			if (stats.pipeline.valid) {
+				const auto &pipeline = stats.pipeline;
+				const double overdraw = stats.pixels > 0
+					? static_cast<double>(pipeline.fragment_invocations) / static_cast<double>(stats.pixels)
+					: 0.0;
+				const double kept = pipeline.clipping_invocations > 0
+					? static_cast<double>(pipeline.clipping_primitives) / static_cast<double>(pipeline.clipping_invocations)
+					: 0.0;
+				std::snprintf(
+					line, sizeof(line), "vertices %llu   fragments %llu",
+					static_cast<unsigned long long>(pipeline.vertex_invocations),
+					static_cast<unsigned long long>(pipeline.fragment_invocations)
+				);
+				text({200, 200, 200});
+				std::snprintf(line, sizeof(line), "overdraw %.2fx   kept after clipping %.0f%%", overdraw, kept * 100.0);
+				text({200, 200, 200});
+			}
+
+			if (stats.memory_budget > 0) {
+				std::snprintf(
+					line, sizeof(line), "device memory %.0f / %.0f MiB",
+					static_cast<double>(stats.memory_used) / 1048576.0, static_cast<double>(stats.memory_budget) / 1048576.0
+				);
+				text({200, 200, 200});
+			}
+			pos.y += PADDING - (LINE_HEIGHT - TEXT_SIZE);
+		}
+
+		// the passes side by side on the same scale as the graphs
+		{
+			fill_rect(pos, {GRAPH_WIDTH, PASS_BAR_HEIGHT}, {0, 0, 0, 160});
+			float x = pos.x;
+			for (size_t i = 0; i < GPU_PASS_COUNT && stats.gpu.valid; i++) {
+				const float width = static_cast<float>(stats.gpu.pass_ms[i]) / GRAPH_MS * GRAPH_WIDTH;
+				const float clipped = std::min(width, pos.x + GRAPH_WIDTH - x);
+				if (clipped > 0.0f) {
+					fill_rect({x, pos.y}, {clipped, PASS_BAR_HEIGHT}, PASS_COLORS[i]);
+				}
+				x += clipped;
+			}
+			pos.y += PASS_BAR_HEIGHT + PADDING;
+		}
+
+		draw_graph(pos, _cpu_ms, _next);
+		pos.y += GRAPH_HEIGHT + PADDING;
+		draw_graph(pos, _gpu_ms, _next);
+	}
+}
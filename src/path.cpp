@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory_resource>
+#include <numbers>
+#include <vector>
+
+#include "canvas.h"
+
+namespace VkDraw {
+	static constexpr float CURVE_TOLERANCE = 0.1f; // pixels, for approximating cubics and arcs
+	static constexpr uint32_t MAX_CUBIC_SPLITS = 16;
+	static constexpr float MAX_ARC_STEP = std::numbers::pi_v<float> / 4.0f;
+	static constexpr float BAND_HEIGHT = 16.0f; // pixels, each band only tests the pieces that overlap it
+	static constexpr float AA_MARGIN = 1.0f;
+
+	static Vec2 operator+(Vec2 a, Vec2 b) { return {a.x + b.x, a.y + b.y}; }
+	static Vec2 operator-(Vec2 a, Vec2 b) { return {a.x - b.x, a.y - b.y}; }
+	static Vec2 operator*(Vec2 v, float s) { return {v.x * s, v.y * s}; }
+
+	static float dot(Vec2 a, Vec2 b) { return a.x * b.x + a.y * b.y; }
+	static float cross(Vec2 a, Vec2 b) { return a.x * b.y - a.y * b.x; }
+	static float length(Vec2 v) { return std::sqrt(dot(v, v)); }
+	static Vec2 lerp(Vec2 a, Vec2 b, float t) { return a + (b - a) * t; }
+	static Vec2 perpendicular(Vec2 v) { return {-v.y, v.x}; }
+
+	static Vec2 normalize(Vec2 v) {
+		const float len = length(v);
+		return len > 0.0f ? v * (1.0f / len) : Vec2{0.0f, 0.0f};
+	}
+
+	void Path::ensure_contour() {
+		if (!_has_contour) {
+			move_to(_current);
+		}
+	}
+
+	Path &Path::move_to(Vec2 point) {
+		_verbs.push_back(Verb::MOVE);
+		_points.push_back(point);
+		_start = point;
+		_current = point;
+		_has_contour = true;
+		return *this;
+	}
+
+	Path &Path::line_to(Vec2 point) {
+		ensure_contour();
+		_verbs.push_back(Verb::LINE);
+		_points.push_back(point);
+		_current = point;
+		return *this;
+	}
+
+	Path &Path::quad_to(Vec2 control, Vec2 point) {
+		ensure_contour();
+		_verbs.push_back(Verb::QUAD);
+		_points.push_back(control);
+		_points.push_back(point);
+		_current = point;
+		return *this;
+	}
+
+	Path &Path::cubic_to(Vec2 control1, Vec2 control2, Vec2 point) {
+		ensure_contour();
+		const Vec2 p0 = _current;
+
+		// a single quadratic is off by about sqrt(3) / 36 of the cubic's third difference, and splitting
+		// into n pieces divides that by n cubed
+		const Vec2 third = point - control2 * 3.0f + control1 * 3.0f - p0;
+		const float error = std::sqrt(3.0f) / 36.0f * length(third);
+		const auto splits = std::clamp<uint32_t>(
+			static_cast<uint32_t>(std::ceil(std::cbrt(error / CURVE_TOLERANCE))), 1, MAX_CUBIC_SPLITS
+		);
+
+		const auto evaluate = [&](float t) {
+			const float u = 1.0f - t;
+			return p0 * (u * u * u) + control1 * (3.0f * u * u * t) + control2 * (3.0f * u * t * t) +
+				point * (t * t * t);
+		};
+		const auto derivative = [&](float t) {
+			const float u = 1.0f - t;
+			return (control1 - p0) * (3.0f * u * u) + (control2 - control1) * (6.0f * u * t) +
+				(point - control2) * (3.0f * t * t);
+		};
+
+		for (uint32_t i = 0; i < splits; i++) {
+			const float t0 = static_cast<float>(i) / static_cast<float>(splits);
+			const float t1 = static_cast<float>(i + 1) / static_cast<float>(splits);
+			const float step = (t1 - t0) / 3.0f;
+
+			// the sub cubic's control points, then the quadratic that matches it best at the middle
+			const Vec2 a = evaluate(t0);
+			const Vec2 d = i + 1 == splits ? point : evaluate(t1);
+			const Vec2 b = a + derivative(t0) * step;
+			const Vec2 c = d - derivative(t1) * step;
+			quad_to(((b + c) * 3.0f - a - d) * 0.25f, d);
+		}
+		return *this;
+	}
+
+	Path &Path::arc(Vec2 center, float radius, float start_angle, float end_angle) {
+		const Vec2 start = center + Vec2{std::cos(start_angle), std::sin(start_angle)} * radius;
+		if (_has_contour) {
+			line_to(start);
+		} else {
+			move_to(start);
+		}
+
+		// each step is a quadratic whose control point is where the tangents at its ends meet
+		const float sweep = end_angle - start_angle;
+		const auto steps = std::max<uint32_t>(static_cast<uint32_t>(std::ceil(std::abs(sweep) / MAX_ARC_STEP)), 1);
+		const float step = sweep / static_cast<float>(steps);
+		const float control_radius = radius / std::cos(step * 0.5f);
+
+		for (uint32_t i = 0; i < steps; i++) {
+			const float angle = start_angle + step * static_cast<float>(i);
+			const Vec2 control = center + Vec2{std::cos(angle + step * 0.5f), std::sin(angle + step * 0.5f)} *
+				control_radius;
+			const Vec2 end = center + Vec2{std::cos(angle + step), std::sin(angle + step)} * radius;
+			quad_to(control, end);
+		}
+		return *this;
+	}
+
+	Path &Path::close() {
+		if (_has_contour) {
+			_verbs.push_back(Verb::CLOSE);
+			_current = _start;
+			_has_contour = false;
+		}
+		return *this;
+	}
+
+	void Path::clear() {
+		_verbs.clear();
+		_points.clear();
+		_start = {};
+		_current = {};
+		_has_contour = false;
+	}
+
+	struct Segment {
+		Vec2 p0;
+		Vec2 p1;
+		Vec2 p2;
+	};
+
+	using PieceList = std::pmr::vector<PathPiece>;
+
+	// calls fn with the segments of every contour, lines become quadratics with a centred control point
+	template <typename Fn>
+	static void for_each_contour(const Path &path, std::pmr::memory_resource *scratch, Fn &&fn) {
+		std::pmr::vector<Segment> segments(scratch);
+		const auto points = path.points();
+		size_t next = 0;
+		Vec2 start{};
+		Vec2 current{};
+
+		const auto flush = [&](bool closed) {
+			if (!segments.empty()) {
+				fn(std::span<const Segment>(segments), closed);
+			}
+			segments.clear();
+		};
+
+		for (const auto verb : path.verbs()) {
+			switch (verb) {
+				case Path::Verb::MOVE:
+					flush(false);
+					start = current = points[next++];
+					break;
+				case Path::Verb::LINE:
+					segments.push_back({current, lerp(current, points[next], 0.5f), points[next]});
+					current = points[next++];
+					break;
+				case Path::Verb::QUAD:
+					segments.push_back({current, points[next], points[next + 1]});
+					current = points[next + 1];
+					next += 2;
+					break;
+				case Path::Verb::CLOSE:
+					if (dot(current - start, current - start) > 0.0f) {
+						segments.push_back({current, lerp(current, start, 0.5f), start});
+					}
+					flush(true);
+					current = start;
+					break;
+			}
+		}
+		flush(false);
+	}
+
+	static void add_piece(PieceList &pieces, PathPieceKind kind, Vec2 p0, Vec2 p1, Vec2 p2) {
+		pieces.push_back({p0, p1, p2, static_cast<uint32_t>(kind), 0});
+	}
+
+	// split at the extremum in y so that any scanline crosses each piece at most once
+	static void add_monotonic(PieceList &pieces, const Segment &segment) {
+		const auto [p0, p1, p2] = segment;
+		const float denominator = p0.y - 2.0f * p1.y + p2.y;
+		if (denominator != 0.0f) {
+			const float t = (p0.y - p1.y) / denominator;
+			if (t > 0.0f && t < 1.0f) {
+				Vec2 q0 = lerp(p0, p1, t);
+				Vec2 q1 = lerp(p1, p2, t);
+				const Vec2 mid = lerp(q0, q1, t);
+				// the tangent is horizontal at the split, snap so rounding can't break monotonicity
+				q0.y = mid.y;
+				q1.y = mid.y;
+				add_piece(pieces, PathPieceKind::CURVE, p0, q0, mid);
+				add_piece(pieces, PathPieceKind::CURVE, mid, q1, p2);
+				return;
+			}
+		}
+		add_piece(pieces, PathPieceKind::CURVE, p0, p1, p2);
+	}
+
+	static Vec2 start_tangent(const Segment &segment) {
+		const Vec2 tangent = segment.p1 - segment.p0;
+		return normalize(dot(tangent, tangent) > 0.0f ? tangent : segment.p2 - segment.p0);
+	}
+
+	static Vec2 end_tangent(const Segment &segment) {
+		const Vec2 tangent = segment.p2 - segment.p1;
+		return normalize(dot(tangent, tangent) > 0.0f ? tangent : segment.p2 - segment.p0);
+	}
+
+	static void add_join(PieceList &pieces, const StrokeStyle &style, Vec2 point, Vec2 in, Vec2 out) {
+		const float turn = cross(in, out);
+		if (std::abs(turn) < 1e-4f && dot(in, out) > 0.0f) {
+			return; // the segments continue straight on
+		}
+		if (style.join == LineJoin::ROUND) {
+			add_piece(pieces, PathPieceKind::POINT, point, point, point);
+			return;
+		}
+
+		// the gap between the butt ends is on the outside of the turn
+		const float half_width = style.width * 0.5f;
+		const float side = turn > 0.0f ? -1.0f : 1.0f;
+		const Vec2 n0 = perpendicular(in) * side;
+		const Vec2 n1 = perpendicular(out) * side;
+		const Vec2 a = point + n0 * half_width;
+		const Vec2 b = point + n1 * half_width;
+		if (std::abs(cross(a - point, b - point)) < 1e-6f) {
+			return; // turning back on itself, the ends overlap
+		}
+
+		if (style.join == LineJoin::MITER) {
+			const Vec2 mid = normalize(n0 + n1);
+			const float cos_half = dot(mid, n0);
+			if (cos_half > 0.0f && 1.0f / cos_half <= style.miter_limit) {
+				const Vec2 tip = point + mid * (half_width / cos_half);
+				add_piece(pieces, PathPieceKind::TRIANGLE, point, a, tip);
+				add_piece(pieces, PathPieceKind::TRIANGLE, point, tip, b);
+				return;
+			}
+		}
+		add_piece(pieces, PathPieceKind::TRIANGLE, point, a, b);
+	}
+
+	// direction points away from the stroke
+	static void add_cap(PieceList &pieces, const StrokeStyle &style, Vec2 point, Vec2 direction) {
+		switch (style.cap) {
+			case LineCap::BUTT:
+				break;
+			case LineCap::ROUND:
+				add_piece(pieces, PathPieceKind::POINT, point, point, point);
+				break;
+			case LineCap::SQUARE: {
+				const Vec2 end = point + direction * (style.width * 0.5f);
+				add_piece(pieces, PathPieceKind::CURVE, point, lerp(point, end, 0.5f), end);
+				break;
+			}
+		}
+	}
+
+	struct Bounds {
+		Vec2 min;
+		Vec2 max;
+	};
+
+	static Bounds piece_bounds(const PathPiece &piece, float margin) {
+		return {
+			{
+				std::min({piece.p0.x, piece.p1.x, piece.p2.x}) - margin,
+				std::min({piece.p0.y, piece.p1.y, piece.p2.y}) - margin
+			},
+			{
+				std::max({piece.p0.x, piece.p1.x, piece.p2.x}) + margin,
+				std::max({piece.p0.y, piece.p1.y, piece.p2.y}) + margin
+			}
+		};
+	}
+
+	// bins the pieces into horizontal bands and draws every band that has any, the pieces and the
+	// per band lists go into the frame's GPU memory for path.frag to walk
+	static void draw_bands(const PieceList &pieces, PathMode mode, float half_width, Color color) {
+		if (pieces.empty()) {
+			return;
+		}
+
+		auto &target = canvas();
+		auto *scratch = target.scratch();
+		const float margin = (mode == PathMode::STROKE ? half_width : 0.0f) + AA_MARGIN;
+
+		std::pmr::vector<Bounds> bounds(scratch);
+		bounds.reserve(pieces.size());
+		Bounds total = piece_bounds(pieces[0], margin);
+		for (const auto &piece : pieces) {
+			const auto b = bounds.emplace_back(piece_bounds(piece, margin));
+			total.min = {std::min(total.min.x, b.min.x), std::min(total.min.y, b.min.y)};
+			total.max = {std::max(total.max.x, b.max.x), std::max(total.max.y, b.max.y)};
+		}
+
+		const auto band_count = std::max<uint32_t>(
+			static_cast<uint32_t>(std::ceil((total.max.y - total.min.y) / BAND_HEIGHT)), 1
+		);
+		const auto band_of = [&](float y) {
+			return std::min(static_cast<uint32_t>(std::max(y - total.min.y, 0.0f) / BAND_HEIGHT), band_count - 1);
+		};
+
+		// count the pieces in each band, then turn the counts into offsets
+		std::pmr::vector<uint32_t> offsets(band_count + 1, 0, scratch);
+		std::pmr::vector<Bounds> band_bounds(band_count, {{total.max.x, 0.0f}, {total.min.x, 0.0f}}, scratch);
+		for (const auto &b : bounds) {
+			for (uint32_t band = band_of(b.min.y); band <= band_of(b.max.y); band++) {
+				offsets[band + 1]++;
+				band_bounds[band].min.x = std::min(band_bounds[band].min.x, b.min.x);
+				band_bounds[band].max.x = std::max(band_bounds[band].max.x, b.max.x);
+			}
+		}
+		for (uint32_t band = 0; band < band_count; band++) {
+			offsets[band + 1] += offsets[band];
+		}
+
+		const auto alloc = target.allocate(pieces.size() * sizeof(PathPiece) + offsets[band_count] * sizeof(uint32_t));
+		const auto piece_word = static_cast<uint32_t>(alloc.frame_offset / sizeof(uint32_t));
+		const auto list_word = piece_word + static_cast<uint32_t>(pieces.size() * sizeof(PathPiece) / sizeof(uint32_t));
+
+		// the lists are scattered into scratch memory first, GPU memory is write combined and only
+		// ever written front to back
+		std::pmr::vector<uint32_t> lists(offsets[band_count], scratch);
+		std::pmr::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1, scratch);
+		for (size_t i = 0; i < bounds.size(); i++) {
+			const uint32_t word = piece_word + static_cast<uint32_t>(i * sizeof(PathPiece) / sizeof(uint32_t));
+			for (uint32_t band = band_of(bounds[i].min.y); band <= band_of(bounds[i].max.y); band++) {
+				lists[cursors[band]++] = word;
+			}
+		}
+		memcpy(alloc.data, pieces.data(), pieces.size() * sizeof(PathPiece));
+		memcpy(alloc.data + pieces.size() * sizeof(PathPiece), lists.data(), lists.size() * sizeof(uint32_t));
+
+		uint32_t used = 0;
+		for (uint32_t band = 0; band < band_count; band++) {
+			used += offsets[band + 1] > offsets[band] ? 1 : 0;
+		}
+
+		PathBand *out = target.push_bands(used);
+		const uint32_t packed = pack_color(color);
+		for (uint32_t band = 0; band < band_count; band++) {
+			const uint32_t count = offsets[band + 1] - offsets[band];
+			if (count == 0) {
+				continue;
+			}
+			const float top = total.min.y + static_cast<float>(band) * BAND_HEIGHT;
+			*out++ = {
+				{band_bounds[band].min.x, top},
+				{band_bounds[band].max.x, std::min(top + BAND_HEIGHT, total.max.y)},
+				list_word + offsets[band], count, packed, static_cast<uint32_t>(mode), half_width
+			};
+		}
+	}
+
+	void fill_path(const Path &path, Color color, FillRule rule) {
+		PieceList pieces(canvas().scratch());
+		for_each_contour(path, canvas().scratch(), [&pieces](std::span<const Segment> segments, bool) {
+			for (const auto &segment : segments) {
+				add_monotonic(pieces, segment);
+			}
+
+			// fills close every contour
+			const Vec2 first = segments.front().p0;
+			const Vec2 last = segments.back().p2;
+			if (dot(last - first, last - first) > 0.0f) {
+				add_monotonic(pieces, {last, lerp(last, first, 0.5f), first});
+			}
+		});
+
+		draw_bands(pieces, rule == FillRule::EVEN_ODD ? PathMode::EVEN_ODD : PathMode::NON_ZERO, 0.0f, color);
+	}
+
+	void stroke_path(const Path &path, const StrokeStyle &style, Color color) {
+		if (style.width <= 0.0f) {
+			return;
+		}
+
+		PieceList pieces(canvas().scratch());
+		std::pmr::vector<Segment> kept(canvas().scratch());
+		for_each_contour(path, canvas().scratch(), [&](std::span<const Segment> segments, bool closed) {
+			// zero length segments have no direction to join or cap with
+			kept.clear();
+			for (const auto &segment : segments) {
+				if (dot(segment.p1 - segment.p0, segment.p1 - segment.p0) > 0.0f ||
+					dot(segment.p2 - segment.p0, segment.p2 - segment.p0) > 0.0f) {
+					kept.push_back(segment);
+				}
+			}
+			if (kept.empty()) {
+				if (style.cap == LineCap::ROUND) {
+					const Vec2 point = segments.front().p0;
+					add_piece(pieces, PathPieceKind::POINT, point, point, point);
+				}
+				return;
+			}
+
+			for (size_t i = 0; i < kept.size(); i++) {
+				add_piece(pieces, PathPieceKind::CURVE, kept[i].p0, kept[i].p1, kept[i].p2);
+				if (i + 1 < kept.size()) {
+					add_join(pieces, style, kept[i].p2, end_tangent(kept[i]), start_tangent(kept[i + 1]));
+				}
+			}
+
+			if (closed) {
+				add_join(pieces, style, kept.back().p2, end_tangent(kept.back()), start_tangent(kept.front()));
+			} else {
+				add_cap(pieces, style, kept.front().p0, start_tangent(kept.front()) * -1.0f);
+				add_cap(pieces, style, kept.back().p2, end_tangent(kept.back()));
+			}
+		});
+
+		draw_bands(pieces, PathMode::STROKE, style.width * 0.5f, color);
+	}
+}
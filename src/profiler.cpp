@@ -0,0 +1,237 @@
+#include <stdexcept>
+#include <vector>
+
+#include "debug.h"
+#include "profiler.h"
+#include "trace.h"
+
+namespace VkDraw {
+	const char *gpu_pass_name(GpuPass pass) {
+		switch (pass) {
+			case GpuPass::UPLOADS:
+				return "uploads";
+			case GpuPass::SCENE:
+				return "scene";
+			case GpuPass::CANVAS:
+				return "2d";
+			case GpuPass::OVERLAY:
+				return "overlay";
+			default:
+				return "unknown";
+		}
+	}
+
+	void GpuTimer::init(VkDevice device, float period, uint32_t valid_bits, uint32_t frames) {
+		if (valid_bits == 0) {
+			return;
+		}
+
+		VkQueryPoolCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		info.queryCount = QUERIES_PER_FRAME * frames;
+
+		if (vkCreateQueryPool(device, &info, nullptr, &_pool) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create query pool!");
+		}
+		set_debug_name(device, _pool, "gpu timer queries");
+
+		_tick_ms = static_cast<double>(period) / 1e6;
+		_tick_mask = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+		_pending.assign(frames, false);
+	}
+
+	void GpuTimer::destroy(VkDevice device) {
+		vkDestroyQueryPool(device, _pool, nullptr);
+		_pool = VK_NULL_HANDLE;
+	}
+
+	const GpuFrameTimings &GpuTimer::collect(VkDevice device, uint32_t frame) {
+		if (!enabled() || !_pending[frame]) {
+			return _latest;
+		}
+		_pending[frame] = false;
+
+		std::array<uint64_t, QUERIES_PER_FRAME> ticks{};
+		const auto res = vkGetQueryPoolResults(
+			device, _pool, frame * QUERIES_PER_FRAME, QUERIES_PER_FRAME, sizeof(ticks), ticks.data(),
+			sizeof(uint64_t), VK_QUERY_RESULT_64_BIT
+		);
+		if (res != VK_SUCCESS) {
+			return _latest;
+		}
+
+		// the counters wrap at valid_bits, masking the difference keeps a single wrap harmless
+		const auto elapsed = [this](uint64_t from, uint64_t to) {
+			return static_cast<double>((to - from) & _tick_mask) * _tick_ms;
+		};
+		for (size_t i = 0; i < GPU_PASS_COUNT; i++) {
+			_latest.pass_ms[i] = elapsed(ticks[i], ticks[i + 1]);
+		}
+		_latest.total_ms = elapsed(ticks[0], ticks[GPU_PASS_COUNT]);
+		_latest.begin_ticks = ticks[0];
+		_latest.valid = true;
+		return _latest;
+	}
+
+	void GpuTimer::begin(VkCommandBuffer cmd, uint32_t frame) {
+		if (!enabled()) {
+			return;
+		}
+		vkCmdResetQueryPool(cmd, _pool, frame * QUERIES_PER_FRAME, QUERIES_PER_FRAME);
+		vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _pool, frame * QUERIES_PER_FRAME);
+		_pending[frame] = true;
+	}
+
+	void GpuTimer::end_pass(VkCommandBuffer cmd, uint32_t frame, GpuPass pass) {
+		if (!enabled()) {
+			return;
+		}
+		const uint32_t query = frame * QUERIES_PER_FRAME + static_cast<uint32_t>(pass) + 1;
+		vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _pool, query);
+	}
+
+	void GpuTimer::enable_calibration(VkInstance instance, VkPhysicalDevice physical_device, VkDevice device) {
+		if (!enabled()) {
+			return;
+		}
+
+		const auto get_domains = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(
+			vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT")
+		);
+		_get_calibrated_timestamps = reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(
+			vkGetDeviceProcAddr(device, "vkGetCalibratedTimestampsEXT")
+		);
+		if (get_domains == nullptr || _get_calibrated_timestamps == nullptr) {
+			_get_calibrated_timestamps = nullptr;
+			return;
+		}
+
+		uint32_t count;
+		get_domains(physical_device, &count, nullptr);
+		std::vector<VkTimeDomainEXT> domains(count);
+		get_domains(physical_device, &count, domains.data());
+
+		bool device_domain = false;
+		_host_domain = false;
+		for (const auto domain : domains) {
+			device_domain |= domain == VK_TIME_DOMAIN_DEVICE_EXT;
+#ifdef __linux__
+			// steady_clock is CLOCK_MONOTONIC here, so the host timestamp needs no conversion
+			_host_domain |= domain == VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+		}
+		if (!device_domain) {
+			_get_calibrated_timestamps = nullptr;
+			return;
+		}
+
+		calibrate(device);
+	}
+
+	void GpuTimer::calibrate(VkDevice device) {
+		if (!calibrated()) {
+			return;
+		}
+
+		std::array<VkCalibratedTimestampInfoEXT, 2> infos{};
+		infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+		infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		infos[1].timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+
+		std::array<uint64_t, 2> timestamps{};
+		uint64_t deviation;
+		const auto before = trace_now();
+		const auto res = _get_calibrated_timestamps(
+			device, _host_domain ? 2 : 1, infos.data(), timestamps.data(), &deviation
+		);
+		const auto after = trace_now();
+		if (res != VK_SUCCESS) {
+			return;
+		}
+
+		// without a shared host clock the device was sampled somewhere within the call
+		_calibration_ticks = timestamps[0];
+		_calibration_ns = _host_domain ? static_cast<int64_t>(timestamps[1]) : before + (after - before) / 2;
+	}
+
+	int64_t GpuTimer::host_ns(uint64_t ticks) const {
+		// the nearest wrap-around distance, so ticks either side of the calibration map correctly
+		auto delta = static_cast<int64_t>((ticks - _calibration_ticks) & _tick_mask);
+		if (static_cast<uint64_t>(delta) > _tick_mask / 2) {
+			delta -= static_cast<int64_t>(_tick_mask) + 1;
+		}
+		return _calibration_ns + static_cast<int64_t>(static_cast<double>(delta) * _tick_ms * 1e6);
+	}
+
+	// results are written in bit order, so the members of PipelineStatistics follow the flags
+	static constexpr VkQueryPipelineStatisticFlags PIPELINE_STATISTICS =
+		VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+	static constexpr uint32_t PIPELINE_STATISTIC_COUNT = 6;
+
+	void PipelineStatsQuery::init(VkDevice device, uint32_t frames) {
+		VkQueryPoolCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		info.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+		info.queryCount = frames;
+		info.pipelineStatistics = PIPELINE_STATISTICS;
+
+		if (vkCreateQueryPool(device, &info, nullptr, &_pool) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create query pool!");
+		}
+		set_debug_name(device, _pool, "pipeline statistics queries");
+
+		_pending.assign(frames, false);
+	}
+
+	void PipelineStatsQuery::destroy(VkDevice device) {
+		vkDestroyQueryPool(device, _pool, nullptr);
+		_pool = VK_NULL_HANDLE;
+	}
+
+	const PipelineStatistics &PipelineStatsQuery::collect(VkDevice device, uint32_t frame) {
+		if (!enabled() || !_pending[frame]) {
+			return _latest;
+		}
+		_pending[frame] = false;
+
+		std::array<uint64_t, PIPELINE_STATISTIC_COUNT> values{};
+		const auto res = vkGetQueryPoolResults(
+			device, _pool, frame, 1, sizeof(values), values.data(), sizeof(values), VK_QUERY_RESULT_64_BIT
+		);
+		if (res != VK_SUCCESS) {
+			return _latest;
+		}
+
+		_latest.input_vertices = values[0];
+		_latest.input_primitives = values[1];
+		_latest.vertex_invocations = values[2];
+		_latest.clipping_invocations = values[3];
+		_latest.clipping_primitives = values[4];
+		_latest.fragment_invocations = values[5];
+		_latest.valid = true;
+		return _latest;
+	}
+
+	void PipelineStatsQuery::begin(VkCommandBuffer cmd, uint32_t frame) {
+		if (!enabled()) {
+			return;
+		}
+		vkCmdResetQueryPool(cmd, _pool, frame, 1);
+		vkCmdBeginQuery(cmd, _pool, frame, 0);
+		_pending[frame] = true;
+	}
+
+	void PipelineStatsQuery::end(VkCommandBuffer cmd, uint32_t frame) {
+		if (!enabled()) {
+			return;
+		}
+		vkCmdEndQuery(cmd, _pool, frame);
+	}
+}
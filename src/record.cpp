@@ -0,0 +1,54 @@
+#include <stdexcept>
+
+#include "record.h"
+
+namespace VkDraw {
+	void record_draws(
+		VkCommandBuffer cmd, std::span<const DrawItem> draws, const DrawBindings &bindings, RenderCounters &counters
+	) {
+		// binds_saved counts the binds that binding everything for every draw would have added
+		constexpr uint32_t BINDS_PER_DRAW = 4; // pipeline, vertex buffer, index buffer and descriptor set
+		const uint32_t binds_before = counters.binds();
+
+		// the pipeline is only looked up when the key's pipeline field changes
+		uint32_t bound_field = ~0u;
+		VkPipeline bound_pipeline = VK_NULL_HANDLE;
+		bool state_bound = false;
+		for (const auto &draw : draws) {
+			const uint32_t field = draw_sort_pipeline(draw.key);
+			if (field != bound_field) {
+				bound_field = field;
+				const auto pipeline = field < bindings.pipelines.size() ? bindings.pipelines[field] : VK_NULL_HANDLE;
+				if (pipeline == VK_NULL_HANDLE) {
+					throw std::runtime_error("Draw uses a pipeline that was not compiled!");
+				}
+				if (pipeline != bound_pipeline) {
+					vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+					bound_pipeline = pipeline;
+					counters.pipeline_binds++;
+				}
+			}
+
+			if (!state_bound) {
+				const VkDeviceSize offset = 0;
+				vkCmdBindVertexBuffers(cmd, 0, 1, &bindings.vertex_buffer, &offset);
+				vkCmdBindIndexBuffer(cmd, bindings.index_buffer, 0, bindings.index_type);
+				vkCmdBindDescriptorSets(
+					cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, bindings.layout, 0, 1, &bindings.set, 1,
+					&bindings.dynamic_offset
+				);
+				state_bound = true;
+				counters.buffer_binds += 2;
+				counters.descriptor_binds++;
+			}
+
+			const auto &model = bindings.models[draw.object];
+			vkCmdPushConstants(cmd, bindings.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(model), &model);
+			vkCmdDrawIndexed(cmd, bindings.index_count, 1, 0, 0, 0);
+		}
+
+		counters.draws += draws.size();
+		counters.triangles += static_cast<uint64_t>(bindings.index_count / 3) * draws.size();
+		counters.binds_saved += BINDS_PER_DRAW * draws.size() - (counters.binds() - binds_before);
+	}
+}
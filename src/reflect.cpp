@@ -0,0 +1,622 @@
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "reflect.h"
+
+namespace VkDraw {
+	static constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+	static constexpr uint32_t SPIRV_HEADER_SIZE = 5;
+
+	// opcodes
+	static constexpr uint16_t OP_ENTRY_POINT = 15;
+	static constexpr uint16_t OP_TYPE_BOOL = 20;
+	static constexpr uint16_t OP_TYPE_INT = 21;
+	static constexpr uint16_t OP_TYPE_FLOAT = 22;
+	static constexpr uint16_t OP_TYPE_VECTOR = 23;
+	static constexpr uint16_t OP_TYPE_MATRIX = 24;
+	static constexpr uint16_t OP_TYPE_IMAGE = 25;
+	static constexpr uint16_t OP_TYPE_SAMPLER = 26;
+	static constexpr uint16_t OP_TYPE_SAMPLED_IMAGE = 27;
+	static constexpr uint16_t OP_TYPE_ARRAY = 28;
+	static constexpr uint16_t OP_TYPE_RUNTIME_ARRAY = 29;
+	static constexpr uint16_t OP_TYPE_STRUCT = 30;
+	static constexpr uint16_t OP_TYPE_POINTER = 32;
+	static constexpr uint16_t OP_CONSTANT = 43;
+	static constexpr uint16_t OP_VARIABLE = 59;
+	static constexpr uint16_t OP_DECORATE = 71;
+	static constexpr uint16_t OP_MEMBER_DECORATE = 72;
+
+	// decorations
+	static constexpr uint32_t DECORATION_BLOCK = 2;
+	static constexpr uint32_t DECORATION_BUFFER_BLOCK = 3;
+	static constexpr uint32_t DECORATION_ARRAY_STRIDE = 6;
+	static constexpr uint32_t DECORATION_MATRIX_STRIDE = 7;
+	static constexpr uint32_t DECORATION_BUILTIN = 11;
+	static constexpr uint32_t DECORATION_LOCATION = 30;
+	static constexpr uint32_t DECORATION_BINDING = 33;
+	static constexpr uint32_t DECORATION_DESCRIPTOR_SET = 34;
+	static constexpr uint32_t DECORATION_OFFSET = 35;
+
+	// storage classes
+	static constexpr uint32_t STORAGE_UNIFORM_CONSTANT = 0;
+	static constexpr uint32_t STORAGE_INPUT = 1;
+	static constexpr uint32_t STORAGE_UNIFORM = 2;
+	static constexpr uint32_t STORAGE_PUSH_CONSTANT = 9;
+	static constexpr uint32_t STORAGE_STORAGE_BUFFER = 12;
+
+	// image dimensions
+	static constexpr uint32_t DIM_BUFFER = 5;
+	static constexpr uint32_t DIM_SUBPASS_DATA = 6;
+
+	struct SpirvId {
+		uint16_t op = 0;
+		uint32_t width = 0; // scalar bit width
+		uint32_t element = 0; // component, column, element or pointee type
+		uint32_t count = 0; // vector/matrix/array length
+		bool spec_length = false; // array length is a specialization constant, unknown until pipeline creation
+		uint32_t storage = 0;
+		uint32_t dim = 0;
+		uint32_t sampled = 0;
+		bool is_signed = false;
+		uint32_t value = 0; // scalar constant value
+		std::vector<uint32_t> members;
+
+		std::optional<uint32_t> location;
+		std::optional<uint32_t> binding;
+		std::optional<uint32_t> set;
+		uint32_t array_stride = 0;
+		bool builtin = false;
+		bool block = false;
+		bool buffer_block = false;
+		std::vector<uint32_t> member_offsets;
+		std::vector<uint32_t> member_matrix_strides;
+	};
+
+	struct SpirvModule {
+		std::vector<SpirvId> ids;
+		std::vector<uint32_t> variables;
+		uint32_t execution_model = 0;
+	};
+
+	static SpirvModule parse_module(std::span<const uint32_t> code) {
+		if (code.size() < SPIRV_HEADER_SIZE || code[0] != SPIRV_MAGIC) {
+			throw std::runtime_error("Invalid SPIR-V module!");
+		}
+
+		SpirvModule module;
+		module.ids.resize(code[3]);
+
+		auto id = [&module](uint32_t idx) -> SpirvId & {
+			if (idx >= module.ids.size()) {
+				throw std::runtime_error("SPIR-V id out of bounds!");
+			}
+			return module.ids[idx];
+		};
+
+		bool found_entry = false;
+		for (size_t i = SPIRV_HEADER_SIZE; i < code.size();) {
+			const uint16_t op = code[i] & 0xFFFF;
+			const uint16_t words = code[i] >> 16;
+			if (words == 0 || i + words > code.size()) {
+				throw std::runtime_error("Malformed SPIR-V instruction!");
+			}
+			const uint32_t *w = &code[i];
+
+			switch (op) {
+				case OP_ENTRY_POINT:
+					if (!found_entry) {
+						module.execution_model = w[1];
+						found_entry = true;
+					}
+					break;
+				case OP_TYPE_BOOL:
+					id(w[1]).op = op;
+					id(w[1]).width = 32;
+					break;
+				case OP_TYPE_INT:
+					id(w[1]).op = op;
+					id(w[1]).width = w[2];
+					id(w[1]).is_signed = w[3] != 0;
+					break;
+				case OP_TYPE_FLOAT:
+					id(w[1]).op = op;
+					id(w[1]).width = w[2];
+					break;
+				case OP_TYPE_VECTOR:
+				case OP_TYPE_MATRIX:
+					id(w[1]).op = op;
+					id(w[1]).element = w[2];
+					id(w[1]).count = w[3];
+					break;
+				case OP_TYPE_IMAGE:
+					id(w[1]).op = op;
+					id(w[1]).dim = w[3];
+					id(w[1]).sampled = w[7];
+					break;
+				case OP_TYPE_SAMPLER:
+					id(w[1]).op = op;
+					break;
+				case OP_TYPE_SAMPLED_IMAGE:
+				case OP_TYPE_RUNTIME_ARRAY:
+					id(w[1]).op = op;
+					id(w[1]).element = w[2];
+					break;
+				case OP_TYPE_ARRAY:
+					id(w[1]).op = op;
+					id(w[1]).element = w[2];
+					id(w[1]).count = id(w[3]).value;
+					id(w[1]).spec_length = id(w[3]).op != OP_CONSTANT;
+					break;
+				case OP_TYPE_STRUCT:
+					id(w[1]).op = op;
+					id(w[1]).members.assign(w + 2, w + words);
+					break;
+				case OP_TYPE_POINTER:
+					id(w[1]).op = op;
+					id(w[1]).storage = w[2];
+					id(w[1]).element = w[3];
+					break;
+				case OP_CONSTANT:
+					id(w[2]).op = op;
+					id(w[2]).value = w[3];
+					break;
+				case OP_VARIABLE:
+					id(w[2]).op = op;
+					id(w[2]).element = w[1];
+					id(w[2]).storage = w[3];
+					module.variables.push_back(w[2]);
+					break;
+				case OP_DECORATE: {
+					auto &target = id(w[1]);
+					switch (w[2]) {
+						case DECORATION_BLOCK:
+							target.block = true;
+							break;
+						case DECORATION_BUFFER_BLOCK:
+							target.buffer_block = true;
+							break;
+						case DECORATION_ARRAY_STRIDE:
+							target.array_stride = w[3];
+							break;
+						case DECORATION_BUILTIN:
+							target.builtin = true;
+							break;
+						case DECORATION_LOCATION:
+							target.location = w[3];
+							break;
+						case DECORATION_BINDING:
+							target.binding = w[3];
+							break;
+						case DECORATION_DESCRIPTOR_SET:
+							target.set = w[3];
+							break;
+						default:
+							break;
+					}
+					break;
+				}
+				case OP_MEMBER_DECORATE: {
+					auto &target = id(w[1]);
+					const uint32_t member = w[2];
+					if (w[3] == DECORATION_OFFSET) {
+						target.member_offsets.resize(std::max<size_t>(target.member_offsets.size(), member + 1));
+						target.member_offsets[member] = w[4];
+					} else if (w[3] == DECORATION_MATRIX_STRIDE) {
+						target.member_matrix_strides.resize(
+							std::max<size_t>(target.member_matrix_strides.size(), member + 1)
+						);
+						target.member_matrix_strides[member] = w[4];
+					} else if (w[3] == DECORATION_BUILTIN) {
+						target.builtin = true;
+					}
+					break;
+				}
+				default:
+					break;
+			}
+
+			i += words;
+		}
+
+		if (!found_entry) {
+			throw std::runtime_error("SPIR-V module has no entry point!");
+		}
+
+		return module;
+	}
+
+	static uint32_t type_size(const SpirvModule &module, uint32_t type);
+
+	static uint32_t member_size(const SpirvModule &module, const SpirvId &type, uint32_t member) {
+		const auto &member_type = module.ids[type.members[member]];
+
+		if (member_type.op == OP_TYPE_MATRIX && member < type.member_matrix_strides.size()) {
+			return type.member_matrix_strides[member] * member_type.count;
+		}
+		return type_size(module, type.members[member]);
+	}
+
+	static uint32_t type_size(const SpirvModule &module, uint32_t type) {
+		const auto &t = module.ids[type];
+
+		switch (t.op) {
+			case OP_TYPE_BOOL:
+			case OP_TYPE_INT:
+			case OP_TYPE_FLOAT:
+				return t.width / 8;
+			case OP_TYPE_VECTOR:
+			case OP_TYPE_MATRIX:
+				return type_size(module, t.element) * t.count;
+			case OP_TYPE_ARRAY:
+				if (t.spec_length) {
+					throw std::runtime_error("Array sized by a specialization constant in shader interface!");
+				}
+				return (t.array_stride ? t.array_stride : type_size(module, t.element)) * t.count;
+			case OP_TYPE_STRUCT: {
+				uint32_t size = 0;
+				for (uint32_t i = 0; i < t.members.size(); i++) {
+					const uint32_t offset = i < t.member_offsets.size() ? t.member_offsets[i] : size;
+					size = std::max(size, offset + member_size(module, t, i));
+				}
+				return size;
+			}
+			default:
+				throw std::runtime_error("Unsupported SPIR-V type in shader interface!");
+		}
+	}
+
+	static VkShaderStageFlagBits execution_stage(uint32_t model) {
+		switch (model) {
+			case 0:
+				return VK_SHADER_STAGE_VERTEX_BIT;
+			case 1:
+				return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+			case 2:
+				return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+			case 3:
+				return VK_SHADER_STAGE_GEOMETRY_BIT;
+			case 4:
+				return VK_SHADER_STAGE_FRAGMENT_BIT;
+			case 5:
+				return VK_SHADER_STAGE_COMPUTE_BIT;
+			default:
+				throw std::runtime_error("Unsupported SPIR-V execution model!");
+		}
+	}
+
+	static VkFormat vertex_format(const SpirvId &component, uint32_t count) {
+		static constexpr VkFormat FLOAT32[] = {
+			VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT
+		};
+		static constexpr VkFormat FLOAT64[] = {
+			VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT
+		};
+		static constexpr VkFormat SINT32[] = {
+			VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT
+		};
+		static constexpr VkFormat UINT32[] = {
+			VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT
+		};
+
+		if (count == 0 || count > 4) {
+			throw std::runtime_error("Unsupported vertex input width!");
+		}
+		if (component.op == OP_TYPE_FLOAT && component.width == 32) {
+			return FLOAT32[count - 1];
+		}
+		if (component.op == OP_TYPE_FLOAT && component.width == 64) {
+			return FLOAT64[count - 1];
+		}
+		if (component.op == OP_TYPE_INT && component.width == 32) {
+			return component.is_signed ? SINT32[count - 1] : UINT32[count - 1];
+		}
+		throw std::runtime_error("Unsupported vertex input type!");
+	}
+
+	static VkDescriptorType descriptor_type(const SpirvId &type, uint32_t storage) {
+		if (storage == STORAGE_STORAGE_BUFFER) {
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		}
+		if (storage == STORAGE_UNIFORM) {
+			return type.buffer_block ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		}
+
+		switch (type.op) {
+			case OP_TYPE_SAMPLER:
+				return VK_DESCRIPTOR_TYPE_SAMPLER;
+			case OP_TYPE_SAMPLED_IMAGE:
+				return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			case OP_TYPE_IMAGE:
+				if (type.dim == DIM_SUBPASS_DATA) {
+					return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+				}
+				if (type.dim == DIM_BUFFER) {
+					return type.sampled == 2
+						? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER
+						: VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+				}
+				return type.sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			default:
+				throw std::runtime_error("Unsupported SPIR-V descriptor type!");
+		}
+	}
+
+	ShaderReflection reflect_shader(std::span<const uint32_t> code) {
+		const auto module = parse_module(code);
+
+		ShaderReflection reflection;
+		reflection.stage = execution_stage(module.execution_model);
+
+		struct Input {
+			uint32_t location;
+			VkFormat format;
+			uint32_t size;
+		};
+		std::vector<Input> inputs;
+
+		for (const auto idx : module.variables) {
+			const auto &var = module.ids[idx];
+			const auto &pointer = module.ids[var.element];
+			uint32_t type_idx = pointer.element;
+
+			switch (var.storage) {
+				case STORAGE_INPUT: {
+					if (reflection.stage != VK_SHADER_STAGE_VERTEX_BIT || var.builtin || !var.location.has_value()) {
+						break;
+					}
+					const auto &type = module.ids[type_idx];
+					if (type.op == OP_TYPE_STRUCT && type.builtin) {
+						break;
+					}
+
+					// matrices consume one location per column
+					const auto &column = type.op == OP_TYPE_MATRIX ? module.ids[type.element] : type;
+					const uint32_t columns = type.op == OP_TYPE_MATRIX ? type.count : 1;
+					const bool is_vector = column.op == OP_TYPE_VECTOR;
+					const auto &component = is_vector ? module.ids[column.element] : column;
+					const uint32_t count = is_vector ? column.count : 1;
+
+					for (uint32_t i = 0; i < columns; i++) {
+						inputs.push_back({
+							var.location.value() + i, vertex_format(component, count), component.width / 8 * count
+						});
+					}
+					break;
+				}
+				case STORAGE_PUSH_CONSTANT: {
+					const auto &type = module.ids[type_idx];
+					uint32_t offset = type.member_offsets.empty()
+						? 0
+						: *std::ranges::min_element(type.member_offsets);
+
+					VkPushConstantRange range{};
+					range.stageFlags = reflection.stage;
+					range.offset = offset;
+					range.size = type_size(module, type_idx) - offset;
+					reflection.push_constants.push_back(range);
+					break;
+				}
+				case STORAGE_UNIFORM_CONSTANT:
+				case STORAGE_UNIFORM:
+				case STORAGE_STORAGE_BUFFER: {
+					uint32_t count = 1;
+					while (module.ids[type_idx].op == OP_TYPE_ARRAY) {
+						if (module.ids[type_idx].spec_length) {
+							throw std::runtime_error("Descriptor array sized by a specialization constant!");
+						}
+						count *= module.ids[type_idx].count;
+						type_idx = module.ids[type_idx].element;
+					}
+					if (module.ids[type_idx].op == OP_TYPE_RUNTIME_ARRAY) {
+						throw std::runtime_error("Runtime descriptor arrays are not supported!");
+					}
+
+					const uint32_t set = var.set.value_or(0);
+					if (reflection.sets.size() <= set) {
+						reflection.sets.resize(set + 1);
+					}
+
+					VkDescriptorSetLayoutBinding binding{};
+					binding.binding = var.binding.value_or(0);
+					binding.descriptorType = descriptor_type(module.ids[type_idx], var.storage);
+					binding.descriptorCount = count;
+					binding.stageFlags = reflection.stage;
+					binding.pImmutableSamplers = nullptr;
+					reflection.sets[set].push_back(binding);
+					break;
+				}
+				default:
+					break;
+			}
+		}
+
+		// SPIR-V has no vertex offsets, pack in location order until apply_vertex_layout supplies the real ones
+		std::ranges::sort(inputs, {}, &Input::location);
+		for (const auto &input : inputs) {
+			VkVertexInputAttributeDescription attribute{};
+			attribute.binding = 0;
+			attribute.location = input.location;
+			attribute.format = input.format;
+			attribute.offset = reflection.input_stride;
+			reflection.inputs.push_back(attribute);
+			reflection.input_stride += input.size;
+		}
+
+		for (auto &set : reflection.sets) {
+			std::ranges::sort(set, {}, &VkDescriptorSetLayoutBinding::binding);
+		}
+
+		return reflection;
+	}
+
+	PipelineReflection reflect_pipeline(std::span<const ShaderReflection> stages) {
+		PipelineReflection pipeline;
+
+		for (const auto &stage : stages) {
+			if (pipeline.sets.size() < stage.sets.size()) {
+				pipeline.sets.resize(stage.sets.size());
+			}
+
+			// merge descriptor bindings shared between stages
+			for (size_t set = 0; set < stage.sets.size(); set++) {
+				for (const auto &binding : stage.sets[set]) {
+					auto existing = std::ranges::find(
+						pipeline.sets[set], binding.binding, &VkDescriptorSetLayoutBinding::binding
+					);
+					if (existing == pipeline.sets[set].end()) {
+						pipeline.sets[set].push_back(binding);
+					} else if (existing->descriptorType != binding.descriptorType ||
+						existing->descriptorCount != binding.descriptorCount) {
+						throw std::runtime_error("Conflicting descriptor binding between shader stages!");
+					} else {
+						existing->stageFlags |= binding.stageFlags;
+					}
+				}
+			}
+
+			// merge identical push constant ranges
+			for (const auto &range : stage.push_constants) {
+				auto existing = std::ranges::find_if(pipeline.push_constants, [&range](const auto &other) {
+					return other.offset == range.offset && other.size == range.size;
+				});
+				if (existing == pipeline.push_constants.end()) {
+					pipeline.push_constants.push_back(range);
+				} else {
+					existing->stageFlags |= range.stageFlags;
+				}
+			}
+
+			if (stage.stage == VK_SHADER_STAGE_VERTEX_BIT) {
+				pipeline.binding.binding = 0;
+				pipeline.binding.stride = stage.input_stride;
+				pipeline.binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+				pipeline.attributes = stage.inputs;
+			}
+		}
+
+		for (auto &set : pipeline.sets) {
+			std::ranges::sort(set, {}, &VkDescriptorSetLayoutBinding::binding);
+		}
+
+		return pipeline;
+	}
+
+	void apply_vertex_layout(PipelineReflection &reflection, std::span<const uint32_t> offsets, uint32_t stride) {
+		auto &attributes = reflection.attributes;
+		if (attributes.size() != offsets.size()) {
+			throw std::runtime_error("Vertex layout does not match the number of shader inputs!");
+		}
+
+		// attributes are still packed, so each one's size is the distance to the next
+		std::vector<std::pair<uint32_t, uint32_t>> ranges; // offset, size
+		for (size_t i = 0; i < attributes.size(); i++) {
+			const uint32_t end = i + 1 < attributes.size() ? attributes[i + 1].offset : reflection.binding.stride;
+			ranges.emplace_back(offsets[i], end - attributes[i].offset);
+		}
+
+		std::ranges::sort(ranges);
+		for (size_t i = 0; i < ranges.size(); i++) {
+			const uint32_t limit = i + 1 < ranges.size() ? ranges[i + 1].first : stride;
+			if (ranges[i].first + ranges[i].second > limit) {
+				throw std::runtime_error("Vertex shader input does not fit its member of the vertex layout!");
+			}
+		}
+
+		for (size_t i = 0; i < attributes.size(); i++) {
+			attributes[i].offset = offsets[i];
+		}
+		reflection.binding.stride = stride;
+	}
+
+	struct LayoutKeyHash {
+		size_t operator()(const std::vector<uint64_t> &key) const {
+			size_t hash = key.size();
+			for (const auto value : key) {
+				hash ^= std::hash<uint64_t>{}(value) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+			}
+			return hash;
+		}
+	};
+
+	// programs are created on worker threads during startup
+	static std::mutex _layout_mutex;
+	static std::unordered_map<std::vector<uint64_t>, VkDescriptorSetLayout, LayoutKeyHash> _set_layouts;
+	static std::unordered_map<std::vector<uint64_t>, VkPipelineLayout, LayoutKeyHash> _pipeline_layouts;
+
+	VkDescriptorSetLayout get_set_layout(VkDevice device, std::span<const VkDescriptorSetLayoutBinding> bindings) {
+		std::vector<uint64_t> key;
+		key.reserve(bindings.size() * 2);
+		for (const auto &binding : bindings) {
+			key.push_back(static_cast<uint64_t>(binding.binding) << 32 | binding.descriptorType);
+			key.push_back(static_cast<uint64_t>(binding.descriptorCount) << 32 | binding.stageFlags);
+		}
+
+		std::lock_guard lock(_layout_mutex);
+		if (auto it = _set_layouts.find(key); it != _set_layouts.end()) {
+			return it->second;
+		}
+
+		VkDescriptorSetLayoutCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		info.pBindings = bindings.data();
+		info.bindingCount = bindings.size();
+
+		VkDescriptorSetLayout layout;
+		if (vkCreateDescriptorSetLayout(device, &info, nullptr, &layout) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create descriptor set layout!");
+		}
+
+		_set_layouts.emplace(std::move(key), layout);
+		return layout;
+	}
+
+	VkPipelineLayout get_pipeline_layout(
+		VkDevice device, std::span<const VkDescriptorSetLayout> sets, std::span<const VkPushConstantRange> ranges
+	) {
+		std::vector<uint64_t> key;
+		key.reserve(sets.size() + ranges.size() * 2 + 1);
+		key.push_back(sets.size());
+		for (const auto set : sets) {
+			key.push_back(std::hash<VkDescriptorSetLayout>{}(set));
+		}
+		for (const auto &range : ranges) {
+			key.push_back(range.stageFlags);
+			key.push_back(static_cast<uint64_t>(range.offset) << 32 | range.size);
+		}
+
+		std::lock_guard lock(_layout_mutex);
+		if (auto it = _pipeline_layouts.find(key); it != _pipeline_layouts.end()) {
+			return it->second;
+		}
+
+		VkPipelineLayoutCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		info.setLayoutCount = sets.size();
+		info.pSetLayouts = sets.data();
+		info.pushConstantRangeCount = ranges.size();
+		info.pPushConstantRanges = ranges.data();
+
+		VkPipelineLayout layout;
+		if (vkCreatePipelineLayout(device, &info, nullptr, &layout) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create pipeline layout!");
+		}
+
+		_pipeline_layouts.emplace(std::move(key), layout);
+		return layout;
+	}
+
+	void destroy_layout_cache(VkDevice device) {
+		std::lock_guard lock(_layout_mutex);
+		for (const auto &[key, layout] : _pipeline_layouts) {
+			vkDestroyPipelineLayout(device, layout, nullptr);
+		}
+		for (const auto &[key, layout] : _set_layouts) {
+			vkDestroyDescriptorSetLayout(device, layout, nullptr);
+		}
+		_pipeline_layouts.clear();
+		_set_layouts.clear();
+	}
+}
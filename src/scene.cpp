@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include "scene.h"
+#include "trace.h"
+
+namespace VkDraw {
+	NodeId SceneGraph::add(const Transform &local, NodeId parent) {
+		const auto node = static_cast<NodeId>(_index.size());
+		const auto position = static_cast<uint32_t>(_parent.size());
+
+		// the parent already exists, so appending keeps the order topological
+		_parent.push_back(parent == NO_NODE ? NO_NODE : _index.at(parent));
+		_tx.push_back(0.0f);
+		_ty.push_back(0.0f);
+		_tz.push_back(0.0f);
+		_rx.push_back(0.0f);
+		_ry.push_back(0.0f);
+		_rz.push_back(0.0f);
+		_rw.push_back(1.0f);
+		_sx.push_back(1.0f);
+		_sy.push_back(1.0f);
+		_sz.push_back(1.0f);
+		_world.emplace_back(1.0f);
+		_dirty.push_back(1);
+		_node.push_back(node);
+		_index.push_back(position);
+
+		set_local(node, local);
+		return node;
+	}
+
+	void SceneGraph::set_parent(NodeId node, NodeId parent) {
+		const uint32_t position = _index.at(node);
+		uint32_t parent_position = NO_NODE;
+		if (parent != NO_NODE) {
+			parent_position = _index.at(parent);
+			for (uint32_t ancestor = parent_position; ancestor != NO_NODE; ancestor = _parent[ancestor]) {
+				if (ancestor == position) {
+					throw std::runtime_error("Scene node can't be parented to itself or a descendant!");
+				}
+			}
+		}
+
+		_parent[position] = parent_position;
+		_dirty[position] = 1;
+		if (parent_position != NO_NODE && parent_position > position) {
+			_sorted = false;
+		}
+	}
+
+	void SceneGraph::set_local(NodeId node, const Transform &local) {
+		const uint32_t i = _index[node];
+		_tx[i] = local.translation.x;
+		_ty[i] = local.translation.y;
+		_tz[i] = local.translation.z;
+		_rx[i] = local.rotation.x;
+		_ry[i] = local.rotation.y;
+		_rz[i] = local.rotation.z;
+		_rw[i] = local.rotation.w;
+		_sx[i] = local.scale.x;
+		_sy[i] = local.scale.y;
+		_sz[i] = local.scale.z;
+		_dirty[i] = 1;
+	}
+
+	void SceneGraph::set_translation(NodeId node, glm::vec3 translation) {
+		const uint32_t i = _index[node];
+		_tx[i] = translation.x;
+		_ty[i] = translation.y;
+		_tz[i] = translation.z;
+		_dirty[i] = 1;
+	}
+
+	void SceneGraph::set_rotation(NodeId node, glm::quat rotation) {
+		const uint32_t i = _index[node];
+		_rx[i] = rotation.x;
+		_ry[i] = rotation.y;
+		_rz[i] = rotation.z;
+		_rw[i] = rotation.w;
+		_dirty[i] = 1;
+	}
+
+	void SceneGraph::set_scale(NodeId node, glm::vec3 scale) {
+		const uint32_t i = _index[node];
+		_sx[i] = scale.x;
+		_sy[i] = scale.y;
+		_sz[i] = scale.z;
+		_dirty[i] = 1;
+	}
+
+	Transform SceneGraph::local(NodeId node) const {
+		const uint32_t i = _index[node];
+		Transform local;
+		local.translation = {_tx[i], _ty[i], _tz[i]};
+		local.rotation = glm::quat(_rw[i], _rx[i], _ry[i], _rz[i]);
+		local.scale = {_sx[i], _sy[i], _sz[i]};
+		return local;
+	}
+
+	// by depth, which is a topological order that also keeps each level contiguous
+	void SceneGraph::sort() {
+		TRACE_SCOPE("SceneGraph::sort");
+		const auto count = static_cast<uint32_t>(_parent.size());
+
+		// depths are found by walking up to the nearest ancestor whose depth is known
+		std::vector<uint32_t> depth(count, NO_NODE);
+		std::vector<uint32_t> chain;
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t at = i;
+			while (depth[at] == NO_NODE && _parent[at] != NO_NODE) {
+				chain.push_back(at);
+				at = _parent[at];
+			}
+			if (depth[at] == NO_NODE) {
+				depth[at] = 0;
+			}
+			for (uint32_t d = depth[at] + 1; !chain.empty(); d++) {
+				depth[chain.back()] = d;
+				chain.pop_back();
+			}
+		}
+
+		std::vector<uint32_t> order(count); // new position to old position
+		std::iota(order.begin(), order.end(), 0u);
+		std::ranges::stable_sort(order, {}, [&depth](uint32_t i) { return depth[i]; });
+		std::vector<uint32_t> moved_to(count);
+		for (uint32_t i = 0; i < count; i++) {
+			moved_to[order[i]] = i;
+		}
+
+		const auto permute = [&order](auto &values) {
+			auto old = values;
+			for (size_t i = 0; i < order.size(); i++) {
+				values[i] = old[order[i]];
+			}
+		};
+		permute(_parent);
+		for (auto &parent : _parent) {
+			parent = parent == NO_NODE ? NO_NODE : moved_to[parent];
+		}
+		for (auto *values : {&_tx, &_ty, &_tz, &_rx, &_ry, &_rz, &_rw, &_sx, &_sy, &_sz}) {
+			permute(*values);
+		}
+		permute(_world);
+		permute(_dirty);
+		permute(_node);
+		for (uint32_t i = 0; i < count; i++) {
+			_index[_node[i]] = i;
+		}
+
+		_sorted = true;
+	}
+
+	// column major like glm, the rotation must be normalized
+	static void local_matrix(
+		float x, float y, float z, float w, float tx, float ty, float tz, float sx, float sy, float sz, float *out
+	) {
+		const float xx = x * x, yy = y * y, zz = z * z;
+		const float xy = x * y, xz = x * z, yz = y * z;
+		const float wx = w * x, wy = w * y, wz = w * z;
+
+		out[0] = (1.0f - 2.0f * (yy + zz)) * sx;
+		out[1] = 2.0f * (xy + wz) * sx;
+		out[2] = 2.0f * (xz - wy) * sx;
+		out[3] = 0.0f;
+		out[4] = 2.0f * (xy - wz) * sy;
+		out[5] = (1.0f - 2.0f * (xx + zz)) * sy;
+		out[6] = 2.0f * (yz + wx) * sy;
+		out[7] = 0.0f;
+		out[8] = 2.0f * (xz + wy) * sz;
+		out[9] = 2.0f * (yz - wx) * sz;
+		out[10] = (1.0f - 2.0f * (xx + yy)) * sz;
+		out[11] = 0.0f;
+		out[12] = tx;
+		out[13] = ty;
+		out[14] = tz;
+		out[15] = 1.0f;
+	}
+
+#ifdef __SSE2__
+	// out = parent * local, both column major
+	static void multiply(const float *parent, const __m128 *local, float *out) {
+		const __m128 p0 = _mm_loadu_ps(parent);
+		const __m128 p1 = _mm_loadu_ps(parent + 4);
+		const __m128 p2 = _mm_loadu_ps(parent + 8);
+		const __m128 p3 = _mm_loadu_ps(parent + 12);
+		for (int column = 0; column < 4; column++) {
+			const __m128 l = local[column];
+			__m128 result = _mm_mul_ps(p0, _mm_shuffle_ps(l, l, _MM_SHUFFLE(0, 0, 0, 0)));
+			result = _mm_add_ps(result, _mm_mul_ps(p1, _mm_shuffle_ps(l, l, _MM_SHUFFLE(1, 1, 1, 1))));
+			result = _mm_add_ps(result, _mm_mul_ps(p2, _mm_shuffle_ps(l, l, _MM_SHUFFLE(2, 2, 2, 2))));
+			result = _mm_add_ps(result, _mm_mul_ps(p3, _mm_shuffle_ps(l, l, _MM_SHUFFLE(3, 3, 3, 3))));
+			_mm_storeu_ps(out + column * 4, result);
+		}
+	}
+#endif
+
+	void SceneGraph::update_worlds() {
+		const auto count = static_cast<uint32_t>(_parent.size());
+
+		// a parent's position is always lower, so its flag is final by the time a child reads it
+		for (uint32_t i = 0; i < count; i++) {
+			if (_parent[i] != NO_NODE) {
+				_dirty[i] |= _dirty[_parent[i]];
+			}
+		}
+
+		_updated = 0;
+		uint32_t i = 0;
+#ifdef __SSE2__
+		// local matrices of four nodes at once, one node per lane, then transposed into a matrix per node
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 two = _mm_set1_ps(2.0f);
+		for (; i + 4 <= count; i += 4) {
+			uint32_t block;
+			std::memcpy(&block, &_dirty[i], sizeof(block));
+			if (block == 0) {
+				continue;
+			}
+
+			const __m128 x = _mm_loadu_ps(&_rx[i]);
+			const __m128 y = _mm_loadu_ps(&_ry[i]);
+			const __m128 z = _mm_loadu_ps(&_rz[i]);
+			const __m128 w = _mm_loadu_ps(&_rw[i]);
+			const __m128 sx = _mm_loadu_ps(&_sx[i]);
+			const __m128 sy = _mm_loadu_ps(&_sy[i]);
+			const __m128 sz = _mm_loadu_ps(&_sz[i]);
+			const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+			const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+			const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+			// columns[c][r] holds row r of column c for all four nodes
+			__m128 columns[4][4];
+			columns[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+			columns[0][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+			columns[0][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+			columns[0][3] = _mm_setzero_ps();
+			columns[1][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+			columns[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+			columns[1][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+			columns[1][3] = _mm_setzero_ps();
+			columns[2][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+			columns[2][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+			columns[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+			columns[2][3] = _mm_setzero_ps();
+			columns[3][0] = _mm_loadu_ps(&_tx[i]);
+			columns[3][1] = _mm_loadu_ps(&_ty[i]);
+			columns[3][2] = _mm_loadu_ps(&_tz[i]);
+			columns[3][3] = one;
+			// afterwards columns[c][lane] is column c of that lane's node
+			for (auto &column : columns) {
+				_MM_TRANSPOSE4_PS(column[0], column[1], column[2], column[3]);
+			}
+
+			// in order, a parent may be an earlier lane of the same block
+			for (uint32_t lane = 0; lane < 4; lane++) {
+				const uint32_t node = i + lane;
+				if (!_dirty[node]) {
+					continue;
+				}
+				const __m128 local[4] = {columns[0][lane], columns[1][lane], columns[2][lane], columns[3][lane]};
+				float *out = &_world[node][0][0];
+				if (_parent[node] == NO_NODE) {
+					for (int column = 0; column < 4; column++) {
+						_mm_storeu_ps(out + column * 4, local[column]);
+					}
+				} else {
+					multiply(&_world[_parent[node]][0][0], local, out);
+				}
+				_updated++;
+			}
+		}
+#endif
+		for (; i < count; i++) {
+			if (!_dirty[i]) {
+				continue;
+			}
+			glm::mat4 local;
+			local_matrix(
+				_rx[i], _ry[i], _rz[i], _rw[i], _tx[i], _ty[i], _tz[i], _sx[i], _sy[i], _sz[i], &local[0][0]
+			);
+			_world[i] = _parent[i] == NO_NODE ? local : _world[_parent[i]] * local;
+			_updated++;
+		}
+
+		std::ranges::fill(_dirty, 0);
+	}
+
+	void SceneGraph::update() {
+		TRACE_SCOPE("SceneGraph::update");
+		if (!_sorted) {
+			sort();
+		}
+		update_worlds();
+	}
+}
@@ -0,0 +1,289 @@
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include "surface.h"
+
+namespace VkDraw {
+	struct KnownFormat {
+		VkFormat format;
+		VkColorSpaceKHR color_space;
+		ColorOutput output;
+		uint32_t bytes_per_pixel;
+		OutputEncoding encoding;
+	};
+
+	static constexpr std::array KNOWN_FORMATS = {
+		KnownFormat{VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR, ColorOutput::SDR, 4, OutputEncoding::NONE},
+		KnownFormat{VK_FORMAT_R8G8B8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR, ColorOutput::SDR, 4, OutputEncoding::NONE},
+		KnownFormat{VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR, ColorOutput::SDR, 4, OutputEncoding::SRGB},
+		KnownFormat{VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR, ColorOutput::SDR, 4, OutputEncoding::SRGB},
+		KnownFormat{
+			VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR, ColorOutput::DEEP, 4,
+			OutputEncoding::SRGB
+		},
+		KnownFormat{
+			VK_FORMAT_A2R10G10B10_UNORM_PACK32, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR, ColorOutput::DEEP, 4,
+			OutputEncoding::SRGB
+		},
+		KnownFormat{
+			VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_COLOR_SPACE_HDR10_ST2084_EXT, ColorOutput::HDR10, 4,
+			OutputEncoding::PQ
+		},
+		KnownFormat{
+			VK_FORMAT_A2R10G10B10_UNORM_PACK32, VK_COLOR_SPACE_HDR10_ST2084_EXT, ColorOutput::HDR10, 4,
+			OutputEncoding::PQ
+		},
+		KnownFormat{
+			VK_FORMAT_R16G16B16A16_SFLOAT, VK_COLOR_SPACE_EXTENDED_SRGB_LINEAR_EXT, ColorOutput::SCRGB, 8,
+			OutputEncoding::NONE
+		}
+	};
+
+	// rank of each known output for a request, lower is better and -1 is unacceptable
+	static int output_rank(ColorOutput requested, ColorOutput output) {
+		switch (requested) {
+			case ColorOutput::SDR:
+				return output == ColorOutput::SDR ? 0 : -1;
+			case ColorOutput::DEEP:
+				switch (output) {
+					case ColorOutput::DEEP:
+						return 0;
+					case ColorOutput::SDR:
+						return 1;
+					default:
+						return -1;
+				}
+			case ColorOutput::HDR:
+				switch (output) {
+					case ColorOutput::HDR10:
+					case ColorOutput::SCRGB:
+						return 0;
+					case ColorOutput::DEEP:
+						return 1;
+					case ColorOutput::SDR:
+						return 2;
+					default:
+						return -1;
+				}
+			case ColorOutput::HDR10:
+			case ColorOutput::SCRGB:
+				if (output == requested) {
+					return 0;
+				}
+				switch (output) {
+					case ColorOutput::HDR10:
+					case ColorOutput::SCRGB:
+						return 1;
+					case ColorOutput::DEEP:
+						return 2;
+					case ColorOutput::SDR:
+						return 3;
+					default:
+						return -1;
+				}
+		}
+		return -1;
+	}
+
+	ColorOutput parse_color_output(std::string_view name) {
+		if (name == "sdr") {
+			return ColorOutput::SDR;
+		}
+		if (name == "10bit") {
+			return ColorOutput::DEEP;
+		}
+		if (name == "hdr") {
+			return ColorOutput::HDR;
+		}
+		if (name == "hdr10") {
+			return ColorOutput::HDR10;
+		}
+		if (name == "scrgb") {
+			return ColorOutput::SCRGB;
+		}
+		throw std::runtime_error("Unknown color output, expected sdr, 10bit, hdr, hdr10 or scrgb!");
+	}
+
+	PresentPreference parse_present_preference(std::string_view name) {
+		if (name == "auto") {
+			return PresentPreference::AUTO;
+		}
+		if (name == "fifo") {
+			return PresentPreference::FIFO;
+		}
+		if (name == "relaxed") {
+			return PresentPreference::RELAXED;
+		}
+		if (name == "mailbox") {
+			return PresentPreference::MAILBOX;
+		}
+		if (name == "immediate") {
+			return PresentPreference::IMMEDIATE;
+		}
+		throw std::runtime_error("Unknown present mode, expected auto, fifo, relaxed, mailbox or immediate!");
+	}
+
+	const char *color_output_name(ColorOutput output) {
+		switch (output) {
+			case ColorOutput::SDR:
+				return "sdr";
+			case ColorOutput::DEEP:
+				return "10bit";
+			case ColorOutput::HDR:
+				return "hdr";
+			case ColorOutput::HDR10:
+				return "hdr10";
+			case ColorOutput::SCRGB:
+				return "scrgb";
+		}
+		return "unknown";
+	}
+
+	const char *present_mode_name(VkPresentModeKHR mode) {
+		switch (mode) {
+			case VK_PRESENT_MODE_IMMEDIATE_KHR:
+				return "immediate";
+			case VK_PRESENT_MODE_MAILBOX_KHR:
+				return "mailbox";
+			case VK_PRESENT_MODE_FIFO_KHR:
+				return "fifo";
+			case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+				return "relaxed";
+			default:
+				return "unknown";
+		}
+	}
+
+	// for a format KNOWN_FORMATS doesn't list, the shader applies whatever transfer function the hardware won't
+	static SurfaceFormatChoice derive_surface_format(VkSurfaceFormatKHR format) {
+		bool srgb_format = false; // the hardware encodes to sRGB on write
+		bool deep = false;
+		uint32_t bytes_per_pixel = 4;
+		switch (format.format) {
+			case VK_FORMAT_R8_SRGB:
+			case VK_FORMAT_R8G8_SRGB:
+			case VK_FORMAT_R8G8B8_SRGB:
+			case VK_FORMAT_B8G8R8_SRGB:
+			case VK_FORMAT_R8G8B8A8_SRGB:
+			case VK_FORMAT_B8G8R8A8_SRGB:
+			case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+				srgb_format = true;
+				break;
+			case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+			case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+				deep = true;
+				break;
+			case VK_FORMAT_R5G6B5_UNORM_PACK16:
+			case VK_FORMAT_B5G6R5_UNORM_PACK16:
+			case VK_FORMAT_R5G5B5A1_UNORM_PACK16:
+			case VK_FORMAT_B5G5R5A1_UNORM_PACK16:
+			case VK_FORMAT_A1R5G5B5_UNORM_PACK16:
+			case VK_FORMAT_R4G4B4A4_UNORM_PACK16:
+			case VK_FORMAT_B4G4R4A4_UNORM_PACK16:
+				bytes_per_pixel = 2;
+				break;
+			case VK_FORMAT_R16G16B16A16_UNORM:
+			case VK_FORMAT_R16G16B16A16_SFLOAT:
+				bytes_per_pixel = 8;
+				break;
+			default:
+				break;
+		}
+
+		switch (format.colorSpace) {
+			case VK_COLOR_SPACE_HDR10_ST2084_EXT:
+				return {format, OutputEncoding::PQ, ColorOutput::HDR10, bytes_per_pixel};
+			case VK_COLOR_SPACE_EXTENDED_SRGB_LINEAR_EXT:
+				return {format, OutputEncoding::NONE, ColorOutput::SCRGB, bytes_per_pixel};
+			// the display takes linear values as they are
+			case VK_COLOR_SPACE_DISPLAY_P3_LINEAR_EXT:
+			case VK_COLOR_SPACE_BT709_LINEAR_EXT:
+			case VK_COLOR_SPACE_BT2020_LINEAR_EXT:
+			case VK_COLOR_SPACE_ADOBERGB_LINEAR_EXT:
+			case VK_COLOR_SPACE_PASS_THROUGH_EXT:
+				return {format, OutputEncoding::NONE, deep ? ColorOutput::DEEP : ColorOutput::SDR, bytes_per_pixel};
+			// sRGB and the other nonlinear spaces, whose curves the sRGB one is the closest we can encode to
+			default:
+				return {
+					format, srgb_format ? OutputEncoding::NONE : OutputEncoding::SRGB,
+					deep ? ColorOutput::DEEP : ColorOutput::SDR, bytes_per_pixel
+				};
+		}
+	}
+
+	SurfaceFormatChoice choose_surface_format(std::span<const VkSurfaceFormatKHR> formats, ColorOutput output) {
+		const KnownFormat *best = nullptr;
+		int best_rank = -1;
+
+		for (const auto &known : KNOWN_FORMATS) {
+			const int rank = output_rank(output, known.output);
+			if (rank < 0) {
+				continue;
+			}
+
+			bool supported = false;
+			for (const auto &format : formats) {
+				if (format.format == known.format && format.colorSpace == known.color_space) {
+					supported = true;
+					break;
+				}
+			}
+			if (!supported) {
+				continue;
+			}
+
+			if (best == nullptr || rank < best_rank ||
+				(rank == best_rank && known.bytes_per_pixel < best->bytes_per_pixel) ||
+				(rank == best_rank && known.bytes_per_pixel == best->bytes_per_pixel &&
+					known.encoding == OutputEncoding::NONE && best->encoding != OutputEncoding::NONE)) {
+				best = &known;
+				best_rank = rank;
+			}
+		}
+
+		if (best == nullptr) {
+			// none of the formats we rank is supported, the first is the implementation's preference
+			return derive_surface_format(formats[0]);
+		}
+
+		return {{best->format, best->color_space}, best->encoding, best->output, best->bytes_per_pixel};
+	}
+
+	VkPresentModeKHR choose_present_mode(
+		std::span<const VkPresentModeKHR> modes, PresentPreference preference, bool low_power
+	) {
+		// fifo is always supported so every list ends with it
+		std::vector<VkPresentModeKHR> ranked;
+		switch (preference) {
+			case PresentPreference::AUTO:
+				// mailbox renders frames that are never shown, not worth the power on low power devices
+				if (!low_power) {
+					ranked.push_back(VK_PRESENT_MODE_MAILBOX_KHR);
+				}
+				break;
+			case PresentPreference::FIFO:
+				break;
+			case PresentPreference::RELAXED:
+				ranked.push_back(VK_PRESENT_MODE_FIFO_RELAXED_KHR);
+				break;
+			case PresentPreference::MAILBOX:
+				ranked.push_back(VK_PRESENT_MODE_MAILBOX_KHR);
+				break;
+			case PresentPreference::IMMEDIATE:
+				ranked.push_back(VK_PRESENT_MODE_IMMEDIATE_KHR);
+				ranked.push_back(VK_PRESENT_MODE_MAILBOX_KHR);
+				break;
+		}
+		ranked.push_back(VK_PRESENT_MODE_FIFO_KHR);
+
+		for (const auto mode : ranked) {
+			for (const auto supported : modes) {
+				if (mode == supported) {
+					return mode;
+				}
+			}
+		}
+		return VK_PRESENT_MODE_FIFO_KHR;
+	}
+}
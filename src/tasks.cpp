@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+
+#include "tasks.h"
+
+namespace VkDraw {
+	static thread_local uint32_t _worker_index = std::numeric_limits<uint32_t>::max();
+	// set on the thread running a fork, which already holds _fork_mutex and must not lock it again
+	static thread_local bool _forking = false;
+
+	ThreadPool::ThreadPool(uint32_t threads) {
+		threads = std::max(threads, 1u);
+		_workers.reserve(threads);
+		for (uint32_t i = 0; i < threads; i++) {
+			_workers.emplace_back(&ThreadPool::worker_loop, this, i);
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::scoped_lock lock(_mutex);
+			_stopping = true;
+		}
+		_cv.notify_all();
+		for (auto &worker : _workers) {
+			worker.join();
+		}
+	}
+
+	void ThreadPool::submit(std::function<void()> job) {
+		{
+			std::scoped_lock lock(_mutex);
+			_jobs.push_back(std::move(job));
+		}
+		_cv.notify_one();
+	}
+
+	uint32_t ThreadPool::worker_index() const {
+		return std::min<uint32_t>(_worker_index, _workers.size());
+	}
+
+	void ThreadPool::fork(uint32_t chunks, void (*call)(const void *fn, uint32_t chunk), const void *fn) {
+		std::unique_lock fork_lock(_fork_mutex, std::defer_lock);
+		if (_forking || !fork_lock.try_lock()) {
+			for (uint32_t chunk = 0; chunk < chunks; chunk++) {
+				call(fn, chunk);
+			}
+			return;
+		}
+
+		{
+			std::scoped_lock lock(_mutex);
+			_fork_call = call;
+			_fork_fn = fn;
+			_fork_chunks = chunks;
+			_fork_next = 0;
+		}
+		_cv.notify_all();
+		_forking = true;
+		run_fork();
+		_forking = false;
+
+		// every chunk has been claimed, so once the workers that joined have left all of them have finished
+		std::unique_lock lock(_mutex);
+		_fork_cv.wait(lock, [this] { return _fork_workers == 0; });
+		_fork_call = nullptr;
+		_fork_fn = nullptr;
+		_fork_chunks = 0;
+	}
+
+	void ThreadPool::run_fork() {
+		for (uint32_t chunk = _fork_next++; chunk < _fork_chunks; chunk = _fork_next++) {
+			_fork_call(_fork_fn, chunk);
+		}
+	}
+
+	void ThreadPool::worker_loop(uint32_t index) {
+		_worker_index = index;
+
+		while (true) {
+			std::function<void()> job;
+			{
+				std::unique_lock lock(_mutex);
+				_cv.wait(lock, [this] { return _stopping || !_jobs.empty() || _fork_next < _fork_chunks; });
+				if (_fork_next < _fork_chunks) {
+					_fork_workers++;
+					lock.unlock();
+					run_fork();
+					lock.lock();
+					if (--_fork_workers == 0) {
+						_fork_cv.notify_one();
+					}
+					continue;
+				}
+				if (_jobs.empty()) {
+					return;
+				}
+				job = std::move(_jobs.front());
+				_jobs.pop_front();
+			}
+			job();
+		}
+	}
+
+	TaskGraph::TaskId TaskGraph::add(
+		std::string_view name, std::function<void()> fn, std::initializer_list<TaskId> deps, bool main_thread
+	) {
+		const auto id = static_cast<TaskId>(_tasks.size());
+
+		Task task;
+		task.name = name;
+		task.fn = std::move(fn);
+		task.main_thread = main_thread;
+		task.pending = deps.size();
+		_tasks.push_back(std::move(task));
+
+		for (const auto dep : deps) {
+			if (dep >= id) {
+				throw std::runtime_error("Task dependencies must be added before their dependents!");
+			}
+			_tasks[dep].dependents.push_back(id);
+		}
+
+		return id;
+	}
+
+	void TaskGraph::schedule(TaskId id, ThreadPool &pool) {
+		// must be called with _mutex held
+		_running++;
+		if (_tasks[id].main_thread) {
+			_main_queue.push_back(id);
+		} else {
+			pool.submit([this, id, &pool] {
+				execute(id, pool, pool.worker_index());
+			});
+		}
+	}
+
+	void TaskGraph::execute(TaskId id, ThreadPool &pool, uint32_t thread) {
+		auto &task = _tasks[id];
+
+		bool skip;
+		{
+			std::scoped_lock lock(_mutex);
+			skip = _error != nullptr;
+		}
+
+		std::exception_ptr error;
+		if (!skip) {
+			task.thread = thread;
+			task.start = Clock::now();
+			try {
+				task.fn();
+			} catch (...) {
+				error = std::current_exception();
+			}
+			task.end = Clock::now();
+		}
+
+		std::scoped_lock lock(_mutex);
+		_running--;
+		if (error && !_error) {
+			_error = error;
+		}
+		if (!skip && !error) {
+			_finished++;
+			if (!_error) {
+				for (const auto dependent : task.dependents) {
+					if (--_tasks[dependent].pending == 0) {
+						schedule(dependent, pool);
+					}
+				}
+			}
+		}
+		_cv.notify_all();
+	}
+
+	void TaskGraph::run(ThreadPool &pool) {
+		_epoch = Clock::now();
+
+		std::unique_lock lock(_mutex);
+		for (TaskId id = 0; id < _tasks.size(); id++) {
+			if (_tasks[id].pending == 0) {
+				schedule(id, pool);
+			}
+		}
+
+		while (true) {
+			_cv.wait(lock, [this] { return !_main_queue.empty() || _running == 0; });
+			if (_main_queue.empty()) {
+				break;
+			}
+
+			const auto id = _main_queue.front();
+			_main_queue.pop_front();
+
+			lock.unlock();
+			execute(id, pool, pool.size());
+			lock.lock();
+		}
+
+		if (_error) {
+			std::rethrow_exception(_error);
+		}
+		if (_finished != _tasks.size()) {
+			throw std::runtime_error("Task graph finished with unscheduled tasks!");
+		}
+	}
+
+	void TaskGraph::print_timeline(Clock::time_point end) const {
+		static constexpr size_t BAR_WIDTH = 48;
+
+		auto ms = [this](Clock::time_point t) {
+			return std::chrono::duration<double, std::milli>(t - _epoch).count();
+		};
+		const double total = std::max(ms(end), 0.001);
+
+		std::printf("Startup: %.1fms timeline {\n", total);
+		for (const auto &task : _tasks) {
+			const auto first = std::min(static_cast<size_t>(ms(task.start) / total * BAR_WIDTH), BAR_WIDTH - 1);
+			const auto last = std::clamp(
+				static_cast<size_t>(ms(task.end) / total * BAR_WIDTH), first + 1, BAR_WIDTH
+			);
+
+			std::string bar(BAR_WIDTH, ' ');
+			std::fill(bar.begin() + first, bar.begin() + last, '#');
+
+			char thread[16];
+			if (task.main_thread) {
+				std::snprintf(thread, sizeof(thread), "main");
+			} else {
+				std::snprintf(thread, sizeof(thread), "worker %u", task.thread);
+			}
+
+			std::printf(
+				"\t%7.1fms %7.1fms %-9s |%s| %s\n",
+				ms(task.start), ms(task.end) - ms(task.start), thread, bar.c_str(), task.name.c_str()
+			);
+		}
+		std::printf("}\n");
+	}
+}
@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "text.h"
+
+namespace VkDraw {
+	static constexpr uint32_t GLYPH_GAP = 1; // pixels between glyphs in a page, so filtering never bleeds
+	static constexpr double FAR = 1e20; // squared distance of samples with no edge nearby
+	static constexpr uint32_t REPLACEMENT_CHARACTER = 0xfffd;
+
+	// Felzenszwalb and Huttenlocher's squared distance transform along one row or column, the lower
+	// envelope of the parabolas rooted at each sample
+	static void transform_line(double *grid, size_t stride, size_t length, double *f, double *z, uint32_t *v) {
+		for (size_t q = 0; q < length; q++) {
+			f[q] = grid[q * stride];
+		}
+
+		size_t k = 0;
+		v[0] = 0;
+		z[0] = -std::numeric_limits<double>::infinity();
+		z[1] = std::numeric_limits<double>::infinity();
+		for (size_t q = 1; q < length; q++) {
+			const auto qd = static_cast<double>(q);
+			double s;
+			while (true) {
+				const auto r = static_cast<double>(v[k]);
+				s = (f[q] + qd * qd - f[v[k]] - r * r) / (2.0 * (qd - r));
+				if (s > z[k]) {
+					break;
+				}
+				k--;
+			}
+			k++;
+			v[k] = q;
+			z[k] = s;
+			z[k + 1] = std::numeric_limits<double>::infinity();
+		}
+
+		k = 0;
+		for (size_t q = 0; q < length; q++) {
+			while (z[k + 1] < static_cast<double>(q)) {
+				k++;
+			}
+			const double offset = static_cast<double>(q) - v[k];
+			grid[q * stride] = offset * offset + f[v[k]];
+		}
+	}
+
+	void FontAtlas::init(PageCreator create_page) {
+		_create_page = std::move(create_page);
+	}
+
+	void FontAtlas::shutdown() {
+		for (const auto &font : _fonts) {
+			TTF_CloseFont(font.font);
+		}
+		if (TTF_WasInit()) {
+			TTF_Quit();
+		}
+
+		_create_page = nullptr;
+		_fonts.clear();
+		_font_paths.clear();
+		_pages.clear();
+		_uploads.clear();
+	}
+
+	FontId FontAtlas::load(const char *path) {
+		if (!_create_page) {
+			throw std::runtime_error("Fonts can only be loaded while running!");
+		}
+		if (auto it = _font_paths.find(path); it != _font_paths.end()) {
+			return it->second;
+		}
+
+		if (!TTF_WasInit() && TTF_Init() != 0) {
+			throw std::runtime_error("Failed to initialize SDL_ttf!");
+		}
+		TTF_Font *font = TTF_OpenFont(path, GLYPH_SIZE);
+		if (!font) {
+			throw std::runtime_error("Failed to load font!");
+		}
+
+		_fonts.push_back({
+			font, static_cast<float>(TTF_FontAscent(font)), static_cast<float>(TTF_FontLineSkip(font)), {}
+		});
+		_font_paths.emplace(path, _fonts.size() - 1);
+		return _fonts.size() - 1;
+	}
+
+	const Glyph &FontAtlas::glyph(FontId font, uint32_t codepoint) {
+		auto &entry = _fonts[font];
+		if (auto it = entry.glyphs.find(codepoint); it != entry.glyphs.end()) {
+			return it->second;
+		}
+		return entry.glyphs.emplace(codepoint, rasterize(entry, codepoint)).first->second;
+	}
+
+	float FontAtlas::kerning(FontId font, uint32_t previous, uint32_t codepoint) {
+		return static_cast<float>(TTF_GetFontKerningSizeGlyphs32(_fonts[font].font, previous, codepoint));
+	}
+
+	Glyph FontAtlas::rasterize(const Font &font, uint32_t codepoint) {
+		Glyph glyph{};
+		int min_x, max_x, min_y, max_y, advance;
+		if (TTF_GlyphMetrics32(font.font, codepoint, &min_x, &max_x, &min_y, &max_y, &advance) != 0) {
+			return glyph;
+		}
+		glyph.advance = static_cast<float>(advance);
+
+		SDL_Surface *img = TTF_RenderGlyph32_Blended(font.font, codepoint, {255, 255, 255, 255});
+		if (!img) {
+			return glyph;
+		}
+
+		// the surface is ARGB, its left edge is the pen position or the glyph's left edge if that
+		// overhangs it, and its top edge is the font's ascent above the baseline
+		const auto coverage = [img](int x, int y) {
+			const auto *row = static_cast<const uint8_t *>(img->pixels) + static_cast<ptrdiff_t>(y) * img->pitch;
+			uint32_t pixel;
+			memcpy(&pixel, row + x * 4, sizeof(pixel));
+			return static_cast<uint8_t>(pixel >> 24);
+		};
+
+		// crop to the pixels the glyph actually covers
+		int left = img->w, top = img->h, right = 0, bottom = 0;
+		for (int y = 0; y < img->h; y++) {
+			for (int x = 0; x < img->w; x++) {
+				if (coverage(x, y) != 0) {
+					left = std::min(left, x);
+					right = std::max(right, x + 1);
+					top = std::min(top, y);
+					bottom = std::max(bottom, y + 1);
+				}
+			}
+		}
+		if (left >= right) {
+			SDL_FreeSurface(img);
+			return glyph;
+		}
+
+		// coverage becomes the squared distances to the nearest edge from outside and inside, partly
+		// covered pixels are treated as an edge offset by their coverage
+		const uint32_t width = right - left + SPREAD * 2;
+		const uint32_t height = bottom - top + SPREAD * 2;
+		_outer.assign(static_cast<size_t>(width) * height, FAR);
+		_inner.assign(static_cast<size_t>(width) * height, 0.0);
+		for (int y = top; y < bottom; y++) {
+			for (int x = left; x < right; x++) {
+				const double a = coverage(x, y) / 255.0;
+				const size_t i = (y - top + SPREAD) * width + (x - left + SPREAD);
+				if (a >= 1.0) {
+					_outer[i] = 0.0;
+					_inner[i] = FAR;
+				} else if (a > 0.0) {
+					const double d = 0.5 - a;
+					_outer[i] = d > 0.0 ? d * d : 0.0;
+					_inner[i] = d < 0.0 ? d * d : 0.0;
+				}
+			}
+		}
+		SDL_FreeSurface(img);
+
+		const size_t longest = std::max(width, height);
+		_line.resize(longest);
+		_bounds.resize(longest + 1);
+		_parabolas.resize(longest);
+		for (auto *grid : {_outer.data(), _inner.data()}) {
+			for (uint32_t x = 0; x < width; x++) {
+				transform_line(grid + x, width, height, _line.data(), _bounds.data(), _parabolas.data());
+			}
+			for (uint32_t y = 0; y < height; y++) {
+				transform_line(
+					grid + static_cast<size_t>(y) * width, 1, width, _line.data(), _bounds.data(), _parabolas.data()
+				);
+			}
+		}
+
+		uint32_t x, y;
+		glyph.page = place(width, height, x, y);
+		auto &page = _pages[glyph.page];
+
+		// 0.5 on the outline, increasing inwards and reaching 0 and 1 at SPREAD pixels either side
+		for (uint32_t row = 0; row < height; row++) {
+			uint8_t *out = page.pixels.data() + static_cast<size_t>(y + row) * PAGE_SIZE + x;
+			for (uint32_t column = 0; column < width; column++) {
+				const size_t i = static_cast<size_t>(row) * width + column;
+				const double distance = std::sqrt(_outer[i]) - std::sqrt(_inner[i]);
+				const double value = std::clamp(0.5 - distance / (2.0 * SPREAD), 0.0, 1.0);
+				out[column] = static_cast<uint8_t>(value * 255.0 + 0.5);
+			}
+		}
+		page.dirty_begin = std::min(page.dirty_begin, y);
+		page.dirty_end = std::max(page.dirty_end, y + height);
+
+		const float origin_x = static_cast<float>(std::min(min_x, 0));
+		glyph.offset = {
+			origin_x + static_cast<float>(left) - SPREAD, static_cast<float>(top) - font.ascent - SPREAD
+		};
+		glyph.size = {static_cast<float>(width), static_cast<float>(height)};
+		glyph.uv_min = {static_cast<float>(x) / PAGE_SIZE, static_cast<float>(y) / PAGE_SIZE};
+		glyph.uv_max = {static_cast<float>(x + width) / PAGE_SIZE, static_cast<float>(y + height) / PAGE_SIZE};
+		return glyph;
+	}
+
+	uint32_t FontAtlas::place(uint32_t width, uint32_t height, uint32_t &x, uint32_t &y) {
+		if (width > PAGE_SIZE || height > PAGE_SIZE) {
+			throw std::runtime_error("Glyph is too large for the font atlas!");
+		}
+
+		if (!_pages.empty()) {
+			auto &page = _pages.back();
+			if (page.shelf_x + width > PAGE_SIZE) {
+				page.shelf_y += page.shelf_height + GLYPH_GAP;
+				page.shelf_x = 0;
+				page.shelf_height = 0;
+			}
+			if (page.shelf_y + height <= PAGE_SIZE) {
+				x = page.shelf_x;
+				y = page.shelf_y;
+				page.shelf_x += width + GLYPH_GAP;
+				page.shelf_height = std::max(page.shelf_height, height);
+				return _pages.size() - 1;
+			}
+		}
+
+		// new pages are uploaded whole the first time, the zeroed pixels are far outside every glyph
+		Page page;
+		page.texture = _create_page();
+		page.pixels.assign(static_cast<size_t>(PAGE_SIZE) * PAGE_SIZE, 0);
+		page.shelf_x = width + GLYPH_GAP;
+		page.shelf_height = height;
+		_pages.push_back(std::move(page));
+
+		x = 0;
+		y = 0;
+		return _pages.size() - 1;
+	}
+
+	std::span<const AtlasUpload> FontAtlas::flush(const Canvas::Allocator &allocate) {
+		_uploads.clear();
+		for (auto &page : _pages) {
+			if (page.dirty_begin >= page.dirty_end) {
+				continue;
+			}
+
+			const uint32_t rows = page.dirty_end - page.dirty_begin;
+			const VkDeviceSize size = static_cast<VkDeviceSize>(rows) * PAGE_SIZE;
+			const auto alloc = allocate(size);
+			memcpy(alloc.data, page.pixels.data() + static_cast<size_t>(page.dirty_begin) * PAGE_SIZE, size);
+			_uploads.push_back({page.texture, !page.uploaded, page.dirty_begin, rows, alloc.buffer, alloc.offset});
+
+			page.uploaded = true;
+			page.dirty_begin = PAGE_SIZE;
+			page.dirty_end = 0;
+		}
+		return _uploads;
+	}
+
+	FontAtlas &font_atlas() {
+		static FontAtlas instance;
+		return instance;
+	}
+
+	// invalid sequences decode to U+FFFD, skipping only the bytes that were consumed
+	static uint32_t next_codepoint(std::string_view text, size_t &i) {
+		const auto lead = static_cast<uint8_t>(text[i++]);
+		if (lead < 0x80) {
+			return lead;
+		}
+
+		uint32_t length;
+		uint32_t codepoint;
+		if ((lead & 0xe0) == 0xc0) {
+			length = 1;
+			codepoint = lead & 0x1f;
+		} else if ((lead & 0xf0) == 0xe0) {
+			length = 2;
+			codepoint = lead & 0x0f;
+		} else if ((lead & 0xf8) == 0xf0) {
+			length = 3;
+			codepoint = lead & 0x07;
+		} else {
+			return REPLACEMENT_CHARACTER;
+		}
+
+		for (uint32_t n = 0; n < length; n++) {
+			if (i >= text.size() || (static_cast<uint8_t>(text[i]) & 0xc0) != 0x80) {
+				return REPLACEMENT_CHARACTER;
+			}
+			codepoint = codepoint << 6 | (static_cast<uint8_t>(text[i++]) & 0x3f);
+		}
+		return codepoint;
+	}
+
+	static void check_font(FontId font) {
+		if (font >= font_atlas().font_count()) {
+			throw std::runtime_error("Font id is out of range!");
+		}
+	}
+
+	FontId load_font(const char *path) {
+		return font_atlas().load(path);
+	}
+
+	void draw_text(FontId font, Vec2 pos, float size, std::string_view text, Color color) {
+		check_font(font);
+		auto &atlas = font_atlas();
+		auto &target = canvas();
+
+		// glyphs on the same page batch into one instanced draw, whatever font or size they are
+		const float scale = size / FontAtlas::GLYPH_SIZE;
+		const float range = 2.0f * FontAtlas::SPREAD * scale;
+		const uint32_t packed = pack_color(color);
+		Vec2 pen = {pos.x, pos.y + atlas.ascent(font) * scale};
+		uint32_t previous = 0;
+		for (size_t i = 0; i < text.size();) {
+			const uint32_t codepoint = next_codepoint(text, i);
+			if (codepoint == '\n') {
+				pen = {pos.x, pen.y + atlas.line_height(font) * scale};
+				previous = 0;
+				continue;
+			}
+			if (previous != 0) {
+				pen.x += atlas.kerning(font, previous, codepoint) * scale;
+			}
+			previous = codepoint;
+
+			const Glyph &glyph = atlas.glyph(font, codepoint);
+			if (glyph.size.x > 0.0f) {
+				*target.push_glyphs(atlas.page_texture(glyph.page)) = {
+					{pen.x + glyph.offset.x * scale, pen.y + glyph.offset.y * scale},
+					{glyph.size.x * scale, 0.0f}, {0.0f, glyph.size.y * scale},
+					glyph.uv_min, glyph.uv_max, packed, range
+				};
+			}
+			pen.x += glyph.advance * scale;
+		}
+	}
+
+	Vec2 measure_text(FontId font, float size, std::string_view text) {
+		check_font(font);
+		auto &atlas = font_atlas();
+
+		const float scale = size / FontAtlas::GLYPH_SIZE;
+		float width = 0.0f;
+		float line = 0.0f;
+		uint32_t lines = 1;
+		uint32_t previous = 0;
+		for (size_t i = 0; i < text.size();) {
+			const uint32_t codepoint = next_codepoint(text, i);
+			if (codepoint == '\n') {
+				width = std::max(width, line);
+				line = 0.0f;
+				lines++;
+				previous = 0;
+				continue;
+			}
+			if (previous != 0) {
+				line += atlas.kerning(font, previous, codepoint) * scale;
+			}
+			previous = codepoint;
+			line += atlas.glyph(font, codepoint).advance * scale;
+		}
+		return {std::max(width, line), static_cast<float>(lines) * atlas.line_height(font) * scale};
+	}
+}
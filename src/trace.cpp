@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "trace.h"
+
+namespace VkDraw {
+	struct TraceEvent {
+		const char *name;
+		int64_t start_ns;
+		int64_t duration_ns;
+	};
+
+	// written only by its owning thread, head is published with release so a reader that acquires it sees
+	// every event before it
+	struct TraceTrack {
+		std::string name;
+		uint32_t id;
+		std::atomic<uint64_t> head = 0;
+		std::array<TraceEvent, TRACE_CAPACITY> events;
+
+		void push(const TraceEvent &event) {
+			const auto index = head.load(std::memory_order_relaxed);
+			events[index % TRACE_CAPACITY] = event;
+			head.store(index + 1, std::memory_order_release);
+		}
+	};
+
+	static std::atomic<bool> _tracing = false;
+	static int64_t _trace_start = 0;
+	static std::mutex _tracks_mutex; // guards registration, never taken while recording
+	static std::vector<std::unique_ptr<TraceTrack>> _tracks;
+	static TraceTrack *_gpu_track = nullptr;
+	static thread_local TraceTrack *_thread_track = nullptr;
+	static thread_local const char *_thread_name = nullptr;
+
+	static TraceTrack *register_track(std::string name) {
+		std::scoped_lock lock(_tracks_mutex);
+		auto track = std::make_unique<TraceTrack>();
+		track->id = _tracks.size();
+		track->name = name.empty() ? "thread " + std::to_string(track->id) : std::move(name);
+		_tracks.push_back(std::move(track));
+		return _tracks.back().get();
+	}
+
+	void start_trace() {
+		if (_tracing.load()) {
+			return;
+		}
+		_gpu_track = register_track("GPU");
+		_trace_start = trace_now();
+		_tracing.store(true);
+	}
+
+	bool tracing() {
+		return _tracing.load(std::memory_order_relaxed);
+	}
+
+	void set_trace_thread_name(const char *name) {
+		_thread_name = name;
+		if (_thread_track != nullptr) {
+			std::scoped_lock lock(_tracks_mutex);
+			_thread_track->name = name;
+		}
+	}
+
+	void trace_event(const char *name, int64_t start_ns, int64_t duration_ns) {
+		if (!tracing()) {
+			return;
+		}
+		if (_thread_track == nullptr) {
+			_thread_track = register_track(_thread_name != nullptr ? _thread_name : "");
+		}
+		_thread_track->push({name, start_ns, duration_ns});
+	}
+
+	void trace_gpu_event(const char *name, int64_t start_ns, int64_t duration_ns) {
+		if (!tracing()) {
+			return;
+		}
+		_gpu_track->push({name, start_ns, duration_ns});
+	}
+
+	static void write_string(std::FILE *file, const char *str) {
+		std::fputc('"', file);
+		for (; *str != '\0'; str++) {
+			if (*str == '"' || *str == '\\') {
+				std::fputc('\\', file);
+			}
+			std::fputc(*str, file);
+		}
+		std::fputc('"', file);
+	}
+
+	void write_trace(const char *path) {
+		_tracing.store(false);
+
+		std::FILE *file = std::fopen(path, "w");
+		if (file == nullptr) {
+			throw std::runtime_error("Failed to open trace output: " + std::string(path));
+		}
+
+		std::scoped_lock lock(_tracks_mutex);
+		std::fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+		std::fprintf(file, "{\"ph\": \"M\", \"pid\": 1, \"name\": \"process_name\", \"args\": {\"name\": \"VkDraw\"}}");
+		for (const auto &track : _tracks) {
+			std::fprintf(
+				file, ",\n{\"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"name\": \"thread_name\", \"args\": {\"name\": ",
+				track->id
+			);
+			write_string(file, track->name.c_str());
+			std::fprintf(file, "}}");
+			// the GPU first, then threads in the order they started recording
+			std::fprintf(
+				file,
+				",\n{\"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"name\": \"thread_sort_index\", "
+				"\"args\": {\"sort_index\": %u}}",
+				track->id, track->id
+			);
+
+			// oldest first, once the ring has wrapped the oldest event is the one after the newest
+			const auto head = track->head.load(std::memory_order_acquire);
+			const auto count = std::min<uint64_t>(head, TRACE_CAPACITY);
+			for (uint64_t i = head - count; i < head; i++) {
+				const auto &event = track->events[i % TRACE_CAPACITY];
+				std::fprintf(file, ",\n{\"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"name\": ", track->id);
+				write_string(file, event.name);
+				// microseconds, with nanosecond precision
+				std::fprintf(
+					file, ", \"ts\": %.3f, \"dur\": %.3f}",
+					static_cast<double>(event.start_ns - _trace_start) / 1000.0,
+					static_cast<double>(event.duration_ns) / 1000.0
+				);
+			}
+		}
+		std::fprintf(file, "\n]}\n");
+
+		const bool failed = std::ferror(file) != 0;
+		std::fclose(file);
+		if (failed) {
+			throw std::runtime_error("Failed to write trace output: " + std::string(path));
+		}
+	}
+}
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+#include "validation.h"
+
+namespace VkDraw {
+	ValidationMode parse_validation_mode(std::string_view name) {
+		if (name == "off") {
+			return ValidationMode::OFF;
+		}
+		if (name == "standard") {
+			return ValidationMode::STANDARD;
+		}
+		if (name == "gpu") {
+			return ValidationMode::GPU_ASSISTED;
+		}
+		if (name == "sync") {
+			return ValidationMode::SYNCHRONIZATION;
+		}
+		if (name == "best-practices") {
+			return ValidationMode::BEST_PRACTICES;
+		}
+		throw std::runtime_error("Unknown validation mode, expected off, standard, gpu, sync or best-practices!");
+	}
+
+	std::vector<VkValidationFeatureEnableEXT> validation_features(ValidationMode mode) {
+		switch (mode) {
+			case ValidationMode::GPU_ASSISTED:
+				return {
+					VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_EXT,
+					VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_RESERVE_BINDING_SLOT_EXT
+				};
+			case ValidationMode::SYNCHRONIZATION:
+				return {VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT};
+			case ValidationMode::BEST_PRACTICES:
+				return {VK_VALIDATION_FEATURE_ENABLE_BEST_PRACTICES_EXT};
+			default:
+				return {};
+		}
+	}
+
+	static const char *severity_name(VkDebugUtilsMessageSeverityFlagBitsEXT severity) {
+		if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+			return "error";
+		}
+		if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
+			return "warning";
+		}
+		if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT) {
+			return "info";
+		}
+		return "verbose";
+	}
+
+	VkDebugUtilsMessengerCreateInfoEXT ValidationSink::create_info() {
+		VkDebugUtilsMessengerCreateInfoEXT info{};
+		info.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+		info.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+		info.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+		info.pfnUserCallback = &ValidationSink::callback;
+		info.pUserData = this;
+		return info;
+	}
+
+	void ValidationSink::init(VkInstance instance) {
+		const auto create = reinterpret_cast<PFN_vkCreateDebugUtilsMessengerEXT>(
+			vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT")
+		);
+		if (create == nullptr) {
+			throw std::runtime_error("Failed to load vkCreateDebugUtilsMessengerEXT!");
+		}
+
+		const auto info = create_info();
+		if (create(instance, &info, nullptr, &_messenger) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create debug messenger!");
+		}
+	}
+
+	void ValidationSink::destroy(VkInstance instance) {
+		if (_messenger == VK_NULL_HANDLE) {
+			return;
+		}
+
+		const auto destroy = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
+			vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT")
+		);
+		destroy(instance, _messenger, nullptr);
+		_messenger = VK_NULL_HANDLE;
+	}
+
+	uint32_t ValidationSink::errors() const {
+		std::scoped_lock lock(_mutex);
+		return _errors;
+	}
+
+	uint32_t ValidationSink::warnings() const {
+		std::scoped_lock lock(_mutex);
+		return _warnings;
+	}
+
+	VkBool32 ValidationSink::callback(
+		VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT,
+		const VkDebugUtilsMessengerCallbackDataEXT *data, void *user
+	) {
+		static_cast<ValidationSink *>(user)->record(severity, *data);
+		return VK_FALSE; // the call that caused the message must carry on as normal
+	}
+
+	void ValidationSink::record(
+		VkDebugUtilsMessageSeverityFlagBitsEXT severity, const VkDebugUtilsMessengerCallbackDataEXT &data
+	) {
+		std::scoped_lock lock(_mutex);
+
+		if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+			_errors++;
+		} else {
+			_warnings++;
+		}
+
+		auto &message = _messages[data.messageIdNumber];
+		if (message.count++ == 0) {
+			message.name = data.pMessageIdName != nullptr ? data.pMessageIdName : "";
+			message.severity = severity;
+			std::fprintf(
+				stderr, "Validation %s: %s\n", severity_name(severity), data.pMessage != nullptr ? data.pMessage : ""
+			);
+		}
+	}
+
+	void ValidationSink::print_summary() const {
+		std::scoped_lock lock(_mutex);
+		if (_messages.empty()) {
+			std::printf("Validation: no warnings or errors\n");
+			return;
+		}
+
+		std::vector<std::pair<int32_t, const Message *>> sorted;
+		for (const auto &[id, message] : _messages) {
+			sorted.emplace_back(id, &message);
+		}
+		std::ranges::sort(sorted, [](const auto &a, const auto &b) { return a.second->count > b.second->count; });
+
+		std::printf("Validation: %u error/s, %u warning/s {\n", _errors, _warnings);
+		for (const auto &[id, message] : sorted) {
+			std::printf(
+				"\t%8ux %-7s %#010x %s\n", message->count, severity_name(message->severity),
+				static_cast<uint32_t>(id), message->name.c_str()
+			);
+		}
+		std::printf("}\n");
+	}
+}
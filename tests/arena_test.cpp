@@ -0,0 +1,87 @@
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "arena.h"
+#include "check.h"
+
+using namespace VkDraw;
+
+// counts what the arena asks of its upstream, so steady state frames can be shown not to allocate
+class CountingResource final : public std::pmr::memory_resource {
+public:
+	uint64_t allocations = 0;
+	uint64_t deallocations = 0;
+
+private:
+	void *do_allocate(size_t bytes, size_t alignment) override {
+		allocations++;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void *ptr, size_t bytes, size_t alignment) override {
+		deallocations++;
+		std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+		return this == &other;
+	}
+};
+
+static void test_alignment() {
+	FrameArena arena(1024);
+	for (const size_t alignment : {1, 2, 4, 8, 16, 32, 64}) {
+		void *ptr = arena.allocate(3, alignment);
+		CHECK(reinterpret_cast<uintptr_t>(ptr) % alignment == 0);
+	}
+	CHECK(arena.stats().allocations == 7);
+	CHECK(arena.stats().upstream_allocations == 0);
+}
+
+static void test_overflow_grows() {
+	CountingResource upstream;
+	{
+		FrameArena arena(256, &upstream);
+		CHECK(upstream.allocations == 1);
+
+		// a frame four times the capacity overflows, the arena then grows so the same frame fits in one block
+		for (int i = 0; i < 16; i++) {
+			CHECK(arena.allocate(64, 16) != nullptr);
+		}
+		const auto stats = arena.reset();
+		CHECK(stats.allocations == 16);
+		CHECK(stats.upstream_allocations > 0);
+		CHECK(arena.capacity() >= stats.bytes);
+
+		const auto before = upstream.allocations;
+		for (int frame = 0; frame < 4; frame++) {
+			for (int i = 0; i < 16; i++) {
+				CHECK(arena.allocate(64, 16) != nullptr);
+			}
+			CHECK(arena.reset().upstream_allocations == 0);
+		}
+		CHECK(upstream.allocations == before);
+	}
+	CHECK(upstream.allocations == upstream.deallocations);
+}
+
+static void test_pmr_container() {
+	FrameArena arena(64);
+	std::pmr::vector<uint32_t> values(&arena);
+	for (uint32_t i = 0; i < 1000; i++) {
+		values.push_back(i);
+	}
+	bool ordered = true;
+	for (uint32_t i = 0; i < 1000; i++) {
+		ordered &= values[i] == i;
+	}
+	CHECK(ordered);
+}
+
+int main() {
+	test_alignment();
+	test_overflow_grows();
+	test_pmr_container();
+	return TEST_RESULT;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdio>
+
+// the few assertions the unit tests need, a failed check is reported and counted rather than aborting the test,
+// each test's main returns TEST_RESULT so ctest sees any failure
+namespace VkDraw::Test {
+	inline int failures = 0;
+}
+
+#define CHECK(expr) \
+	do { \
+		if (!(expr)) { \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+			::VkDraw::Test::failures++; \
+		} \
+	} while (0)
+
+#define CHECK_THROWS(expr) \
+	do { \
+		bool threw = false; \
+		try { \
+			(void)(expr); \
+		} catch (...) { \
+			threw = true; \
+		} \
+		if (!threw) { \
+			std::fprintf(stderr, "%s:%d: expected an exception: %s\n", __FILE__, __LINE__, #expr); \
+			::VkDraw::Test::failures++; \
+		} \
+	} while (0)
+
+#define TEST_RESULT (::VkDraw::Test::failures == 0 ? 0 : 1)
@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "check.h"
+#include "cull.h"
+
+using namespace VkDraw;
+
+// the identity view_proj makes the frustum the clip volume, x and y in [-1, 1] and z in [0, 1]
+static bool touches_clip_volume(glm::vec3 center, float radius) {
+	return center.x >= -1.0f - radius && center.x <= 1.0f + radius && center.y >= -1.0f - radius &&
+		center.y <= 1.0f + radius && center.z >= -radius && center.z <= 1.0f + radius;
+}
+
+static void test_planes() {
+	const auto frustum = extract_frustum(glm::mat4(1.0f));
+	BoundingSpheres spheres;
+	spheres.resize(5);
+	spheres.set(0, {0.0f, 0.0f, 0.5f}, 0.1f); // inside
+	spheres.set(1, {3.0f, 0.0f, 0.5f}, 0.5f); // right of the volume
+	spheres.set(2, {1.4f, 0.0f, 0.5f}, 0.5f); // straddling the right plane
+	spheres.set(3, {0.0f, 0.0f, -0.6f}, 0.5f); // in front of the near plane
+	spheres.set(4, {0.0f, -1.2f, 1.1f}, 0.3f); // straddling the bottom and far planes
+
+	uint32_t visible[5];
+	const uint32_t count = cull_spheres(frustum, spheres, 0, 5, visible);
+	CHECK(count == 3);
+	CHECK(visible[0] == 0);
+	CHECK(visible[1] == 2);
+	CHECK(visible[2] == 4);
+}
+
+// the SIMD path against a scalar reference, over a count that isn't a multiple of any vector width
+static void test_matches_reference() {
+	constexpr uint32_t COUNT = 100003;
+	BoundingSpheres spheres;
+	spheres.resize(COUNT);
+	std::vector<uint32_t> expected;
+	uint32_t seed = 7;
+	const auto random = [&seed](float range) {
+		seed = seed * 1664525u + 1013904223u;
+		return (static_cast<float>(seed >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f) * range;
+	};
+	for (uint32_t i = 0; i < COUNT; i++) {
+		const glm::vec3 center(random(3.0f), random(3.0f), random(3.0f));
+		const float radius = random(0.5f) + 0.5f;
+		spheres.set(i, center, radius);
+		if (touches_clip_volume(center, radius)) {
+			expected.push_back(i);
+		}
+	}
+
+	const auto frustum = extract_frustum(glm::mat4(1.0f));
+	std::vector<uint32_t> visible(COUNT);
+	visible.resize(cull_spheres(frustum, spheres, 0, COUNT, visible.data()));
+	CHECK(visible == expected);
+
+	ThreadPool pool(3);
+	std::vector<uint32_t> parallel, scratch;
+	for (int frame = 0; frame < 3; frame++) {
+		cull_spheres(frustum, spheres, pool, parallel, scratch);
+		CHECK(parallel == expected);
+	}
+}
+
+int main() {
+	test_planes();
+	test_matches_reference();
+	return TEST_RESULT;
+}
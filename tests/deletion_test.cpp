@@ -0,0 +1,44 @@
+#include <vulkan/vulkan.h>
+
+#include "check.h"
+#include "deletion.h"
+
+using namespace VkDraw;
+
+// entries of an unsupported type throw when they are destroyed, before any Vulkan call is made, which shows
+// which entries a collect reached without needing a device
+static void test_collect_order() {
+	DeletionQueue queue;
+	queue.push(5, VK_OBJECT_TYPE_UNKNOWN, 1);
+	queue.push(7, VK_OBJECT_TYPE_UNKNOWN, 2);
+	CHECK(queue.size() == 2);
+
+	// frame 5 may still be in flight until 6 frames have completed
+	queue.collect(VK_NULL_HANDLE, 5);
+	CHECK(queue.size() == 2);
+	CHECK_THROWS(queue.collect(VK_NULL_HANDLE, 6));
+}
+
+static void test_push_keeps_sorted() {
+	DeletionQueue queue;
+	queue.push(10, VK_OBJECT_TYPE_UNKNOWN, 1);
+	// pushed later with an earlier frame, it is held back until the entry before it is due
+	queue.push(3, VK_OBJECT_TYPE_UNKNOWN, 2);
+	queue.collect(VK_NULL_HANDLE, 10);
+	CHECK(queue.size() == 2);
+}
+
+static void test_null_handles_skipped() {
+	DeletionQueue queue;
+	queue.push(0, VkBuffer(VK_NULL_HANDLE));
+	queue.push(0, VkImage(VK_NULL_HANDLE));
+	CHECK(queue.size() == 0);
+	queue.flush(VK_NULL_HANDLE);
+}
+
+int main() {
+	test_collect_order();
+	test_push_keeps_sorted();
+	test_null_handles_skipped();
+	return TEST_RESULT;
+}
@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "check.h"
+#include "draws.h"
+
+using namespace VkDraw;
+
+// few distinct pipelines, materials and depths, so plenty of keys are equal and stability is tested too
+static std::vector<DrawItem> random_draws(uint32_t count, uint32_t seed) {
+	std::vector<DrawItem> draws(count);
+	for (uint32_t i = 0; i < count; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		const auto depth = static_cast<float>((seed >> 16) % 16);
+		draws[i] = {draw_sort_key(DRAW_PASS_OPAQUE, seed % 4, (seed >> 8) % 8, depth), i};
+	}
+	return draws;
+}
+
+static void test_key_order() {
+	CHECK(draw_sort_key(0, 1, 0, 0.0f) > draw_sort_key(0, 0, 0xffff, 1000.0f));
+	CHECK(draw_sort_key(0, 0, 1, 0.0f) > draw_sort_key(0, 0, 0, 1000.0f));
+	CHECK(draw_sort_key(0, 0, 0, 2.0f) > draw_sort_key(0, 0, 0, 1.0f));
+	// behind the camera is clamped to zero rather than sorting after everything
+	CHECK(draw_sort_key(0, 0, 0, -1.0f) == draw_sort_key(0, 0, 0, 0.0f));
+	CHECK(draw_sort_pipeline(draw_sort_key(0, 123, 45, 6.0f)) == 123);
+}
+
+// matches std::stable_sort for sizes both below and above the grain where the sort goes parallel
+static void test_matches_stable_sort() {
+	ThreadPool pool(3);
+	DrawSortScratch scratch;
+	for (const uint32_t count : {0u, 1u, 100u, 50000u, 200000u}) {
+		auto draws = random_draws(count, count + 1);
+		auto expected = draws;
+		std::ranges::stable_sort(expected, {}, &DrawItem::key);
+
+		sort_draws(draws, scratch, pool);
+		CHECK(std::ranges::equal(draws, expected, [](const DrawItem &a, const DrawItem &b) {
+			return a.key == b.key && a.object == b.object;
+		}));
+	}
+}
+
+static void test_shared_key() {
+	ThreadPool pool(2);
+	DrawSortScratch scratch;
+	std::vector<DrawItem> draws(1000);
+	for (uint32_t i = 0; i < 1000; i++) {
+		draws[i] = {42, i};
+	}
+	sort_draws(draws, scratch, pool);
+	bool unchanged = true;
+	for (uint32_t i = 0; i < 1000; i++) {
+		unchanged &= draws[i].key == 42 && draws[i].object == i;
+	}
+	CHECK(unchanged);
+}
+
+int main() {
+	test_key_order();
+	test_matches_stable_sort();
+	test_shared_key();
+	return TEST_RESULT;
+}
@@ -0,0 +1,125 @@
+#include <cstdint>
+#include <vector>
+
+#include <SDL.h>
+
+#include "check.h"
+#include "golden.h"
+
+using namespace VkDraw;
+
+// an RGBA32 surface over pixels, which must outlive it
+static SDL_Surface *wrap(std::vector<uint8_t> &pixels, int w, int h) {
+	return SDL_CreateRGBSurfaceWithFormatFrom(pixels.data(), w, h, 32, w * 4, SDL_PIXELFORMAT_RGBA32);
+}
+
+static std::vector<uint8_t> solid(int w, int h, uint8_t r, uint8_t g, uint8_t b) {
+	std::vector<uint8_t> pixels(static_cast<size_t>(w) * h * 4);
+	for (size_t i = 0; i < pixels.size(); i += 4) {
+		pixels[i] = r;
+		pixels[i + 1] = g;
+		pixels[i + 2] = b;
+		pixels[i + 3] = 255;
+	}
+	return pixels;
+}
+
+static void set_pixel(std::vector<uint8_t> &pixels, int w, int x, int y, uint8_t value) {
+	const size_t i = (static_cast<size_t>(y) * w + x) * 4;
+	pixels[i] = value;
+	pixels[i + 1] = value;
+	pixels[i + 2] = value;
+}
+
+static void test_identical() {
+	auto a = solid(64, 64, 10, 120, 200);
+	auto b = a;
+	SDL_Surface *expected = wrap(a, 64, 64);
+	SDL_Surface *actual = wrap(b, 64, 64);
+	const auto result = compare_images(*expected, *actual, nullptr);
+	CHECK(result.size_matches);
+	CHECK(result.pixels == 64 * 64);
+	CHECK(result.mismatched == 0);
+	CHECK(result.max_delta == 0.0);
+	CHECK(result.passed());
+	SDL_FreeSurface(expected);
+	SDL_FreeSurface(actual);
+}
+
+static void test_thresholds() {
+	auto a = solid(100, 100, 0, 0, 0);
+	auto b = a;
+	SDL_Surface *expected = wrap(a, 100, 100);
+	SDL_Surface *actual = wrap(b, 100, 100);
+
+	// a couple of levels of difference, as antialiasing between drivers gives, is under the threshold
+	set_pixel(b, 100, 5, 5, 2);
+	auto result = compare_images(*expected, *actual, nullptr);
+	CHECK(result.mismatched == 0);
+	CHECK(result.max_delta < GOLDEN_THRESHOLD);
+
+	// black to white is close to the largest distance there is, one pixel in 10000 is within the allowed share
+	set_pixel(b, 100, 5, 5, 255);
+	result = compare_images(*expected, *actual, nullptr);
+	CHECK(result.mismatched == 1);
+	CHECK(result.max_delta > 0.9);
+	CHECK(result.passed());
+
+	for (int x = 0; x < 100; x++) {
+		set_pixel(b, 100, x, 50, 255);
+	}
+	result = compare_images(*expected, *actual, nullptr);
+	CHECK(result.mismatched == 101);
+	CHECK(!result.passed());
+
+	SDL_FreeSurface(expected);
+	SDL_FreeSurface(actual);
+}
+
+static void test_diff_image() {
+	auto a = solid(4, 4, 255, 255, 255);
+	auto b = a;
+	auto d = solid(4, 4, 0, 0, 0);
+	set_pixel(b, 4, 1, 2, 0);
+	SDL_Surface *expected = wrap(a, 4, 4);
+	SDL_Surface *actual = wrap(b, 4, 4);
+	SDL_Surface *diff = wrap(d, 4, 4);
+	compare_images(*expected, *actual, diff);
+
+	const size_t mismatch = (2 * 4 + 1) * 4;
+	CHECK(d[mismatch] == 255 && d[mismatch + 1] == 0 && d[mismatch + 2] == 0);
+	// matching pixels are a faded copy, white stays white
+	CHECK(d[0] == 255 && d[1] == 255 && d[2] == 255);
+
+	SDL_FreeSurface(expected);
+	SDL_FreeSurface(actual);
+	SDL_FreeSurface(diff);
+}
+
+static void test_size_mismatch() {
+	auto a = solid(8, 8, 0, 0, 0);
+	auto b = solid(8, 4, 0, 0, 0);
+	SDL_Surface *expected = wrap(a, 8, 8);
+	SDL_Surface *actual = wrap(b, 8, 4);
+	const auto result = compare_images(*expected, *actual, nullptr);
+	CHECK(!result.size_matches);
+	CHECK(!result.passed());
+	SDL_FreeSurface(expected);
+	SDL_FreeSurface(actual);
+}
+
+static void test_missing_golden() {
+	auto a = solid(8, 8, 0, 0, 0);
+	SDL_Surface *actual = wrap(a, 8, 8);
+	CHECK_THROWS(check_golden("does/not/exist.png", *actual));
+	SDL_FreeSurface(actual);
+}
+
+int main() {
+	test_identical();
+	test_thresholds();
+	test_diff_image();
+	test_size_mismatch();
+	test_missing_golden();
+	return TEST_RESULT;
+}
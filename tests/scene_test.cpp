@@ -0,0 +1,96 @@
+#include <cmath>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "check.h"
+#include "scene.h"
+
+using namespace VkDraw;
+
+static bool near(const glm::mat4 &a, const glm::mat4 &b) {
+	for (int column = 0; column < 4; column++) {
+		for (int row = 0; row < 4; row++) {
+			if (std::abs(a[column][row] - b[column][row]) > 1e-5f) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// the same transform built the slow way, translate * rotate * scale
+static glm::mat4 local_matrix(const Transform &local) {
+	return glm::translate(glm::mat4(1.0f), local.translation) * glm::mat4_cast(local.rotation) *
+		glm::scale(glm::mat4(1.0f), local.scale);
+}
+
+static void test_hierarchy() {
+	SceneGraph scene;
+	Transform root_local;
+	root_local.translation = {1.0f, 2.0f, 3.0f};
+	root_local.rotation = glm::angleAxis(0.7f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f)));
+	root_local.scale = {2.0f, 1.0f, 0.5f};
+	Transform child_local;
+	child_local.translation = {0.0f, 1.0f, 0.0f};
+	child_local.rotation = glm::angleAxis(-1.3f, glm::vec3(0.0f, 0.0f, 1.0f));
+
+	// enough nodes that both the four wide and the remainder paths of update run
+	const auto root = scene.add(root_local);
+	NodeId nodes[7];
+	NodeId parent = root;
+	for (auto &node : nodes) {
+		node = scene.add(child_local, parent);
+		parent = node;
+	}
+	scene.update();
+	CHECK(scene.updated() == 8);
+
+	glm::mat4 expected = local_matrix(root_local);
+	CHECK(near(scene.world(root), expected));
+	for (const auto node : nodes) {
+		expected = expected * local_matrix(child_local);
+		CHECK(near(scene.world(node), expected));
+	}
+}
+
+static void test_dirty_propagation() {
+	SceneGraph scene;
+	const auto a = scene.add();
+	const auto b = scene.add();
+	const auto a_child = scene.add({}, a);
+	scene.add({}, b);
+	scene.update();
+
+	scene.update();
+	CHECK(scene.updated() == 0);
+
+	scene.set_translation(a, {5.0f, 0.0f, 0.0f});
+	scene.update();
+	CHECK(scene.updated() == 2);
+	CHECK(near(scene.world(a_child), local_matrix({{5.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}})));
+}
+
+static void test_reparent() {
+	SceneGraph scene;
+	const auto child = scene.add({{1.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}});
+	const auto parent = scene.add({{0.0f, 2.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}});
+
+	// the parent comes after the child, so this re-sorts
+	scene.set_parent(child, parent);
+	scene.update();
+	CHECK(scene.index_of(parent) < scene.index_of(child));
+	CHECK(near(scene.world(child), local_matrix({{1.0f, 2.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}})));
+
+	CHECK_THROWS(scene.set_parent(parent, child));
+	CHECK_THROWS(scene.set_parent(parent, parent));
+}
+
+int main() {
+	test_hierarchy();
+	test_dirty_propagation();
+	test_reparent();
+	return TEST_RESULT;
+}
@@ -0,0 +1,94 @@
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "check.h"
+#include "surface.h"
+
+using namespace VkDraw;
+
+static SurfaceFormatChoice choose(std::vector<VkSurfaceFormatKHR> formats, ColorOutput output) {
+	return choose_surface_format(formats, output);
+}
+
+static void test_sdr() {
+	// hardware encoding is preferred over encoding in the shader
+	auto choice = choose(
+		{{VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR},
+			{VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR}},
+		ColorOutput::SDR
+	);
+	CHECK(choice.format.format == VK_FORMAT_B8G8R8A8_SRGB);
+	CHECK(choice.encoding == OutputEncoding::NONE);
+	CHECK(choice.output == ColorOutput::SDR);
+
+	choice = choose({{VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR}}, ColorOutput::SDR);
+	CHECK(choice.encoding == OutputEncoding::SRGB);
+	CHECK(choice.bytes_per_pixel == 4);
+}
+
+static void test_fallback_to_cheaper_output() {
+	const std::vector<VkSurfaceFormatKHR> formats = {
+		{VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR},
+		{VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR},
+	};
+	CHECK(choose(formats, ColorOutput::DEEP).output == ColorOutput::DEEP);
+	CHECK(choose(formats, ColorOutput::HDR).output == ColorOutput::DEEP);
+	CHECK(choose(formats, ColorOutput::SDR).output == ColorOutput::SDR);
+}
+
+static void test_hdr() {
+	const std::vector<VkSurfaceFormatKHR> formats = {
+		{VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR},
+		{VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_COLOR_SPACE_HDR10_ST2084_EXT},
+		{VK_FORMAT_R16G16B16A16_SFLOAT, VK_COLOR_SPACE_EXTENDED_SRGB_LINEAR_EXT},
+	};
+
+	// HDR takes whichever is cheaper, HDR10 at 4 bytes per pixel over scRGB at 8
+	auto choice = choose(formats, ColorOutput::HDR);
+	CHECK(choice.output == ColorOutput::HDR10);
+	CHECK(choice.encoding == OutputEncoding::PQ);
+
+	choice = choose(formats, ColorOutput::SCRGB);
+	CHECK(choice.output == ColorOutput::SCRGB);
+	CHECK(choice.encoding == OutputEncoding::NONE);
+	CHECK(choice.bytes_per_pixel == 8);
+}
+
+// formats none of the known ones match are derived from the implementation's first choice
+static void test_unknown_formats() {
+	auto choice = choose({{VK_FORMAT_A8B8G8R8_SRGB_PACK32, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR}}, ColorOutput::SDR);
+	CHECK(choice.format.format == VK_FORMAT_A8B8G8R8_SRGB_PACK32);
+	CHECK(choice.encoding == OutputEncoding::NONE);
+
+	choice = choose({{VK_FORMAT_R5G6B5_UNORM_PACK16, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR}}, ColorOutput::SDR);
+	CHECK(choice.encoding == OutputEncoding::SRGB);
+	CHECK(choice.bytes_per_pixel == 2);
+
+	choice = choose({{VK_FORMAT_R16G16B16A16_UNORM, VK_COLOR_SPACE_HDR10_ST2084_EXT}}, ColorOutput::SDR);
+	CHECK(choice.encoding == OutputEncoding::PQ);
+	CHECK(choice.output == ColorOutput::HDR10);
+	CHECK(choice.bytes_per_pixel == 8);
+
+	choice = choose({{VK_FORMAT_A2R10G10B10_UNORM_PACK32, VK_COLOR_SPACE_BT2020_LINEAR_EXT}}, ColorOutput::SDR);
+	CHECK(choice.encoding == OutputEncoding::NONE);
+	CHECK(choice.output == ColorOutput::DEEP);
+}
+
+static void test_present_mode() {
+	const std::vector<VkPresentModeKHR> modes = {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+	CHECK(choose_present_mode(modes, PresentPreference::AUTO, false) == VK_PRESENT_MODE_MAILBOX_KHR);
+	CHECK(choose_present_mode(modes, PresentPreference::AUTO, true) == VK_PRESENT_MODE_FIFO_KHR);
+	// without immediate, mailbox is the next closest to an uncapped frame rate
+	CHECK(choose_present_mode(modes, PresentPreference::IMMEDIATE, false) == VK_PRESENT_MODE_MAILBOX_KHR);
+	CHECK(choose_present_mode(modes, PresentPreference::RELAXED, false) == VK_PRESENT_MODE_FIFO_KHR);
+}
+
+int main() {
+	test_sdr();
+	test_fallback_to_cheaper_output();
+	test_hdr();
+	test_unknown_formats();
+	test_present_mode();
+	return TEST_RESULT;
+}
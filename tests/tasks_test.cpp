@@ -0,0 +1,80 @@
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "check.h"
+#include "tasks.h"
+
+using namespace VkDraw;
+
+static void test_parallel_for_covers_range() {
+	ThreadPool pool(3);
+	for (const uint32_t count : {0u, 1u, 7u, 1000u, 100000u}) {
+		std::vector<std::atomic<uint32_t>> hits(count);
+		parallel_for(pool, count, 64, [&hits](uint32_t, uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++) {
+				hits[i]++;
+			}
+		});
+
+		bool once = true;
+		for (const auto &hit : hits) {
+			once &= hit == 1;
+		}
+		CHECK(once);
+	}
+}
+
+// the radix sort counts and scatters in two passes and relies on a chunk getting the same range both times
+static void test_parallel_for_deterministic() {
+	ThreadPool pool(3);
+	constexpr uint32_t COUNT = 10000;
+	std::vector<uint32_t> first(COUNT), second(COUNT);
+	for (auto *chunks : {&first, &second}) {
+		parallel_for(pool, COUNT, 100, [chunks](uint32_t chunk, uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++) {
+				(*chunks)[i] = chunk;
+			}
+		});
+	}
+	CHECK(first == second);
+}
+
+// a fork started from inside another runs inline rather than deadlocking
+static void test_nested_fork() {
+	ThreadPool pool(2);
+	std::atomic<uint32_t> total = 0;
+	parallel_for(pool, 8, 1, [&](uint32_t, uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++) {
+			parallel_for(pool, 100, 10, [&](uint32_t, uint32_t inner_begin, uint32_t inner_end) {
+				total += inner_end - inner_begin;
+			});
+		}
+	});
+	CHECK(total == 800);
+}
+
+static void test_task_graph() {
+	ThreadPool pool(2);
+	TaskGraph graph;
+	std::atomic<uint32_t> order = 0;
+	uint32_t a_at = 0, b_at = 0, c_at = 0;
+	const auto a = graph.add("a", [&] { a_at = ++order; });
+	const auto b = graph.add("b", [&] { b_at = ++order; }, {a});
+	graph.add("c", [&] { c_at = ++order; }, {a, b}, true);
+	graph.run(pool);
+	CHECK(a_at < b_at);
+	CHECK(b_at < c_at);
+
+	TaskGraph failing;
+	failing.add("throws", [] { throw std::runtime_error("task failed"); });
+	CHECK_THROWS(failing.run(pool));
+}
+
+int main() {
+	test_parallel_for_covers_range();
+	test_parallel_for_deterministic();
+	test_nested_fork();
+	test_task_graph();
+	return TEST_RESULT;
+}